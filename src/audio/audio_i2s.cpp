@@ -24,6 +24,8 @@
 #include "../ble/ble_audio.h"
 #include "../system/state.h"
 #include "../power/power_manager.h"
+#include "../power/pm_locks.h"
+#include "../power/battery_policy.h"
 
 // =============================================================================
 // CONFIGURATION
@@ -34,7 +36,7 @@ constexpr int DMA_BUF_COUNT = 6;         // Number of DMA buffers
 constexpr int DMA_BUF_LEN = 512;         // Samples per buffer (increased from 256)
 
 // Recording timeout protection
-constexpr uint32_t RECORDING_MAX_DURATION_MS = 60000;  // 60 second max recording
+constexpr uint32_t RECORDING_MAX_DURATION_MS = 60000;  // 60 second max recording (battery tier may lower it)
 constexpr uint32_t RECORDING_IDLE_TIMEOUT_MS = 5000;   // Auto-stop if no BLE send for 5s
 constexpr uint32_t I2S_READ_TIMEOUT_MS = 100;          // Timeout for i2s_read()
 
@@ -175,9 +177,13 @@ void startMic() {
     // Clear DMA buffers for clean start
     i2s_zero_dma_buffer(I2S_NUM_0);
 
+    // POWER: I2S DMA + ADPCM need the CPU up for the whole recording
+    pmLockAcquire(PM_LOCK_AUDIO);
+
     // Start I2S - instant since driver is already installed
     esp_err_t err = i2s_start(I2S_NUM_0);
     if (err != ESP_OK) {
+        pmLockRelease(PM_LOCK_AUDIO);
         return;
     }
 
@@ -195,6 +201,7 @@ void stopMic() {
 
     i2s_stop(I2S_NUM_0);
     s_i2sRunning = false;
+    pmLockRelease(PM_LOCK_AUDIO);
     // POWER: Release mic GPIOs when idle to reduce leakage
     micGpioRelease();
 
@@ -273,17 +280,19 @@ void updateRecording() {
     uint32_t now = millis();
 
     // -------------------------------------------------------------------------
-    // Timeout protection: Max recording duration (60 seconds)
+    // Timeout protection: Max recording duration (60 seconds, less on low battery)
     // -------------------------------------------------------------------------
-    if (now - s_recordingStartMs > RECORDING_MAX_DURATION_MS) {
+    uint32_t maxDurationMs = batteryPolicy().maxRecordingMs;
+    if (maxDurationMs > RECORDING_MAX_DURATION_MS) maxDurationMs = RECORDING_MAX_DURATION_MS;
+    if (now - s_recordingStartMs > maxDurationMs) {
         stopRecording();
         return;
     }
 
     // -------------------------------------------------------------------------
-    // BLE connection check - auto-stop if disconnected
+    // BLE connection check - auto-stop if the hub link dropped
     // -------------------------------------------------------------------------
-    if (!bleIsConnected()) {
+    if (!canSendControlMessages()) {
         stopRecording();
         return;
     }
@@ -0,0 +1,27 @@
+#pragma once
+
+// =============================================================================
+// ADV COST - One advertising cost model
+// =============================================================================
+// An advertising event sends on all three channels (ADV_IND, plus a scan
+// response when asked), spaced by the interval plus the controller's 0-10ms
+// random delay. Radio time and charge both follow from the same event
+// count, so the duty cycle and the charge the scheduler logs (ble_adv.h)
+// can't disagree.
+// =============================================================================
+
+#include <cstdint>
+
+constexpr float ADV_EVENT_AIR_MS      = 1.2f;    // Radio on per three-channel event
+constexpr float ADV_RADIO_MA          = 10.0f;   // TX/RX at 0 dBm, average over the event
+constexpr float ADV_RANDOM_DELAY_MS   = 5.0f;    // Mean of the 0-10ms advDelay
+
+// Mean event period of undirected advertising, intervals in 0.625ms units
+inline float advEventPeriodMs(uint16_t minInt, uint16_t maxInt) {
+    return (minInt + maxInt) * 0.625f / 2.0f + ADV_RANDOM_DELAY_MS;
+}
+
+// Charge of a number of events, millicoulombs
+inline float advEventsChargeMc(float events) {
+    return events * ADV_EVENT_AIR_MS * ADV_RADIO_MA / 1000.0f;
+}
@@ -0,0 +1,274 @@
+#include "ble_adv.h"
+
+#include <BLEDevice.h>
+
+#include "adv_cost.h"
+#include "ble_core.h"
+#include "ble_conn.h"
+#include "../power/battery_policy.h"
+#include "../system/state.h"
+#include "../system/timer_service.h"
+#include "../system/trace.h"
+
+// =============================================================================
+// BACKOFF PROFILE
+// =============================================================================
+// Intervals in 0.625ms units. A step with duration 0 lasts until an event
+// restarts the profile.
+// =============================================================================
+
+struct AdvProfileStep {
+    const char *name;
+    uint16_t minInt;
+    uint16_t maxInt;
+    uint32_t durationMs;
+};
+
+static const AdvProfileStep PROFILE[ADV_STEP_COUNT] = {
+    // name         min     max     lasts
+    { "fast",      0x0050, 0x0050,  25000 },   // 50ms - discovery right after boot/drop
+    { "normal",    0x0320, 0x0640, 120000 },   // 500-1000ms
+    { "slow",      0x0640, 0x0C80, 600000 },   // 1-2s
+    { "very slow", 0x1900, 0x2000,      0 },   // 4-5.12s
+};
+
+// Spec maximum - the battery tier scale never stretches past this
+constexpr uint32_t ADV_INT_LIMIT       = 0x4000;   // 10.24s
+constexpr uint32_t ADV_RETRY_FIRST_MS  = 200;
+constexpr uint32_t ADV_RETRY_MAX_MS    = 5000;
+constexpr uint32_t ADV_STEP_SLACK_DIV  = 10;       // Step timers may fire 10% late
+
+static AdvStep s_step = ADV_STEP_FAST;
+static uint32_t s_stepStartMs = 0;
+static bool s_begun = false;
+static bool s_timersStarted = false;
+static bool s_advertising = false;        // As reported by the stack
+static uint32_t s_retryMs = 0;
+static uint32_t s_startFailures = 0;
+
+// Advertising-to-connect: 0 = nobody being waited for
+static uint32_t s_searchStartMs = 0;
+static uint32_t s_connectLastMs = 0;
+static uint32_t s_connectTotalMs = 0;
+static uint16_t s_connectCount = 0;
+
+// Accounting - advertising time and estimated events per step
+static uint32_t s_accountMs = 0;
+static uint32_t s_stepAdvMs[ADV_STEP_COUNT] = {0};
+static float s_stepEvents[ADV_STEP_COUNT] = {0};
+
+static void stepIntervals(AdvStep step, uint16_t &minInt, uint16_t &maxInt) {
+    const uint32_t scale = step == ADV_STEP_FAST ? 1 : batteryPolicy().advIntervalScale;
+    uint32_t scaledMin = PROFILE[step].minInt * scale;
+    uint32_t scaledMax = PROFILE[step].maxInt * scale;
+    if (scaledMin > ADV_INT_LIMIT) scaledMin = ADV_INT_LIMIT;
+    if (scaledMax > ADV_INT_LIMIT) scaledMax = ADV_INT_LIMIT;
+    minInt = (uint16_t)scaledMin;
+    maxInt = (uint16_t)scaledMax;
+}
+
+static void account() {
+    const uint32_t now = millis();
+    const uint32_t dt = now - s_accountMs;
+    s_accountMs = now;
+    if (!s_advertising) return;
+
+    uint16_t minInt, maxInt;
+    stepIntervals(s_step, minInt, maxInt);
+    s_stepAdvMs[s_step] += dt;
+    s_stepEvents[s_step] += dt / advEventPeriodMs(minInt, maxInt);
+}
+
+// Radio duty cycle of a step, parts per million
+static uint32_t dutyPpm(AdvStep step) {
+    if (s_stepAdvMs[step] == 0) return 0;
+    return (uint32_t)(s_stepEvents[step] * ADV_EVENT_AIR_MS * 1e6f / s_stepAdvMs[step]);
+}
+
+// Advertising stops on connect; it restarts while another central fits
+static bool linksFull() {
+    return bleConnCount() >= BLE_MAX_CONNS;
+}
+
+static AdvStep firstStep() {
+    if (bleIsInSleepMode()) return ADV_STEP_SLOW;
+    return batteryPolicy().fastAdvBurst ? ADV_STEP_FAST : ADV_STEP_NORMAL;
+}
+
+static void applyStep() {
+    if (!s_begun || linksFull()) return;
+
+    uint16_t minInt, maxInt;
+    stepIntervals(s_step, minInt, maxInt);
+    BLEAdvertising *adv = BLEDevice::getAdvertising();
+    adv->stop();   // New parameters only take effect on a fresh start
+    adv->setMinInterval(minInt);
+    adv->setMaxInterval(maxInt);
+    adv->start();
+}
+
+static void enterStep(AdvStep step);
+
+static void stepTimer() {
+    if (s_step + 1 < ADV_STEP_COUNT) enterStep((AdvStep)(s_step + 1));
+}
+
+static void armStepTimer() {
+    const uint32_t durationMs = PROFILE[s_step].durationMs;
+    if (!s_timersStarted) return;
+    if (durationMs == 0) {
+        timerStop(TIMER_ADV_STEP);
+        return;
+    }
+    const uint32_t elapsedMs = millis() - s_stepStartMs;
+    timerStart(TIMER_ADV_STEP, stepTimer, elapsedMs < durationMs ? durationMs - elapsedMs : 0,
+               durationMs / ADV_STEP_SLACK_DIV);
+}
+
+static void enterStep(AdvStep step) {
+    account();
+    const AdvStep prev = s_step;
+    if (s_stepAdvMs[prev]) {
+        Serial.printf("[ADV] %s -> %s, %s advertised %lus, duty ~%.2f%%\n", PROFILE[prev].name,
+                      PROFILE[step].name, PROFILE[prev].name,
+                      (unsigned long)(s_stepAdvMs[prev] / 1000), dutyPpm(prev) / 10000.0f);
+    }
+    TRACE(TR_ADV_STEP, step, dutyPpm(prev));
+
+    s_step = step;
+    s_stepStartMs = millis();
+    armStepTimer();
+    applyStep();
+}
+
+static void retryTimer() {
+    if (linksFull() || s_advertising) return;
+    applyStep();
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void bleAdvBegin() {
+    s_step = firstStep();
+    s_stepStartMs = millis();
+    s_accountMs = s_stepStartMs;
+    s_searchStartMs = s_stepStartMs;
+    s_begun = true;
+    applyStep();
+}
+
+void bleAdvStartTimers() {
+    s_timersStarted = true;
+    armStepTimer();
+    // initBLE() ran before batteryPolicyInit() - apply the real tier now
+    bleAdvOnEvent(ADV_EVT_POLICY);
+}
+
+void bleAdvOnEvent(AdvEvent event) {
+    switch (event) {
+        case ADV_EVT_CONNECTED:
+            if (s_searchStartMs) {
+                s_connectLastMs = millis() - s_searchStartMs;
+                s_connectTotalMs += s_connectLastMs;
+                s_connectCount++;
+            }
+            s_searchStartMs = linksFull() ? 0 : millis();
+            account();
+            s_advertising = false;   // The controller stopped on connect
+            timerStop(TIMER_ADV_STEP);
+            timerStop(TIMER_ADV_RETRY);
+            // Room for another central: stay findable at the slowest step
+            if (!linksFull()) enterStep(ADV_STEP_VERY_SLOW);
+            break;
+
+        case ADV_EVT_DISCONNECTED:
+            s_searchStartMs = millis();
+            enterStep(firstStep());
+            break;
+
+        case ADV_EVT_SCREEN_ON:
+            if (g_bleConnected) break;   // Only a second central would see it
+            if (s_step > ADV_STEP_NORMAL) enterStep(ADV_STEP_NORMAL);
+            break;
+
+        case ADV_EVT_SCREEN_OFF:
+            if (s_step < ADV_STEP_SLOW) enterStep(ADV_STEP_SLOW);
+            break;
+
+        case ADV_EVT_POLICY:
+            if (!s_timersStarted) break;   // bleAdvStartTimers() picks the tier up
+            if (s_step == ADV_STEP_FAST && !batteryPolicy().fastAdvBurst) {
+                enterStep(ADV_STEP_NORMAL);
+            } else {
+                account();
+                applyStep();
+            }
+            break;
+
+        case ADV_EVT_STACK_STARTED:
+            account();
+            s_advertising = true;
+            s_retryMs = 0;
+            timerStop(TIMER_ADV_RETRY);
+            break;
+
+        case ADV_EVT_STACK_FAILED:
+            account();
+            s_advertising = false;
+            s_startFailures++;
+            if (linksFull() || !s_timersStarted) break;
+            s_retryMs = s_retryMs ? s_retryMs * 2 : ADV_RETRY_FIRST_MS;
+            if (s_retryMs > ADV_RETRY_MAX_MS) s_retryMs = ADV_RETRY_MAX_MS;
+            Serial.printf("[ADV] start failed, retry in %lums\n", (unsigned long)s_retryMs);
+            timerStart(TIMER_ADV_RETRY, retryTimer, s_retryMs, s_retryMs / 4);
+            break;
+
+        case ADV_EVT_STACK_STOPPED:
+            account();
+            s_advertising = false;
+            break;
+    }
+}
+
+AdvStep bleAdvStep() {
+    return s_step;
+}
+
+bool bleAdvIsAdvertising() {
+    return s_advertising;
+}
+
+AdvConnectStats bleAdvConnectStats() {
+    AdvConnectStats stats;
+    stats.lastMs = s_connectLastMs;
+    stats.avgMs = s_connectCount ? s_connectTotalMs / s_connectCount : 0;
+    stats.count = s_connectCount;
+    return stats;
+}
+
+void bleAdvPrint() {
+    account();
+    uint32_t totalMs = 0;
+    float totalEvents = 0;
+    for (int i = 0; i < ADV_STEP_COUNT; i++) {
+        totalMs += s_stepAdvMs[i];
+        totalEvents += s_stepEvents[i];
+    }
+    Serial.printf("[ADV] step %s%s, advertised %lus, duty ~%.2f%% ~%.1fmC, %lu start failures\n",
+                  PROFILE[s_step].name, s_advertising ? "" : " (idle)",
+                  (unsigned long)(totalMs / 1000),
+                  totalMs ? totalEvents * ADV_EVENT_AIR_MS * 100.0f / totalMs : 0.0f,
+                  advEventsChargeMc(totalEvents), (unsigned long)s_startFailures);
+    if (s_connectCount) {
+        Serial.printf("[ADV] connect after %lums, avg %lums over %u connects\n",
+                      (unsigned long)s_connectLastMs,
+                      (unsigned long)(s_connectTotalMs / s_connectCount), s_connectCount);
+    }
+    for (int i = 0; i < ADV_STEP_COUNT; i++) {
+        if (!s_stepAdvMs[i]) continue;
+        Serial.printf("[ADV]   %-9s %6lus ~%lu events\n", PROFILE[i].name,
+                      (unsigned long)(s_stepAdvMs[i] / 1000), (unsigned long)s_stepEvents[i]);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// =============================================================================
+// BLE ADVERTISING SCHEDULER - One owner for undirected advertising
+// =============================================================================
+// Advertising steps through a declarative backoff profile while nobody is
+// connected: fast burst -> normal -> slow -> very slow. Each step has its
+// interval and how long it lasts; the battery tier stretches the intervals
+// and may skip the fast burst (battery_policy.h).
+//
+// Nothing restarts advertising on a timer any more. The scheduler reacts to
+// events: boot, connect / disconnect, screen on / off, tier changes and the
+// stack's own start/stop completions (a failed start is retried with
+// backoff).
+//
+// While connected with a link slot free (ble_conn.h), advertising stays on
+// at the very slow step so a second central can still connect.
+//
+// Time spent in each step and an estimated radio duty cycle are logged at
+// every step change and in powerPrintDiagnostics(). Advertising-to-connect
+// time (from boot, a drop, or the last connect with a slot free) feeds the
+// link telemetry (ble_telemetry.h).
+// =============================================================================
+
+#include <Arduino.h>
+
+enum AdvStep : uint8_t {
+    ADV_STEP_FAST,
+    ADV_STEP_NORMAL,
+    ADV_STEP_SLOW,
+    ADV_STEP_VERY_SLOW,
+    ADV_STEP_COUNT
+};
+
+enum AdvEvent : uint8_t {
+    ADV_EVT_CONNECTED,
+    ADV_EVT_DISCONNECTED,     // Restart the profile
+    ADV_EVT_SCREEN_ON,        // At most NORMAL
+    ADV_EVT_SCREEN_OFF,       // At least SLOW, no fast burst
+    ADV_EVT_POLICY,           // Battery tier changed
+    ADV_EVT_STACK_STARTED,    // GAP start complete (ok)
+    ADV_EVT_STACK_FAILED,     // GAP start complete (error)
+    ADV_EVT_STACK_STOPPED,    // GAP stop complete
+};
+
+// initBLE() (boot task, after the advertising payload is set): start the
+// profile
+void bleAdvBegin();
+
+// bleStartMaintenance() (loop task): arm the step timer, apply the tier
+void bleAdvStartTimers();
+
+// Loop task (GAP completions arrive through the work queue)
+void bleAdvOnEvent(AdvEvent event);
+
+struct AdvConnectStats {
+    uint32_t lastMs;     // 0 until the first connect
+    uint32_t avgMs;
+    uint16_t count;
+};
+
+AdvStep bleAdvStep();
+bool bleAdvIsAdvertising();
+AdvConnectStats bleAdvConnectStats();
+
+void bleAdvPrint();
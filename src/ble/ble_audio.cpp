@@ -2,19 +2,27 @@
 
 #include <cstring>
 
-#include "ble_core.h"
+#include "ble_transport.h"
 
-void bleSendAudioChunk(const uint8_t *data, size_t len) {
-    BLECharacteristic *c = bleGetAudioChar();
-    if (!c) return;
-    // BLECharacteristic::setValue expects non-const buffer
-    c->setValue(const_cast<uint8_t*>(data), len);
-    c->notify();
+// Audio and control messages go to the hub only (transportHub())
+
+// Each chunk is an IMA ADPCM block with its own header - a missing piece
+// would shift every block after it, so all pieces must fit before the first
+bool bleSendAudioChunk(const uint8_t *data, size_t len) {
+    const uint16_t hub = transportHub();
+    const size_t pieceMax = transportPayloadMax(hub);
+    if (!data || !len || !pieceMax) return false;
+    const size_t pieces = (len + pieceMax - 1) / pieceMax;
+    if (transportCredits(hub) < pieces) return false;
+
+    for (size_t off = 0; off < len; off += pieceMax) {
+        const size_t n = len - off < pieceMax ? len - off : pieceMax;
+        if (!transportSend(hub, TP_CH_AUDIO, data + off, n)) return false;
+    }
+    return true;
 }
 
 void bleSendControlMessage(const char *msg) {
-    BLECharacteristic *c = bleGetAudioChar();
-    if (!c || !msg) return;
-    c->setValue((uint8_t*)msg, strlen(msg));
-    c->notify();
+    if (!msg) return;
+    transportSend(transportHub(), TP_CH_AUDIO, (const uint8_t *)msg, strlen(msg));
 }
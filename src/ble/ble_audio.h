@@ -3,5 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 
-void bleSendAudioChunk(const uint8_t *data, size_t len);
+// One encoded block to the hub, split to the link's payload size. A block
+// goes out whole or not at all (false: no hub, or not enough credits).
+bool bleSendAudioChunk(const uint8_t *data, size_t len);
 void bleSendControlMessage(const char *msg);
@@ -0,0 +1,367 @@
+#include "ble_conn.h"
+
+#include <Preferences.h>
+#include <esp_gap_ble_api.h>
+#include <freertos/FreeRTOS.h>
+
+#include "../power/pm_locks.h"
+#include "../system/work_queue.h"
+
+constexpr uint16_t ATT_DEFAULT_MTU = 23;
+
+static BleConn s_conns[BLE_MAX_CONNS];
+static portMUX_TYPE s_connMux = portMUX_INITIALIZER_UNLOCKED;
+
+static BLEServer *s_server = nullptr;
+static uint16_t s_valueHandle[BLE_CH_COUNT] = {0};
+static uint16_t s_cccdHandle[BLE_CH_COUNT] = {0};
+static uint16_t s_pinnedHub = BLE_CONN_NONE;
+
+static const char *const CHANNEL_NAMES[BLE_CH_COUNT] = { "audio", "file", "ota", "telemetry" };
+
+// Subscriptions per bonded identity address, in NVS
+constexpr int         BOND_SUBS_MAX        = 8;
+constexpr const char *BOND_PREF_NAMESPACE  = "bleconn";
+constexpr const char *BOND_PREF_SUBS_KEY   = "subs";
+
+struct BondSubs {
+    esp_bd_addr_t bda;
+    uint8_t subscribed;         // Bit per BleChannel
+    uint8_t used;
+};
+
+static BondSubs s_bondSubs[BOND_SUBS_MAX];
+static uint8_t s_bondSubsNext = 0;      // Replaced when the table is full
+static bool s_bondSubsDirty = false;
+
+static void clearSlot(BleConn &c) {
+    memset(&c, 0, sizeof(c));
+    c.connId = BLE_CONN_NONE;
+    c.mtu = ATT_DEFAULT_MTU;
+    c.rssi = BLE_RSSI_UNKNOWN;
+    c.txPhy = 1;   // Every link starts on 1M
+    c.rxPhy = 1;
+}
+
+// =============================================================================
+// Bonded subscriptions
+// =============================================================================
+
+// s_connMux held
+static BondSubs *findBondSubs(const esp_bd_addr_t bda) {
+    for (BondSubs &e : s_bondSubs) {
+        if (e.used && memcmp(e.bda, bda, sizeof(e.bda)) == 0) return &e;
+    }
+    return nullptr;
+}
+
+// s_connMux held
+static void keepBondSubs(const esp_bd_addr_t bda, uint8_t subscribed) {
+    BondSubs *e = findBondSubs(bda);
+    if (!e) {
+        for (BondSubs &free : s_bondSubs) {
+            if (!free.used) {
+                e = &free;
+                break;
+            }
+        }
+        if (!e) {
+            e = &s_bondSubs[s_bondSubsNext];
+            s_bondSubsNext = (s_bondSubsNext + 1) % BOND_SUBS_MAX;
+        }
+        memcpy(e->bda, bda, sizeof(e->bda));
+        e->used = 1;
+        e->subscribed = subscribed;
+        s_bondSubsDirty = true;
+        return;
+    }
+    if (e->subscribed != subscribed) {
+        e->subscribed = subscribed;
+        s_bondSubsDirty = true;
+    }
+}
+
+static bool stillBonded(const uint8_t *bda, const esp_ble_bond_dev_t *bonds, int count) {
+    for (int i = 0; i < count; i++) {
+        if (memcmp(bonds[i].bd_addr, bda, sizeof(esp_bd_addr_t)) == 0) return true;
+    }
+    return false;
+}
+
+// Boot task, before any link. Entries whose bond was removed are dropped.
+static void loadBondSubs() {
+    memset(s_bondSubs, 0, sizeof(s_bondSubs));
+    Preferences prefs;
+    if (prefs.begin(BOND_PREF_NAMESPACE, true)) {
+        if (prefs.getBytesLength(BOND_PREF_SUBS_KEY) == sizeof(s_bondSubs)) {
+            prefs.getBytes(BOND_PREF_SUBS_KEY, s_bondSubs, sizeof(s_bondSubs));
+        }
+        prefs.end();
+    }
+
+    int count = esp_ble_get_bond_device_num();
+    esp_ble_bond_dev_t *bonds = count > 0
+        ? (esp_ble_bond_dev_t *)malloc(count * sizeof(esp_ble_bond_dev_t)) : nullptr;
+    if (bonds) esp_ble_get_bond_device_list(&count, bonds);
+    if (!bonds) count = 0;
+
+    int kept = 0;
+    for (BondSubs &e : s_bondSubs) {
+        if (!e.used) continue;
+        if (stillBonded(e.bda, bonds, count)) {
+            kept++;
+            continue;
+        }
+        memset(&e, 0, sizeof(e));
+        s_bondSubsDirty = true;
+    }
+    free(bonds);
+    if (kept || s_bondSubsDirty) {
+        Serial.printf("[BLE] subscriptions kept for %d bonded peers\n", kept);
+    }
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void bleConnInit(BLEServer *server, BLECharacteristic *const chars[BLE_CH_COUNT]) {
+    s_server = server;
+    for (BleConn &c : s_conns) clearSlot(c);
+    for (int i = 0; i < BLE_CH_COUNT; i++) {
+        s_valueHandle[i] = chars[i]->getHandle();
+        BLEDescriptor *cccd = chars[i]->getDescriptorByUUID(BLEUUID((uint16_t)0x2902));
+        s_cccdHandle[i] = cccd ? cccd->getHandle() : 0;
+    }
+    loadBondSubs();
+    bleConnSaveSubscriptions();   // Pruned entries
+}
+
+BleConn *bleConnOpen(uint16_t connId, const esp_bd_addr_t bda) {
+    BleConn *slot = nullptr;
+    portENTER_CRITICAL(&s_connMux);
+    for (BleConn &c : s_conns) {
+        if (c.connId != BLE_CONN_NONE) continue;
+        clearSlot(c);
+        c.connId = connId;
+        memcpy(c.bda, bda, sizeof(c.bda));
+        c.connectedMs = millis();
+        const BondSubs *kept = findBondSubs(bda);
+        if (kept) {
+            c.bonded = true;
+            c.subscribed = kept->subscribed;
+        }
+        slot = &c;
+        break;
+    }
+    portEXIT_CRITICAL(&s_connMux);
+
+    // The loop sees restored subscriptions like fresh CCCD writes
+    if (slot) {
+        for (int i = 0; i < BLE_CH_COUNT; i++) {
+            if (!(slot->subscribed & (1 << i))) continue;
+            const uint8_t state[2] = { (uint8_t)i, 1 };
+            workQueuePost(WORK_BLE_SUBSCRIBE, state, sizeof(state), connId);
+        }
+    }
+    return slot;
+}
+
+void bleConnOnEncrypted(const esp_bd_addr_t bda, bool bonded) {
+    if (!bonded) return;
+    portENTER_CRITICAL(&s_connMux);
+    BleConn *c = bleConnFindBda(bda);
+    if (c && !c->bonded) {
+        // Subscribed before pairing finished, or bonded by older firmware
+        c->bonded = true;
+        keepBondSubs(c->bda, c->subscribed);
+    }
+    portEXIT_CRITICAL(&s_connMux);
+}
+
+void bleConnSaveSubscriptions() {
+    BondSubs copy[BOND_SUBS_MAX];
+    portENTER_CRITICAL(&s_connMux);
+    const bool dirty = s_bondSubsDirty;
+    s_bondSubsDirty = false;
+    memcpy(copy, s_bondSubs, sizeof(copy));
+    portEXIT_CRITICAL(&s_connMux);
+    if (!dirty) return;
+
+    PmLockGuard flashLock(PM_LOCK_FLASH);
+    Preferences prefs;
+    if (!prefs.begin(BOND_PREF_NAMESPACE, false)) return;
+    prefs.putBytes(BOND_PREF_SUBS_KEY, copy, sizeof(copy));
+    prefs.end();
+}
+
+void bleConnClose(uint16_t connId) {
+    portENTER_CRITICAL(&s_connMux);
+    for (BleConn &c : s_conns) {
+        if (c.connId == connId) clearSlot(c);
+    }
+    portEXIT_CRITICAL(&s_connMux);
+}
+
+void bleConnOnMtu(uint16_t connId, uint16_t mtu) {
+    BleConn *c = bleConnFind(connId);
+    if (c) c->mtu = mtu;
+}
+
+void bleConnOnParams(const esp_bd_addr_t bda, bool ok, uint16_t interval, uint16_t latency,
+                     uint16_t timeout) {
+    BleConn *c = bleConnFindBda(bda);
+    if (!c) return;
+    if (!ok) {
+        c->paramUpdatesFailed++;
+        return;
+    }
+    c->paramUpdatesOk++;
+    c->interval = interval;
+    c->latency = latency;
+    c->timeout = timeout;
+}
+
+void bleConnOnPhy(const esp_bd_addr_t bda, uint8_t txPhy, uint8_t rxPhy) {
+    BleConn *c = bleConnFindBda(bda);
+    if (!c) return;
+    c->txPhy = txPhy;
+    c->rxPhy = rxPhy;
+}
+
+void bleConnGattsEvent(esp_gatts_cb_event_t event, esp_ble_gatts_cb_param_t *param) {
+    if (event == ESP_GATTS_CONGEST_EVT) {
+        BleConn *c = bleConnFind(param->congest.conn_id);
+        if (!c) return;
+        if (param->congest.congested && !c->congested) c->congestEvents++;
+        c->congested = param->congest.congested;
+        return;
+    }
+    if (event != ESP_GATTS_WRITE_EVT || param->write.len != 2) return;
+
+    for (int i = 0; i < BLE_CH_COUNT; i++) {
+        if (!s_cccdHandle[i] || param->write.handle != s_cccdHandle[i]) continue;
+        BleConn *c = bleConnFind(param->write.conn_id);
+        if (!c) return;
+        const uint8_t state[2] = { (uint8_t)i, (uint8_t)(param->write.value[0] & 0x01) };
+        portENTER_CRITICAL(&s_connMux);
+        if (state[1]) {
+            c->subscribed |= (1 << i);
+        } else {
+            c->subscribed &= ~(1 << i);
+        }
+        if (c->bonded) keepBondSubs(c->bda, c->subscribed);
+        portEXIT_CRITICAL(&s_connMux);
+        workQueuePost(WORK_BLE_SUBSCRIBE, state, sizeof(state), c->connId);
+        return;
+    }
+}
+
+BleConn *bleConnFind(uint16_t connId) {
+    if (connId == BLE_CONN_NONE) return nullptr;
+    for (BleConn &c : s_conns) {
+        if (c.connId == connId) return &c;
+    }
+    return nullptr;
+}
+
+BleConn *bleConnFindBda(const esp_bd_addr_t bda) {
+    for (BleConn &c : s_conns) {
+        if (c.connId != BLE_CONN_NONE && memcmp(c.bda, bda, sizeof(c.bda)) == 0) return &c;
+    }
+    return nullptr;
+}
+
+BleConn *bleConnAt(int slot) {
+    if (slot < 0 || slot >= BLE_MAX_CONNS || s_conns[slot].connId == BLE_CONN_NONE) return nullptr;
+    return &s_conns[slot];
+}
+
+int bleConnSlot(uint16_t connId) {
+    if (connId == BLE_CONN_NONE) return -1;
+    for (int i = 0; i < BLE_MAX_CONNS; i++) {
+        if (s_conns[i].connId == connId) return i;
+    }
+    return -1;
+}
+
+int bleConnCount() {
+    int n = 0;
+    for (const BleConn &c : s_conns) {
+        if (c.connId != BLE_CONN_NONE) n++;
+    }
+    return n;
+}
+
+BleConn *bleConnHub() {
+    // A pinned hub that dropped stays gone until unpinned - the recording
+    // stops rather than continuing to another peer
+    if (s_pinnedHub != BLE_CONN_NONE) return bleConnFind(s_pinnedHub);
+
+    BleConn *hub = nullptr;
+    for (BleConn &c : s_conns) {
+        if (c.connId == BLE_CONN_NONE || !(c.subscribed & (1 << BLE_CH_AUDIO))) continue;
+        if (!hub || (int32_t)(c.connectedMs - hub->connectedMs) < 0) hub = &c;
+    }
+    return hub;
+}
+
+void bleConnPinHub(bool pin) {
+    if (!pin) {
+        s_pinnedHub = BLE_CONN_NONE;
+        return;
+    }
+    BleConn *hub = bleConnHub();
+    s_pinnedHub = hub ? hub->connId : BLE_CONN_NONE;
+}
+
+bool bleConnNotify(BleConn *c, BleChannel ch, const uint8_t *data, size_t len) {
+    if (!c || !s_server || c->connId == BLE_CONN_NONE) return false;
+    if (!(c->subscribed & (1 << ch))) return false;
+
+    // BLECharacteristic::notify() cuts longer values to the MTU - refuse
+    // them instead, a cut message is corrupt on the other side
+    if (len > (size_t)(c->mtu - ATT_NOTIFY_OVERHEAD)) return false;
+
+    const esp_err_t err = esp_ble_gatts_send_indicate(s_server->getGattsIf(), c->connId,
+                                                      s_valueHandle[ch], (uint16_t)len,
+                                                      const_cast<uint8_t *>(data), false);
+    if (err != ESP_OK) {
+        c->notifyErrors++;
+        return false;
+    }
+    c->notifyCount++;
+    c->notifyBytes += len;
+    c->lastNotifyOkMs = millis();
+    return true;
+}
+
+uint32_t bleConnNotifyErrors() {
+    uint32_t total = 0;
+    for (const BleConn &c : s_conns) {
+        if (c.connId != BLE_CONN_NONE) total += c.notifyErrors;
+    }
+    return total;
+}
+
+void bleConnPrint() {
+    const BleConn *hub = bleConnHub();
+    Serial.printf("[BLE] %d/%u links\n", bleConnCount(), (unsigned)BLE_MAX_CONNS);
+    for (const BleConn &c : s_conns) {
+        if (c.connId == BLE_CONN_NONE) continue;
+        char subs[24] = "";
+        size_t n = 0;
+        for (int i = 0; i < BLE_CH_COUNT; i++) {
+            if (!(c.subscribed & (1 << i))) continue;
+            n += snprintf(subs + n, sizeof(subs) - n, "%s%s", n ? "," : "", CHANNEL_NAMES[i]);
+        }
+        Serial.printf("[BLE]   conn %u %02X:%02X:%02X:%02X:%02X:%02X%s up %lus, mtu %u, "
+                      "int %.2fms lat %u, notify [%s] %lu bytes / %lu errors%s\n",
+                      c.connId, c.bda[0], c.bda[1], c.bda[2], c.bda[3], c.bda[4], c.bda[5],
+                      &c == hub ? " (hub)" : "",
+                      (unsigned long)((millis() - c.connectedMs) / 1000), c.mtu,
+                      c.interval * 1.25f, c.latency, subs,
+                      (unsigned long)c.notifyBytes, (unsigned long)c.notifyErrors,
+                      c.congested ? ", congested" : "");
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+// =============================================================================
+// BLE CONNECTIONS - Per-connection context
+// =============================================================================
+// The controller accepts CONFIG_BT_ACL_CONNECTIONS centrals at once: the
+// phone, and maybe a tablet or a test rig. Each link gets its own context
+// (id, address, MTU, parameters, notify subscriptions, transfer state), so a
+// second central no longer overwrites the first one's.
+//
+// Notifications are sent per connection, and only to peers that enabled
+// them on that characteristic. Arduino's notify() sends to every peer and
+// keeps a single CCCD value for all of them.
+//
+// Routing:
+//   - Audio and control messages (recording, time requests) go to the hub:
+//     the longest-connected peer with audio notifications on. The hub is
+//     pinned while a recording runs.
+//   - File and OTA replies go to the peer that asked.
+//   - Bulk streams are served round-robin across links (ble_file_stream.h).
+//
+// Subscriptions of bonded peers outlive the link (Core spec Vol 3 Part G
+// 3.3.3.3): they are kept per identity address in NVS and restored when
+// the peer connects again, so a phone that doesn't rewrite its CCCDs
+// after a reconnect still gets its notifications. Unbonded peers start
+// with none.
+//
+// Protocol modules reach this through ble_transport.h (Bluedroid backend).
+//
+// The BTC task writes the table (connect, disconnect, MTU, CCCD,
+// congestion). The loop task reads it.
+// =============================================================================
+
+#include <Arduino.h>
+#include <BLEServer.h>
+#include <esp_gatts_api.h>
+
+constexpr uint8_t  BLE_MAX_CONNS = 3;        // CONFIG_BT_ACL_CONNECTIONS (platformio.ini)
+constexpr uint16_t BLE_CONN_NONE = 0xFFFF;
+constexpr size_t   ATT_NOTIFY_OVERHEAD = 3;  // Opcode + handle: a notify carries MTU - 3
+
+enum BleChannel : uint8_t {
+    BLE_CH_AUDIO,    // Audio stream + control messages
+    BLE_CH_FILE,
+    BLE_CH_OTA,
+    BLE_CH_TELEMETRY,   // Link telemetry snapshots (ble_telemetry.h)
+    BLE_CH_COUNT
+};
+
+struct BleConn {
+    uint16_t connId;            // BLE_CONN_NONE = free slot
+    esp_bd_addr_t bda;
+    uint32_t connectedMs;
+    uint16_t mtu;
+    uint16_t interval;          // 1.25ms units, last reported by the controller
+    uint16_t latency;
+    uint16_t timeout;           // 10ms units
+    uint8_t txPhy;              // 1 = 1M, 2 = 2M, 3 = coded
+    uint8_t rxPhy;
+    uint8_t subscribed;         // Bit per BleChannel
+    bool bonded;                // Subscriptions are kept for the next link
+    bool congested;
+    bool linkSetupDone;         // Encryption + params requested (loop task)
+    bool activeTransfer;        // Fast params requested (loop task)
+    uint32_t lastParamUpdateMs;
+    int8_t rssi;                // BLE_RSSI_UNKNOWN until sampled (ble_txpower.h)
+
+    // Counters since connect (ble_telemetry.h)
+    uint32_t notifyCount;
+    uint32_t notifyBytes;
+    uint32_t notifyErrors;
+    uint32_t notifyRetries;     // Chunks sent again after a refused notify
+    uint32_t lastNotifyOkMs;
+    uint16_t congestEvents;
+    uint16_t paramUpdatesOk;
+    uint16_t paramUpdatesFailed;
+};
+
+constexpr int8_t BLE_RSSI_UNKNOWN = 127;
+
+// initBLE(): after the services have started. Each channel's CCCD handle
+// is matched against incoming writes. Loads the bonded peers'
+// subscriptions, dropping those whose bond is gone.
+void bleConnInit(BLEServer *server, BLECharacteristic *const chars[BLE_CH_COUNT]);
+
+// BTC task - server callbacks and the custom GATTS / GAP handlers.
+// Open restores a bonded peer's subscriptions (posting WORK_BLE_SUBSCRIBE
+// for each), encryption with a bond starts keeping them.
+BleConn *bleConnOpen(uint16_t connId, const esp_bd_addr_t bda);
+void bleConnOnEncrypted(const esp_bd_addr_t bda, bool bonded);
+void bleConnClose(uint16_t connId);
+void bleConnOnMtu(uint16_t connId, uint16_t mtu);
+void bleConnOnParams(const esp_bd_addr_t bda, bool ok, uint16_t interval, uint16_t latency,
+                     uint16_t timeout);
+void bleConnOnPhy(const esp_bd_addr_t bda, uint8_t txPhy, uint8_t rxPhy);
+
+// CCCD writes and congestion. A subscription change posts
+// WORK_BLE_SUBSCRIBE (payload: channel, on) for the loop.
+void bleConnGattsEvent(esp_gatts_cb_event_t event, esp_ble_gatts_cb_param_t *param);
+
+// Loop task: write changed bonded subscriptions to NVS
+void bleConnSaveSubscriptions();
+
+// Lookups (loop task). nullptr when the link is gone.
+BleConn *bleConnFind(uint16_t connId);
+BleConn *bleConnFindBda(const esp_bd_addr_t bda);
+BleConn *bleConnAt(int slot);       // Iteration over 0..BLE_MAX_CONNS-1
+int bleConnSlot(uint16_t connId);   // -1 if not connected
+int bleConnCount();
+
+// Where audio and control messages go, nullptr if nobody listens
+BleConn *bleConnHub();
+void bleConnPinHub(bool pin);       // Recording start / stop
+
+// One notification to one peer. False if it isn't subscribed, the value is
+// longer than MTU - 3 (never cut), or the stack refused - only the last is
+// counted in the connection's notifyErrors.
+bool bleConnNotify(BleConn *c, BleChannel ch, const uint8_t *data, size_t len);
+
+// Sum of notifyErrors over the open links
+uint32_t bleConnNotifyErrors();
+
+void bleConnPrint();
@@ -4,7 +4,7 @@
 // Key optimizations:
 // 1. Improved connection parameter negotiation
 // 2. Error tracking and recovery
-// 3. Notify with retry for reliability
+// 3. Per-link notify through the transport (ble_transport.h)
 // 4. Faster advertising restart for better reconnection
 // =============================================================================
 
@@ -17,11 +17,26 @@
 #include "../hardware_config.h"
 #include "../system/state.h"
 #include "../system/time_sync.h"
+#include "../system/timer_service.h"
+#include "../power/pm_locks.h"
 #include "../audio/audio_i2s.h"
 #include "../power/power_manager.h"
+#include "../system/events.h"
+#include "../system/rtc_state.h"
+#include "../system/work_queue.h"
+#include "../system/trace.h"
+#include "../system/boot_profiler.h"
+#include "ble_cts.h"
 #include "ble_text.h"
 #include "ble_file.h"
 #include "ble_ota.h"
+#include "ble_diag.h"
+#include "ble_reconnect.h"
+#include "ble_adv.h"
+#include "ble_txpower.h"
+#include "ble_conn.h"
+#include "ble_telemetry.h"
+#include "ble_transport_bluedroid.h"
 
 // =============================================================================
 // BLE CONFIGURATION - OPTIMIZED FOR STABILITY + POWER
@@ -35,6 +50,10 @@ static const char *HOLLOW_FILE_SERVICE_UUID = "12345678-1234-5678-1234-56789ABCD
 static const char *HOLLOW_FILE_CHAR_UUID    = "12345678-1234-5678-1234-56789ABCDEF1";
 static const char *HOLLOW_OTA_SERVICE_UUID  = "B3F2D342-6A44-4B85-9F3A-4AEDA89753A2";
 static const char *HOLLOW_OTA_CHAR_UUID     = "B3F2D342-6A44-4B85-9F3A-4AEDA89753A3";
+static const char *HOLLOW_DIAG_SERVICE_UUID = "B3F2D342-6A44-4B85-9F3A-4AEDA89753B0";
+static const char *HOLLOW_DIAG_CHAR_UUID    = "B3F2D342-6A44-4B85-9F3A-4AEDA89753B1";
+static const char *HOLLOW_TRACE_CHAR_UUID   = "B3F2D342-6A44-4B85-9F3A-4AEDA89753B2";
+static const char *HOLLOW_LINK_CHAR_UUID    = "B3F2D342-6A44-4B85-9F3A-4AEDA89753B3";
 
 // -----------------------------------------------------------------------------
 // BLE CONNECTION PARAMETERS - TUNED FOR RELIABILITY + POWER
@@ -57,18 +76,11 @@ constexpr uint16_t BLE_CONN_INT_MAX_ACTIVE = 16;    // 20ms (was 30ms)
 constexpr uint16_t BLE_LATENCY_ACTIVE = 0;          // No skipping during transfer
 constexpr uint16_t BLE_TIMEOUT_ACTIVE = 300;        // 3 seconds
 
-// POWER: Advertising intervals - balance between reconnection speed and power
-// Units: 0.625ms per unit
-// Fast advertising on boot/wake: 50ms for quick discovery
-constexpr uint16_t BLE_ADV_INT_MIN_FAST   = 0x0050;   // 50ms
-constexpr uint16_t BLE_ADV_INT_MAX_FAST   = 0x0050;   // 50ms
-constexpr uint32_t BLE_FAST_ADV_DURATION_MS = 25000;   // 25 seconds
-// Normal advertising (device active): 500-1000ms
-constexpr uint16_t BLE_ADV_INT_MIN_NORMAL = 0x0320;   // 500ms
-constexpr uint16_t BLE_ADV_INT_MAX_NORMAL = 0x0640;   // 1000ms
-// Sleep mode advertising: slower to save power
-constexpr uint16_t BLE_ADV_INT_MIN_SLEEP = 0x0640;    // 1000ms
-constexpr uint16_t BLE_ADV_INT_MAX_SLEEP = 0x0C80;    // 2000ms
+// Advertising intervals and backoff live in the scheduler (ble_adv.h)
+
+// Let a new connection settle before asking for encryption / params
+constexpr uint32_t BLE_LINK_SETUP_DELAY_MS = 50;
+constexpr uint32_t BLE_LINK_SETUP_SLACK_MS = 10;
 
 // POWER: Sleep mode connection parameters - much slower to reduce BLE wakeups
 constexpr uint16_t BLE_CONN_INT_MIN_SLEEP = 200;   // 250ms
@@ -79,10 +91,6 @@ constexpr uint16_t BLE_TIMEOUT_SLEEP = 600;        // 6 seconds
 // Track current BLE power mode
 static bool s_bleSleepMode = false;
 
-// Fast advertising state (boot/deep-sleep wake burst)
-static uint32_t s_fastAdvStartMs = 0;
-static bool s_fastAdvActive = false;
-
 // MTU: 247 bytes is optimal for ESP32 BLE
 constexpr uint16_t BLE_MTU_SIZE = 247;
 
@@ -96,41 +104,36 @@ static BLECharacteristic *g_fileChar  = nullptr;
 static BLECharacteristic *g_otaChar   = nullptr;
 static BLEServer *g_server = nullptr;
 
-static uint16_t g_connId = 0xFFFF;
-static bool g_activeTransfer = false;
-static esp_bd_addr_t g_peerBda = {0};  // Peer Bluetooth Device Address for connection params
+// Per-link id, address and transfer state live in ble_conn.h
 
-// Connection parameter update throttling
-static uint32_t s_lastParamUpdateMs = 0;
+// Connection parameter update throttling (per link)
 constexpr uint32_t BLE_PARAM_UPDATE_MIN_INTERVAL_MS = 1500;  // Reduced from 2s
 
 // Error tracking for connection health monitoring
-static uint32_t s_notifyErrors = 0;
 static uint32_t s_connectionErrors = 0;
 static uint32_t s_lastSuccessfulNotifyMs = 0;
 constexpr uint32_t CONNECTION_UNHEALTHY_THRESHOLD_MS = 5000;  // 5s without success
-constexpr uint32_t MAX_NOTIFY_RETRIES = 3;
 
 // -----------------------------------------------------------------------------
 // Connection Parameter Update
 // -----------------------------------------------------------------------------
 
-static void requestConnectionParams(bool activeTransfer) {
-    if (g_connId == 0xFFFF || !g_bleConnected) return;
+static void requestConnectionParams(BleConn *c, bool activeTransfer) {
+    if (!c) return;
 
     // Skip if already in requested state
-    if (g_activeTransfer == activeTransfer) {
+    if (c->activeTransfer == activeTransfer) {
         return;
     }
 
     // Throttle updates - minimum interval between changes
     uint32_t now = millis();
-    if (s_lastParamUpdateMs > 0 && (now - s_lastParamUpdateMs) < BLE_PARAM_UPDATE_MIN_INTERVAL_MS) {
+    if (c->lastParamUpdateMs > 0 && (now - c->lastParamUpdateMs) < BLE_PARAM_UPDATE_MIN_INTERVAL_MS) {
         return;  // Silently skip (don't spam logs)
     }
 
     esp_ble_conn_update_params_t params = {};
-    memcpy(params.bda, g_peerBda, sizeof(esp_bd_addr_t));  // Required: peer device address
+    memcpy(params.bda, c->bda, sizeof(esp_bd_addr_t));  // Required: peer device address
 
     if (activeTransfer) {
         params.min_int = BLE_CONN_INT_MIN_ACTIVE;
@@ -149,56 +152,150 @@ static void requestConnectionParams(bool activeTransfer) {
         s_connectionErrors++;
     }
 
-    g_activeTransfer = activeTransfer;
-    s_lastParamUpdateMs = now;
+    c->activeTransfer = activeTransfer;
+    c->lastParamUpdateMs = now;
+}
+
+// Sleep / normal parameters on every open link
+static void requestIdleParams(uint16_t minInt, uint16_t maxInt, uint16_t latency, uint16_t timeout) {
+    for (int i = 0; i < BLE_MAX_CONNS; i++) {
+        BleConn *c = bleConnAt(i);
+        if (!c) continue;
+        esp_ble_conn_update_params_t params = {};
+        memcpy(params.bda, c->bda, sizeof(esp_bd_addr_t));  // Required: peer device address
+        params.min_int = minInt;
+        params.max_int = maxInt;
+        params.latency = latency;
+        params.timeout = timeout;
+        if (esp_ble_gap_update_conn_params(&params) != ESP_OK) s_connectionErrors++;
+    }
 }
 
 // -----------------------------------------------------------------------------
 // Server Callbacks
 // -----------------------------------------------------------------------------
 
+// The callbacks run on the BTC task: they only update the link table
+// (ble_conn.h) and the globals the stack-side code needs right away, and
+// queue the rest for the main loop (work_queue.h).
+
 class ServerCallbacks : public BLEServerCallbacks {
     void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) override {
+        CallbackTimer timing(CB_GATTS_CONNECT);
+        const uint16_t connId = param->connect.conn_id;
+        BleConn *c = bleConnOpen(connId, param->connect.remote_bda);
+        if (!c) return;   // More links than CONFIG_BT_ACL_CONNECTIONS - can't happen
+        c->interval = param->connect.conn_params.interval;
+        c->latency = param->connect.conn_params.latency;
+        c->timeout = param->connect.conn_params.timeout;
+
+        // First link: reset error tracking
+        if (!g_bleConnected) {
+            s_lastSuccessfulNotifyMs = millis();
+            s_connectionErrors = 0;
+        }
         g_bleConnected = true;
-        g_connId = param->connect.conn_id;
-        memcpy(g_peerBda, param->connect.remote_bda, sizeof(esp_bd_addr_t));  // Save peer address
-        s_lastSuccessfulNotifyMs = millis();
 
-        // Reset error counters on new connection
-        s_notifyErrors = 0;
-        s_connectionErrors = 0;
+        TRACE1(TR_BLE_CONNECT, connId);
+        // Link count as of this connect - the loop may drain two at once
+        uint8_t state[sizeof(esp_bd_addr_t) + 1];
+        memcpy(state, param->connect.remote_bda, sizeof(esp_bd_addr_t));
+        state[sizeof(esp_bd_addr_t)] = (uint8_t)bleConnCount();
+        workQueuePost(WORK_BLE_CONNECT, state, sizeof(state), connId);
+    }
+
+    void onDisconnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) override {
+        CallbackTimer timing(CB_GATTS_DISCONNECT);
+        const uint16_t connId = param->disconnect.conn_id;
+        bleConnClose(connId);
+        g_bleConnected = bleConnCount() > 0;
 
-        Serial.printf("[BLE] connected peer=%02X:%02X:%02X:%02X:%02X:%02X\n",
-                      g_peerBda[0], g_peerBda[1], g_peerBda[2],
-                      g_peerBda[3], g_peerBda[4], g_peerBda[5]);
+        TRACE1(TR_BLE_DISCONNECT, connId);
+        workQueuePost(WORK_BLE_DISCONNECT, param->disconnect.remote_bda, sizeof(esp_bd_addr_t), connId);
+    }
+
+    void onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) override {
+        bleConnOnMtu(param->mtu.conn_id, param->mtu.mtu);
+    }
+};
 
-        // Notify power manager
-        powerHandleBLEConnect();
-        powerMarkActivity();
+// -----------------------------------------------------------------------------
+// Link events - main loop (work queue)
+// -----------------------------------------------------------------------------
 
-        // Short delay for connection to stabilize
-        delay(50);  // Reduced from 100ms
+// Runs BLE_LINK_SETUP_DELAY_MS after each connect, once the link has settled
+static void linkSetupTimer() {
+    const uint32_t now = millis();
+    uint32_t nextMs = 0;
+    for (int i = 0; i < BLE_MAX_CONNS; i++) {
+        BleConn *c = bleConnAt(i);
+        if (!c || c->linkSetupDone) continue;
+        const uint32_t ageMs = now - c->connectedMs;
+        if (ageMs < BLE_LINK_SETUP_DELAY_MS) {
+            const uint32_t leftMs = BLE_LINK_SETUP_DELAY_MS - ageMs;
+            if (!nextMs || leftMs < nextMs) nextMs = leftMs;
+            continue;
+        }
+        c->linkSetupDone = true;
 
         // Request link encryption - restores bonding keys for bonded peers,
         // or triggers pairing/bonding for new peers
-        esp_ble_set_encryption(param->connect.remote_bda, ESP_BLE_SEC_ENCRYPT);
+        esp_ble_set_encryption(c->bda, ESP_BLE_SEC_ENCRYPT);
 
         // Request connection parameters for normal operation
-        requestConnectionParams(false);
+        requestConnectionParams(c, false);
+
+        // PHY for the link telemetry - later changes arrive as PHY updates
+        esp_ble_gap_read_phy(c->bda);
+    }
+    if (nextMs) timerStart(TIMER_BLE_LINK_SETUP, linkSetupTimer, nextMs, BLE_LINK_SETUP_SLACK_MS);
+}
 
-        timeSyncHandleConnected();
+static void handleConnectWork(const WorkItem &item) {
+    const uint8_t *peer = item.data;
+    const int links = item.data[sizeof(esp_bd_addr_t)];
+    const bool firstLink = links == 1;
+
+    // Session hint for the next deep sleep wake - the first central is the phone
+    if (firstLink) {
+        RtcBleHint &hint = rtcState().ble;
+        memcpy(hint.peerBda, peer, sizeof(hint.peerBda));
+        hint.peerValid = 1;
     }
 
-    void onDisconnect(BLEServer* pServer) override {
-        g_bleConnected = false;
-        g_connId = 0xFFFF;
-        g_activeTransfer = false;
-        s_lastParamUpdateMs = 0;
-        memset(g_peerBda, 0, sizeof(g_peerBda));  // Clear peer address
+    Serial.printf("[BLE] connected conn=%u peer=%02X:%02X:%02X:%02X:%02X:%02X (%d links)\n",
+                  item.connId, peer[0], peer[1], peer[2], peer[3], peer[4], peer[5], links);
+
+    // Notify power manager
+    powerHandleBLEConnect();
+    powerMarkActivity();
+
+    // Short delay for connection to stabilize - a timer, not delay()
+    timerStart(TIMER_BLE_LINK_SETUP, linkSetupTimer, BLE_LINK_SETUP_DELAY_MS, BLE_LINK_SETUP_SLACK_MS);
+
+    transportLinkEvent(item.connId, TP_EVT_CONNECTED);
+    if (firstLink) timeSyncHandleConnected();
+    bleReconnectOnConnected();
+    bleAdvOnEvent(ADV_EVT_CONNECTED);
+    bleTxPowerOnConnected();
+}
+
+static void handleBondedWork(const WorkItem &) {
+    bleConnSaveSubscriptions();
+}
+
+static void handleDisconnectWork(const WorkItem &item) {
+    const int links = bleConnCount();
+    Serial.printf("[BLE] disconnected conn=%u (%d links left)\n", item.connId, links);
 
-        Serial.println("[BLE] disconnected, restarting advertising");
+    // Per-peer state
+    bleTxPowerOnDisconnected();
+    bleCtsHandleDisconnected(item.data);
+    transportLinkEvent(item.connId, TP_EVT_DISCONNECTED);
+    bleTelemetryUpdate();
 
-        // Stop any ongoing recording
+    // The hub is gone - the recording / answer / time exchange went with it
+    if (!bleConnHub()) {
         if (g_recordingInProgress) {
             g_recordingInProgress = false;
             finalizeRecordingTimer();
@@ -206,25 +303,90 @@ class ServerCallbacks : public BLEServerCallbacks {
             stopMic();
         }
         currentState = IDLE;
-
         timeSyncHandleDisconnected();
-        otaHandleDisconnected();
+    }
 
+    // POWER: Don't wake device on disconnect - let it stay in current power state
+    // This prevents the watch from turning on when BLE disconnects while sleeping
+    // powerMarkActivity();
+    if (links == 0) {
+        timerStop(TIMER_BLE_LINK_SETUP);
         powerHandleBLEDisconnect();
-        // POWER: Don't wake device on disconnect - let it stay in current power state
-        // This prevents the watch from turning on when BLE disconnects while sleeping
-        // powerMarkActivity();
-
-        // Restart advertising - use fast intervals if still in boot burst window
-        if (s_fastAdvActive) {
-            BLEAdvertising *adv = BLEDevice::getAdvertising();
-            adv->setMinInterval(BLE_ADV_INT_MIN_FAST);
-            adv->setMaxInterval(BLE_ADV_INT_MAX_FAST);
-        }
-        BLEDevice::startAdvertising();
-        Serial.println("[BLE] advertising restarted after disconnect");
     }
-};
+
+    bleAdvOnEvent(ADV_EVT_DISCONNECTED);   // Profile restarts from the top
+}
+
+// GAP advertising completions (ble_adv.h): data[0] = started, data[1] = ok
+static void handleAdvStateWork(const WorkItem &item) {
+    if (!item.data[0]) {
+        bleAdvOnEvent(ADV_EVT_STACK_STOPPED);
+    } else {
+        bleAdvOnEvent(item.data[1] ? ADV_EVT_STACK_STARTED : ADV_EVT_STACK_FAILED);
+    }
+}
+
+// Link RSSI sample (ble_txpower.h): data[0] = ok, data[1] = rssi, peer address
+static void handleRssiWork(const WorkItem &item) {
+    bleTxPowerOnRssi(item.data + 2, item.data[0], (int8_t)item.data[1]);
+}
+
+// CCCD write (ble_conn.h): data[0] = BleChannel, data[1] = on
+static void handleSubscribeWork(const WorkItem &item) {
+    if (item.data[0] == BLE_CH_TELEMETRY) bleTelemetryUpdate();
+    bleConnSaveSubscriptions();
+}
+
+// BTC task - CCCD writes and congestion per link, after Arduino's handling
+static void gattsEventHandler(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf,
+                              esp_ble_gatts_cb_param_t *param) {
+    bleConnGattsEvent(event, param);
+}
+
+// BTC task - Arduino's own GAP handling runs after this
+static void gapEventHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
+    if (event == ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT) {
+        const auto &p = param->update_conn_params;
+        bleConnOnParams(p.bda, p.status == ESP_BT_STATUS_SUCCESS, p.conn_int, p.latency, p.timeout);
+        return;
+    }
+    if (event == ESP_GAP_BLE_READ_PHY_COMPLETE_EVT) {
+        const auto &p = param->read_phy;
+        if (p.status == ESP_BT_STATUS_SUCCESS) bleConnOnPhy(p.bda, p.tx_phy, p.rx_phy);
+        return;
+    }
+    if (event == ESP_GAP_BLE_PHY_UPDATE_COMPLETE_EVT) {
+        const auto &p = param->phy_update;
+        if (p.status == ESP_BT_STATUS_SUCCESS) bleConnOnPhy(p.bda, p.tx_phy, p.rx_phy);
+        return;
+    }
+    if (event != ESP_GAP_BLE_ADV_START_COMPLETE_EVT && event != ESP_GAP_BLE_ADV_STOP_COMPLETE_EVT &&
+        event != ESP_GAP_BLE_READ_RSSI_COMPLETE_EVT) {
+        return;
+    }
+    CallbackTimer timing(CB_GAP_EVENT);
+    uint8_t state[2 + sizeof(esp_bd_addr_t)];
+    switch (event) {
+        case ESP_GAP_BLE_ADV_START_COMPLETE_EVT:
+            state[0] = 1;
+            state[1] = param->adv_start_cmpl.status == ESP_BT_STATUS_SUCCESS;
+            workQueuePost(WORK_BLE_ADV_STATE, state, 2);
+            break;
+        case ESP_GAP_BLE_ADV_STOP_COMPLETE_EVT:
+            state[0] = 0;
+            state[1] = param->adv_stop_cmpl.status == ESP_BT_STATUS_SUCCESS;
+            workQueuePost(WORK_BLE_ADV_STATE, state, 2);
+            break;
+        case ESP_GAP_BLE_READ_RSSI_COMPLETE_EVT:
+            state[0] = param->read_rssi_cmpl.status == ESP_BT_STATUS_SUCCESS;
+            state[1] = (uint8_t)param->read_rssi_cmpl.rssi;
+            memcpy(state + 2, param->read_rssi_cmpl.remote_addr, sizeof(esp_bd_addr_t));
+            workQueuePost(WORK_BLE_RSSI, state, sizeof(state));
+            break;
+        default:
+            break;
+    }
+}
 
 // -----------------------------------------------------------------------------
 // Security Callbacks - BLE bonding event handler
@@ -247,12 +409,17 @@ class SecurityCallbacks : public BLESecurityCallbacks {
         return true;
     }
     void onAuthenticationComplete(esp_ble_auth_cmpl_t cmpl) override {
+        CallbackTimer timing(CB_GAP_AUTH);
         if (cmpl.success) {
             Serial.printf("[BLE-SEC] bonding OK peer=%02X:%02X:%02X:%02X:%02X:%02X mode=0x%02x\n",
                 cmpl.bd_addr[0], cmpl.bd_addr[1], cmpl.bd_addr[2],
                 cmpl.bd_addr[3], cmpl.bd_addr[4], cmpl.bd_addr[5],
                 cmpl.auth_mode);
+            bleConnOnEncrypted(cmpl.bd_addr, cmpl.auth_mode & ESP_LE_AUTH_BOND);
+            if (g_bleConnected) bleCtsOnLinkEncrypted(cmpl.bd_addr);
+            workQueuePost(WORK_BLE_BONDED, cmpl.bd_addr, sizeof(esp_bd_addr_t));
         } else {
+            TRACE1(TR_BLE_AUTH_FAIL, cmpl.fail_reason);
             Serial.printf("[BLE-SEC] bonding FAILED reason=0x%x\n", cmpl.fail_reason);
         }
     }
@@ -262,9 +429,11 @@ class SecurityCallbacks : public BLESecurityCallbacks {
 // Initialization
 // -----------------------------------------------------------------------------
 
+// Runs on a boot task (boot_profiler.h) - no timer service calls in here
 void initBLE() {
 
     BLEDevice::init(DEVICE_NAME);
+    bootMark(BOOT_BLE_STACK);
 
     // Log BLE address - this is the public address from eFuse, stable across deep sleep
     esp_bd_addr_t bleAddr;
@@ -272,6 +441,13 @@ void initBLE() {
     Serial.printf("[BLE] address=%02X:%02X:%02X:%02X:%02X:%02X (public, eFuse-stable)\n",
                   bleAddr[0], bleAddr[1], bleAddr[2], bleAddr[3], bleAddr[4], bleAddr[5]);
 
+    if (rtcStateResumed() && rtcState().ble.peerValid) {
+        const uint8_t *peer = rtcState().ble.peerBda;
+        Serial.printf("[BLE] last peer %02X:%02X:%02X:%02X:%02X:%02X (%s at sleep)\n",
+                      peer[0], peer[1], peer[2], peer[3], peer[4], peer[5],
+                      rtcState().ble.wasConnected ? "connected" : "idle");
+    }
+
     // =========================================================================
     // SECURITY - BLE bonding for iOS auto-reconnect after deep sleep
     // =========================================================================
@@ -289,24 +465,6 @@ void initBLE() {
     security.setRespEncryptionKey(ESP_BLE_ENC_KEY_MASK | ESP_BLE_ID_KEY_MASK);  // Accept LTK + IRK
     Serial.println("[BLE-SEC] security: SC+Bond, JustWorks, LTK+IRK");
 
-    // Log bonded peers persisted in NVS from previous sessions
-    int bondCount = esp_ble_get_bond_device_num();
-    Serial.printf("[BLE-SEC] bonded peers in NVS: %d\n", bondCount);
-    if (bondCount > 0) {
-        esp_ble_bond_dev_t *bondList = (esp_ble_bond_dev_t *)malloc(
-            bondCount * sizeof(esp_ble_bond_dev_t));
-        if (bondList) {
-            int actual = bondCount;
-            esp_ble_get_bond_device_list(&actual, bondList);
-            for (int i = 0; i < actual; i++) {
-                Serial.printf("[BLE-SEC]   peer[%d]=%02X:%02X:%02X:%02X:%02X:%02X\n", i,
-                    bondList[i].bd_addr[0], bondList[i].bd_addr[1], bondList[i].bd_addr[2],
-                    bondList[i].bd_addr[3], bondList[i].bd_addr[4], bondList[i].bd_addr[5]);
-            }
-            free(bondList);
-        }
-    }
-
     // Set MTU
     BLEDevice::setMTU(BLE_MTU_SIZE);
 
@@ -320,16 +478,28 @@ void initBLE() {
     // Advertising power: 0 dBm for reliable discovery
     esp_ble_tx_power_set(ESP_BLE_PWR_TYPE_ADV, ESP_PWR_LVL_N0);
 
-    // Connection power: +3 dBm for reliability during transfers
-    esp_ble_tx_power_set(ESP_BLE_PWR_TYPE_CONN_HDL0, ESP_PWR_LVL_P3);
-    esp_ble_tx_power_set(ESP_BLE_PWR_TYPE_CONN_HDL1, ESP_PWR_LVL_P3);
-    esp_ble_tx_power_set(ESP_BLE_PWR_TYPE_CONN_HDL2, ESP_PWR_LVL_P3);
+    // Connection power: +3 dBm at connect, then follows the link RSSI
+    // (ble_txpower.h)
+    bleTxPowerInit();
 
     // Default/scan power
     esp_ble_tx_power_set(ESP_BLE_PWR_TYPE_DEFAULT, ESP_PWR_LVL_N0);
 
 
     // Create server
+    workQueueRegister(WORK_BLE_CONNECT, handleConnectWork);
+    workQueueRegister(WORK_BLE_DISCONNECT, handleDisconnectWork);
+    workQueueRegister(WORK_BLE_BONDED, handleBondedWork);
+    workQueueRegister(WORK_BLE_ADV_STATE, handleAdvStateWork);
+    workQueueRegister(WORK_BLE_RSSI, handleRssiWork);
+    workQueueRegister(WORK_BLE_SUBSCRIBE, handleSubscribeWork);
+    bleTransportInit();
+    bleTextInit();
+    bleFileInit();
+    bleOtaInit();
+    BLEDevice::setCustomGapHandler(gapEventHandler);
+    BLEDevice::setCustomGattsHandler(gattsEventHandler);
+
     g_server = BLEDevice::createServer();
     g_server->setCallbacks(new ServerCallbacks());
 
@@ -337,6 +507,7 @@ void initBLE() {
     BLEService *service = g_server->createService(HOLLOW_SERVICE_UUID);
     BLEService *fileService = g_server->createService(HOLLOW_FILE_SERVICE_UUID);
     BLEService *otaService = g_server->createService(HOLLOW_OTA_SERVICE_UUID);
+    BLEService *diagService = g_server->createService(HOLLOW_DIAG_SERVICE_UUID);
 
     // Audio characteristic (notify)
     g_audioChar = service->createCharacteristic(
@@ -350,7 +521,7 @@ void initBLE() {
         TEXT_CHAR_UUID,
         BLECharacteristic::PROPERTY_WRITE
     );
-    g_textChar->setCallbacks(createTextCallbacks());
+    g_textChar->setCallbacks(bleTransportCallbacks(TP_CH_TEXT));
 
     // File characteristic (notify + write)
     g_fileChar = fileService->createCharacteristic(
@@ -358,7 +529,7 @@ void initBLE() {
         BLECharacteristic::PROPERTY_NOTIFY | BLECharacteristic::PROPERTY_WRITE
     );
     g_fileChar->addDescriptor(new BLE2902());
-    g_fileChar->setCallbacks(createFileCallbacks());
+    g_fileChar->setCallbacks(bleTransportCallbacks(TP_CH_FILE));
 
     // OTA characteristic (notify + write)
     g_otaChar = otaService->createCharacteristic(
@@ -366,35 +537,60 @@ void initBLE() {
         BLECharacteristic::PROPERTY_NOTIFY | BLECharacteristic::PROPERTY_WRITE
     );
     g_otaChar->addDescriptor(new BLE2902());
-    initOtaCharacteristic(g_otaChar);
-    g_otaChar->setCallbacks(createOtaCallbacks());
+    g_otaChar->setCallbacks(bleTransportCallbacks(TP_CH_OTA));
+
+    // Diagnostics characteristic (write selector + read snapshot)
+    BLECharacteristic *diagChar = diagService->createCharacteristic(
+        HOLLOW_DIAG_CHAR_UUID,
+        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_WRITE
+    );
+    diagChar->setCallbacks(createDiagCallbacks());
+
+    // Trace ring characteristic (write start entry + read pages)
+    BLECharacteristic *traceChar = diagService->createCharacteristic(
+        HOLLOW_TRACE_CHAR_UUID,
+        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_WRITE
+    );
+    traceChar->setCallbacks(createTraceCallbacks());
+
+    // Link telemetry characteristic (read + 1s notify snapshots)
+    BLECharacteristic *linkChar = diagService->createCharacteristic(
+        HOLLOW_LINK_CHAR_UUID,
+        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
+    );
+    linkChar->addDescriptor(new BLE2902());
+    linkChar->setCallbacks(createTelemetryCallbacks());
 
     // Start services
     service->start();
     fileService->start();
     otaService->start();
+    diagService->start();
+
+    BLECharacteristic *const channels[BLE_CH_COUNT] = { g_audioChar, g_fileChar, g_otaChar, linkChar };
+    bleConnInit(g_server, channels);
 
     // =========================================================================
     // ADVERTISING - iOS auto-reconnect compatible
     // =========================================================================
     // Primary ADV payload: Hollow service UUID ONLY (no file/OTA UUIDs)
     // iOS matches on this UUID for background reconnection.
-    // File and OTA services are discovered via GATT after connection.
+    // File, OTA and diagnostics services are discovered via GATT after connection.
     BLEAdvertising *adv = BLEDevice::getAdvertising();
     adv->addServiceUUID(HOLLOW_SERVICE_UUID);
     adv->setScanResponse(true);    // Name goes in scan response
     adv->setMinPreferred(0x06);    // Preferred connection interval hint
     adv->setMaxPreferred(0x12);
 
-    // Start with fast advertising (50ms) for quick discovery on boot/wake
-    adv->setMinInterval(BLE_ADV_INT_MIN_FAST);
-    adv->setMaxInterval(BLE_ADV_INT_MAX_FAST);
-    s_fastAdvStartMs = millis();
-    s_fastAdvActive = true;
+    // Start advertising - the backoff profile (ble_adv.h)
+    bleReconnectBegin();
+    bleAdvBegin();
+    bootMark(BOOT_ADVERTISING);
+    Serial.printf("[BLE] advertising started (svc=%s)\n", HOLLOW_SERVICE_UUID);
+}
 
-    // Start advertising
-    BLEDevice::startAdvertising();
-    Serial.printf("[BLE] advertising started (fast 50ms, svc=%s)\n", HOLLOW_SERVICE_UUID);
+void bleStartMaintenance() {
+    bleAdvStartTimers();
 }
 
 // -----------------------------------------------------------------------------
@@ -405,68 +601,27 @@ bool bleIsConnected() {
     return g_bleConnected;
 }
 
-BLECharacteristic *bleGetAudioChar() {
-    return g_audioChar;
-}
-
-BLECharacteristic *bleGetTextChar() {
-    return g_textChar;
-}
-
-BLECharacteristic *bleGetFileChar() {
-    return g_fileChar;
-}
-
-BLECharacteristic *bleGetOtaChar() {
-    return g_otaChar;
-}
-
+// Some link has audio notifications on (the hub, ble_conn.h)
 bool bleNotifyEnabled() {
-    if (!g_audioChar) return false;
-    BLEDescriptor *d = g_audioChar->getDescriptorByUUID(BLEUUID((uint16_t)0x2902));
-    if (!d) return false;
-    uint8_t *val = d->getValue();
-    return val && (val[0] & 0x01);
+    return bleConnHub() != nullptr;
 }
 
 bool canSendControlMessages() {
     return g_bleConnected && bleNotifyEnabled();
 }
 
-// Called when starting audio transfer - switch to fast connection params
+// Called when starting audio transfer - pin the hub, switch it to fast params
 void bleEnterActiveTransfer() {
-    requestConnectionParams(true);
+    pmLockAcquire(PM_LOCK_BLE_BULK);
+    bleConnPinHub(true);
+    requestConnectionParams(bleConnHub(), true);
 }
 
 // Called when audio transfer complete - switch back to low power params
 void bleExitActiveTransfer() {
-    requestConnectionParams(false);
-}
-
-// Periodic advertising restart + fast→normal transition
-void ensureAdvertisingAlive() {
-    if (g_bleConnected) return;
-
-    uint32_t now = millis();
-
-    // Transition from fast to normal advertising after 25 seconds
-    if (s_fastAdvActive && (now - s_fastAdvStartMs >= BLE_FAST_ADV_DURATION_MS)) {
-        s_fastAdvActive = false;
-        BLEAdvertising *adv = BLEDevice::getAdvertising();
-        adv->setMinInterval(BLE_ADV_INT_MIN_NORMAL);
-        adv->setMaxInterval(BLE_ADV_INT_MAX_NORMAL);
-        BLEDevice::startAdvertising();
-        return;
-    }
-
-    static uint32_t lastKickMs = 0;
-
-    // POWER: Restart advertising less frequently - every 30 seconds
-    // (was 15s, but advertising rarely fails and this saves power)
-    if (now - lastKickMs > 30000) {
-        lastKickMs = now;
-        BLEDevice::startAdvertising();
-    }
+    requestConnectionParams(bleConnHub(), false);
+    bleConnPinHub(false);
+    pmLockRelease(PM_LOCK_BLE_BULK);
 }
 
 // =============================================================================
@@ -478,29 +633,11 @@ void ensureAdvertisingAlive() {
 void bleEnterSleepMode() {
     if (s_bleSleepMode) return;  // Already in sleep mode
     s_bleSleepMode = true;
-    s_fastAdvActive = false;  // Cancel fast advertising burst
 
     // If connected, request slower connection parameters
-    if (g_bleConnected && g_connId != 0xFFFF) {
-        esp_ble_conn_update_params_t params = {};
-        memcpy(params.bda, g_peerBda, sizeof(esp_bd_addr_t));  // Required: peer device address
-        params.min_int = BLE_CONN_INT_MIN_SLEEP;
-        params.max_int = BLE_CONN_INT_MAX_SLEEP;
-        params.latency = BLE_LATENCY_SLEEP;
-        params.timeout = BLE_TIMEOUT_SLEEP;
-
-        esp_err_t err = esp_ble_gap_update_conn_params(&params);
-        if (err == ESP_OK) {
-        }
-    }
+    requestIdleParams(BLE_CONN_INT_MIN_SLEEP, BLE_CONN_INT_MAX_SLEEP, BLE_LATENCY_SLEEP, BLE_TIMEOUT_SLEEP);
 
-    // If advertising, switch to slower intervals
-    if (!g_bleConnected) {
-        BLEAdvertising *adv = BLEDevice::getAdvertising();
-        adv->setMinInterval(BLE_ADV_INT_MIN_SLEEP);
-        adv->setMaxInterval(BLE_ADV_INT_MAX_SLEEP);
-        BLEDevice::startAdvertising();
-    }
+    bleAdvOnEvent(ADV_EVT_SCREEN_OFF);   // Skips ahead to the slow step
 }
 
 void bleExitSleepMode() {
@@ -508,26 +645,9 @@ void bleExitSleepMode() {
     s_bleSleepMode = false;
 
     // If connected, restore normal connection parameters
-    if (g_bleConnected && g_connId != 0xFFFF) {
-        esp_ble_conn_update_params_t params = {};
-        memcpy(params.bda, g_peerBda, sizeof(esp_bd_addr_t));  // Required: peer device address
-        params.min_int = BLE_CONN_INT_MIN_NORMAL;
-        params.max_int = BLE_CONN_INT_MAX_NORMAL;
-        params.latency = BLE_LATENCY_NORMAL;
-        params.timeout = BLE_TIMEOUT_NORMAL;
-
-        esp_err_t err = esp_ble_gap_update_conn_params(&params);
-        if (err == ESP_OK) {
-        }
-    }
+    requestIdleParams(BLE_CONN_INT_MIN_NORMAL, BLE_CONN_INT_MAX_NORMAL, BLE_LATENCY_NORMAL, BLE_TIMEOUT_NORMAL);
 
-    // If advertising, restore normal intervals
-    if (!g_bleConnected) {
-        BLEAdvertising *adv = BLEDevice::getAdvertising();
-        adv->setMinInterval(BLE_ADV_INT_MIN_NORMAL);
-        adv->setMaxInterval(BLE_ADV_INT_MAX_NORMAL);
-        BLEDevice::startAdvertising();
-    }
+    bleAdvOnEvent(ADV_EVT_SCREEN_ON);
 }
 
 bool bleIsInSleepMode() {
@@ -538,41 +658,12 @@ bool bleIsInSleepMode() {
 // Error Handling and Connection Health
 // -----------------------------------------------------------------------------
 
-bool bleSendNotifyWithRetry(BLECharacteristic* characteristic, const uint8_t* data, size_t len) {
-    if (!characteristic || !g_bleConnected) {
-        return false;
-    }
-
-    // Try to send with retries on failure
-    for (uint32_t retry = 0; retry < MAX_NOTIFY_RETRIES; retry++) {
-        characteristic->setValue(const_cast<uint8_t*>(data), len);
-        characteristic->notify();
-
-        // Check if still connected after notify (connection may drop on error)
-        if (g_bleConnected) {
-            // Success tracking
-            s_lastSuccessfulNotifyMs = millis();
-            return true;
-        }
-
-        // Connection lost during notify - retry after brief delay
-        if (retry < MAX_NOTIFY_RETRIES - 1) {
-            delay(10);  // Brief delay before retry
-        }
-    }
-
-    // All retries failed
-    s_notifyErrors++;
-    return false;
-}
-
 uint32_t bleGetConnectionErrors() {
-    return s_connectionErrors + s_notifyErrors;
+    return s_connectionErrors + bleConnNotifyErrors();
 }
 
 void bleResetConnectionErrors() {
     s_connectionErrors = 0;
-    s_notifyErrors = 0;
 }
 
 bool bleIsConnectionHealthy() {
@@ -589,6 +680,7 @@ bool bleIsConnectionHealthy() {
 // Full BLE shutdown for deep sleep
 // =============================================================================
 void bleFullShutdown() {
+    rtcState().ble.wasConnected = g_bleConnected ? 1 : 0;
 
     // 1. Stop advertising
     BLEAdvertising* adv = BLEDevice::getAdvertising();
@@ -596,12 +688,12 @@ void bleFullShutdown() {
         adv->stop();
     }
 
-    // 2. Disconnect any active connection
-    if (g_bleConnected && g_server) {
-        g_server->disconnect(g_connId);
-        g_bleConnected = false;
-        g_connId = 0xFFFF;
+    // 2. Disconnect every open link
+    for (int i = 0; i < BLE_MAX_CONNS && g_server; i++) {
+        BleConn *c = bleConnAt(i);
+        if (c) g_server->disconnect(c->connId);
     }
+    g_bleConnected = false;
 
     // 3. Wait for BLE stack to process pending operations
     delay(150);
@@ -9,19 +9,19 @@
 #include <BLEUtils.h>
 #include <BLE2902.h>
 
-// Initialization
+// Initialization. initBLE() brings up the stack and starts advertising and
+// may run on a boot task; bleStartMaintenance() arms the advertising timers
+// and applies the battery tier (loop task, after initBLE() has finished).
 void initBLE();
+void bleStartMaintenance();
 
-// Connection state
+// Connection state. Connected = any link; notify / control messages go to
+// the hub link (per-link context: ble_conn.h)
 bool bleIsConnected();
 bool bleNotifyEnabled();
 bool canSendControlMessages();
 
-// Characteristic accessors
-BLECharacteristic *bleGetAudioChar();
-BLECharacteristic *bleGetTextChar();
-BLECharacteristic *bleGetFileChar();
-BLECharacteristic *bleGetOtaChar();
+// Protocol modules send and receive through ble_transport.h
 
 // Power management integration
 // Call when starting/ending high-throughput transfers (audio streaming)
@@ -36,11 +36,7 @@ void bleEnterSleepMode();
 void bleExitSleepMode();
 bool bleIsInSleepMode();
 
-// Periodic maintenance (call from loop, handles advertising restart)
-void ensureAdvertisingAlive();
-
 // Connection quality and error handling
-bool bleSendNotifyWithRetry(BLECharacteristic* characteristic, const uint8_t* data, size_t len);
 uint32_t bleGetConnectionErrors();
 void bleResetConnectionErrors();
 bool bleIsConnectionHealthy();
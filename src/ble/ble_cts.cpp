@@ -0,0 +1,212 @@
+#include "ble_cts.h"
+
+#include <BLEDevice.h>
+#include <BLEClient.h>
+#include <string.h>
+#include <atomic>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "../system/time_sync.h"
+#include "../system/events.h"
+
+constexpr uint16_t CTS_SERVICE_UUID16      = 0x1805;
+constexpr uint16_t CTS_CURRENT_TIME_UUID16 = 0x2A2B;
+constexpr size_t CTS_CURRENT_TIME_LEN      = 10;     // Exact Time 256 + adjust reason
+constexpr float CTS_NOTIFY_UNCERTAINTY_S   = 0.5f;   // One sigma: one-way, latency unknown
+constexpr uint32_t CTS_TASK_STACK          = 4096;
+constexpr UBaseType_t CTS_TASK_PRIORITY    = 1;
+
+enum CtsJob : uint8_t { CTS_JOB_DISCOVER, CTS_JOB_READ };
+
+static BLEClient *s_client = nullptr;
+static esp_bd_addr_t s_peer;
+static std::atomic<bool> s_busy{false};     // A worker task is running (BTC and loop start jobs)
+static volatile bool s_triedThisLink = false;
+static uint32_t s_jobLink = 0;              // s_linkGen the running job started on
+
+// The characteristic belongs to s_client and is only replaced by the next
+// discovery - never while a job runs (s_busy) - so a job's snapshot stays
+// valid. A disconnect bumps the generation; a job that started on the old
+// link neither publishes its result nor brings the characteristic back.
+static portMUX_TYPE s_ctsMux = portMUX_INITIALIZER_UNLOCKED;
+static BLERemoteCharacteristic *s_timeChar = nullptr;
+static volatile bool s_available = false;
+static uint32_t s_linkGen = 0;
+
+// Result handed to the loop (s_ctsMux)
+static bool s_pending = false;
+static int64_t s_pendingEpochMs = 0;
+static int64_t s_pendingLocalUs = 0;
+static float s_pendingUncertaintyS = 0.0f;
+
+// =============================================================================
+// Internal
+// =============================================================================
+
+// Current Time: u16 year, month, day, hours, minutes, seconds, day of week,
+// fractions256, adjust reason. Phones serve local time - the same
+// "epoch + offset" convention TIME: uses.
+static int64_t parseCurrentTime(const uint8_t *d, size_t len) {
+    if (len < CTS_CURRENT_TIME_LEN) return 0;
+    const int year = d[0] | (d[1] << 8);
+    const time_t epoch = epochFromCivil(year, d[2], d[3], d[4], d[5], d[6]);
+    if (epoch <= 0) return 0;
+    return (int64_t)epoch * 1000 + (int64_t)d[8] * 1000 / 256;
+}
+
+static void postTime(uint32_t link, const uint8_t *data, size_t len, int64_t localUs,
+                     float uncertaintyS) {
+    const int64_t epochMs = parseCurrentTime(data, len);
+    if (epochMs <= 0) return;
+
+    portENTER_CRITICAL(&s_ctsMux);
+    if (link != s_linkGen) {
+        portEXIT_CRITICAL(&s_ctsMux);
+        return;   // Read on a link that is gone
+    }
+    s_pending = true;
+    s_pendingEpochMs = epochMs;
+    s_pendingLocalUs = localUs;
+    s_pendingUncertaintyS = uncertaintyS;
+    portEXIT_CRITICAL(&s_ctsMux);
+
+    eventPost(EVT_BLE);
+}
+
+static uint32_t currentLink() {
+    portENTER_CRITICAL(&s_ctsMux);
+    const uint32_t link = s_linkGen;
+    portEXIT_CRITICAL(&s_ctsMux);
+    return link;
+}
+
+static void onTimeNotify(BLERemoteCharacteristic *c, uint8_t *data, size_t len, bool isNotify) {
+    postTime(currentLink(), data, len, esp_timer_get_time(), CTS_NOTIFY_UNCERTAINTY_S);
+}
+
+static bool readTime(uint32_t link) {
+    portENTER_CRITICAL(&s_ctsMux);
+    BLERemoteCharacteristic *c = link == s_linkGen ? s_timeChar : nullptr;
+    portEXIT_CRITICAL(&s_ctsMux);
+    if (!c) return false;
+
+    const int64_t sentUs = esp_timer_get_time();
+    const std::string value = c->readValue();
+    const int64_t doneUs = esp_timer_get_time();
+    if (value.size() < CTS_CURRENT_TIME_LEN) return false;
+
+    // Served somewhere inside the round trip - half of it taken as one sigma
+    postTime(link, (const uint8_t *)value.data(), value.size(), (sentUs + doneUs) / 2,
+             (doneUs - sentUs) / 2e6f);
+    return true;
+}
+
+static bool discover(uint32_t link) {
+    if (!s_client) s_client = BLEDevice::createClient();
+
+    // Opens a GATT client on the existing link - no new connection
+    if (!s_client->isConnected() && !s_client->connect(BLEAddress(s_peer))) {
+        Serial.println("[BLE] CTS client open failed");
+        return false;
+    }
+
+    BLERemoteService *svc = s_client->getService(BLEUUID(CTS_SERVICE_UUID16));
+    if (!svc) {
+        Serial.println("[BLE] peer has no CTS");
+        return false;
+    }
+    BLERemoteCharacteristic *c = svc->getCharacteristic(BLEUUID(CTS_CURRENT_TIME_UUID16));
+    if (!c) return false;
+
+    if (c->canNotify()) c->registerForNotify(onTimeNotify);
+
+    portENTER_CRITICAL(&s_ctsMux);
+    const bool sameLink = link == s_linkGen;
+    if (sameLink) {
+        s_timeChar = c;
+        s_available = true;
+    }
+    portEXIT_CRITICAL(&s_ctsMux);
+    if (!sameLink) return false;
+    Serial.printf("[BLE] CTS found (notify=%d)\n", c->canNotify() ? 1 : 0);
+
+    if (c->canRead()) readTime(link);
+    return true;
+}
+
+static void ctsTask(void *arg) {
+    const CtsJob job = (CtsJob)(intptr_t)arg;
+    const uint32_t link = s_jobLink;
+    const bool ok = job == CTS_JOB_DISCOVER ? discover(link) : readTime(link);
+    if (!ok) {
+        // Fall back to REQ_TIME
+        portENTER_CRITICAL(&s_ctsMux);
+        if (link == s_linkGen) s_available = false;
+        portEXIT_CRITICAL(&s_ctsMux);
+    }
+    s_busy.store(false);
+    vTaskDelete(nullptr);
+}
+
+// Any task - the exchange lets exactly one caller start a job
+static bool startJob(CtsJob job) {
+    if (s_busy.exchange(true)) return false;
+    s_jobLink = currentLink();
+    if (xTaskCreate(ctsTask, "cts", CTS_TASK_STACK, (void *)(intptr_t)job,
+                    CTS_TASK_PRIORITY, nullptr) != pdPASS) {
+        s_busy.store(false);
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void bleCtsOnLinkEncrypted(const esp_bd_addr_t peer) {
+    if (s_triedThisLink) return;   // Once per connection
+    s_triedThisLink = true;
+    memcpy(s_peer, peer, sizeof(s_peer));
+    startJob(CTS_JOB_DISCOVER);
+}
+
+void bleCtsHandleDisconnected(const esp_bd_addr_t peer) {
+    if (!s_triedThisLink || memcmp(peer, s_peer, sizeof(s_peer)) != 0) return;
+    portENTER_CRITICAL(&s_ctsMux);
+    s_available = false;
+    s_timeChar = nullptr;   // The client drops its services on disconnect
+    s_linkGen++;            // A running job's result is stale
+    portEXIT_CRITICAL(&s_ctsMux);
+    s_triedThisLink = false;
+}
+
+bool bleCtsAvailable() {
+    return s_available;
+}
+
+bool bleCtsRequestRead() {
+    if (!s_available) return false;
+    return startJob(CTS_JOB_READ);
+}
+
+void bleCtsProcess() {
+    bool has = false;
+    int64_t epochMs = 0;
+    int64_t localUs = 0;
+    float uncertaintyS = 0.0f;
+
+    portENTER_CRITICAL(&s_ctsMux);
+    if (s_pending) {
+        s_pending = false;
+        has = true;
+        epochMs = s_pendingEpochMs;
+        localUs = s_pendingLocalUs;
+        uncertaintyS = s_pendingUncertaintyS;
+    }
+    portEXIT_CRITICAL(&s_ctsMux);
+
+    if (has) handleCtsTime(epochMs, localUs, uncertaintyS);
+}
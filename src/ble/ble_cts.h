@@ -0,0 +1,34 @@
+#pragma once
+
+// =============================================================================
+// BLE CTS CLIENT - Current Time Service on the connected phone
+// =============================================================================
+// iOS (and Android builds that expose it) serve the standard Current Time
+// Service (0x1805). Once the link is encrypted we open a GATT client on the
+// same connection, read Current Time (0x2A2B) and subscribe to its
+// notifications, so the clock is set by the phone OS itself - no round
+// trip through our app, no app wakeup. Resyncs read CTS instead of sending
+// REQ_TIME while it is available.
+//
+// Discovery and reads block on GATT client events, which arrive on the
+// Bluedroid task, so each job runs on a short-lived worker task. Results
+// are handed to the loop (bleCtsProcess()) like text writes.
+// =============================================================================
+
+#include <Arduino.h>
+#include <esp_gap_ble_api.h>
+
+// Link encryption completed (security callback) - discover CTS on the peer
+void bleCtsOnLinkEncrypted(const esp_bd_addr_t peer);
+
+// A link went down - only the one CTS runs on matters
+void bleCtsHandleDisconnected(const esp_bd_addr_t peer);
+
+// Peer serves CTS and the client is subscribed
+bool bleCtsAvailable();
+
+// Read Current Time now (resync). False if CTS is unavailable or busy.
+bool bleCtsRequestRead();
+
+// Apply a pending time from a read or notification (main loop)
+void bleCtsProcess();
@@ -0,0 +1,85 @@
+#include "ble_diag.h"
+
+#include <Arduino.h>
+#include <string>
+
+#include "../power/power_profiler.h"
+#include "../power/battery_policy.h"
+#include "../power/energy_ledger.h"
+#include "../system/work_queue.h"
+#include "../system/loop_profiler.h"
+#include "../system/trace.h"
+#include "../system/boot_profiler.h"
+#include "ble_telemetry.h"
+
+constexpr size_t DIAG_MAX_RECORD = 240;   // Fits one ATT read at BLE_MTU_SIZE
+
+typedef size_t (*DiagWriter)(uint8_t *buf, size_t cap);
+
+struct DiagRecordDef {
+    DiagRecord type;
+    DiagWriter write;
+};
+
+static const DiagRecordDef DIAG_RECORDS[] = {
+    { DIAG_REC_POWER_PROFILE, powerProfilerSnapshot },
+    { DIAG_REC_BATTERY_TIER,  batteryPolicySnapshot },
+    { DIAG_REC_ENERGY_LEDGER, energyLedgerSnapshot },
+    { DIAG_REC_LOOP_LATENCY,  loopProfilerSnapshot },
+    { DIAG_REC_BOOT_PROFILE,  bootProfilerSnapshot },
+    { DIAG_REC_BLE_LINK,      bleTelemetrySnapshot },
+};
+
+static volatile uint8_t s_selected = DIAG_REC_POWER_PROFILE;
+
+static DiagWriter findWriter(uint8_t type) {
+    for (const DiagRecordDef &r : DIAG_RECORDS) {
+        if (r.type == type) return r.write;
+    }
+    return nullptr;
+}
+
+class DiagCharCallbacks : public BLECharacteristicCallbacks {
+    void onWrite(BLECharacteristic *c) override {
+        CallbackTimer timing(CB_DIAG_ACCESS);
+        std::string value = c->getValue();
+        if (value.empty()) return;
+        s_selected = (uint8_t)value[0];
+    }
+
+    void onRead(BLECharacteristic *c) override {
+        CallbackTimer timing(CB_DIAG_ACCESS);
+        uint8_t buf[DIAG_MAX_RECORD];
+        size_t len = 0;
+        DiagWriter writer = findWriter(s_selected);
+        if (writer) len = writer(buf, sizeof(buf));
+        c->setValue(buf, len);
+    }
+};
+
+BLECharacteristicCallbacks *createDiagCallbacks() {
+    return new DiagCharCallbacks();
+}
+
+static volatile uint16_t s_traceCursor = 0;
+
+class TraceCharCallbacks : public BLECharacteristicCallbacks {
+    void onWrite(BLECharacteristic *c) override {
+        CallbackTimer timing(CB_DIAG_ACCESS);
+        std::string value = c->getValue();
+        if (value.size() < 2) return;
+        s_traceCursor = (uint16_t)((uint8_t)value[0] | ((uint8_t)value[1] << 8));
+    }
+
+    void onRead(BLECharacteristic *c) override {
+        CallbackTimer timing(CB_DIAG_ACCESS);
+        uint8_t buf[DIAG_MAX_RECORD];
+        const size_t len = traceDumpPage(s_traceCursor, buf, sizeof(buf));
+        if (len > 8) s_traceCursor += buf[8];   // Entry count
+        c->setValue(buf, len);
+    }
+};
+
+BLECharacteristicCallbacks *createTraceCallbacks() {
+    return new TraceCharCallbacks();
+}
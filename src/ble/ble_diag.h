@@ -0,0 +1,29 @@
+#pragma once
+
+// =============================================================================
+// BLE DIAGNOSTICS - Binary snapshots for fleet tooling
+// =============================================================================
+// One read/write characteristic on its own service. The host writes a
+// single record selector byte, then reads the record. Every record starts
+// with u8 version, u8 reserved, u16 length (little-endian), so tooling can
+// skip records it doesn't understand. The last selection sticks.
+// =============================================================================
+
+#include <BLECharacteristic.h>
+
+// Record selectors
+enum DiagRecord : uint8_t {
+    DIAG_REC_POWER_PROFILE = 0x01,   // power_profiler.h snapshot
+    DIAG_REC_BATTERY_TIER  = 0x02,   // battery_policy.h snapshot
+    DIAG_REC_ENERGY_LEDGER = 0x03,   // energy_ledger.h snapshot
+    DIAG_REC_LOOP_LATENCY  = 0x04,   // loop_profiler.h snapshot
+    DIAG_REC_BOOT_PROFILE  = 0x05,   // boot_profiler.h snapshot
+    DIAG_REC_BLE_LINK      = 0x06,   // ble_telemetry.h snapshot
+};
+
+BLECharacteristicCallbacks *createDiagCallbacks();
+
+// Trace ring dump (trace.h). The host writes a u16 start entry (0 = oldest),
+// then each read returns the next page and advances the cursor; a page
+// with no entries ends the dump.
+BLECharacteristicCallbacks *createTraceCallbacks();
@@ -1,48 +1,70 @@
 #include "ble_file.h"
 
 #include <Arduino.h>
-#include <string>
 
+#include "ble_transport.h"
+#include "ble_file_stream.h"
 #include "../hardware_config.h"
 #include "../audio/audio_i2s.h"
+#include "../power/pm_locks.h"
+#include "../system/timer_service.h"
+#include "../system/state.h"
+#include "../system/work_queue.h"
 
-void sendRecordedFileOverBle(BLECharacteristic *pChar) {
-    if (!pChar) return;
-    if (g_recorded_adpcm.empty()) {
-        return;
+constexpr uint32_t FILE_CHUNK_PERIOD_MS = 5;
+constexpr uint32_t FILE_CHUNK_SLACK_MS  = 2;
+
+// One chunk per timer tick, so the loop keeps running between chunks
+
+static void streamsEnded() {
+    timerStop(TIMER_FILE_SEND);
+    pmLockRelease(PM_LOCK_BLE_FILE);
+}
+
+static void sendNextChunk() {
+    // A new recording overwrites the buffer
+    if (g_recordingInProgress) {
+        fileStreamStopAll();
+    } else {
+        fileStreamTick();
     }
+    if (fileStreamActive() == 0) streamsEnded();
+}
+
+void sendRecordedFileOverBle(uint16_t link) {
+    if (transportSlot(link) < 0 || g_recorded_adpcm.empty()) return;
 
-    uint32_t total_len = static_cast<uint32_t>(g_recorded_adpcm.size());
-    uint8_t header[4];
-    header[0] = (uint8_t)(total_len & 0xFF);
-    header[1] = (uint8_t)((total_len >> 8) & 0xFF);
-    header[2] = (uint8_t)((total_len >> 16) & 0xFF);
-    header[3] = (uint8_t)((total_len >> 24) & 0xFF);
-
-    pChar->setValue(header, 4);
-    pChar->notify();
-
-    const size_t CHUNK_SIZE = 128;
-    size_t offset = 0;
-    while (offset < g_recorded_adpcm.size()) {
-        size_t remaining = g_recorded_adpcm.size() - offset;
-        size_t toSend = remaining < CHUNK_SIZE ? remaining : CHUNK_SIZE;
-        pChar->setValue(&g_recorded_adpcm[offset], toSend);
-        pChar->notify();
-        offset += toSend;
-        vTaskDelay(5 / portTICK_PERIOD_MS);
+    // A repeated request restarts that link's stream from the header
+    const bool wasIdle = fileStreamActive() == 0;
+    fileStreamStart(link, g_recorded_adpcm.data(), g_recorded_adpcm.size());
+    if (wasIdle && fileStreamActive() > 0) {
+        pmLockAcquire(PM_LOCK_BLE_FILE);
+        timerStart(TIMER_FILE_SEND, sendNextChunk, FILE_CHUNK_PERIOD_MS, FILE_CHUNK_SLACK_MS,
+                   FILE_CHUNK_PERIOD_MS);
     }
 }
 
-class FileCharCallbacks : public BLECharacteristicCallbacks {
-    void onWrite(BLECharacteristic *c) override {
-        std::string value = c->getValue();
-        if (value.size() == 1 && value[0] == 0x01) {
-            sendRecordedFileOverBle(c);
-        }
+// Main loop (work queue)
+static void handleFileRequest(const WorkItem &item) {
+    sendRecordedFileOverBle(item.connId);
+}
+
+// BTC task - a single 0x01 byte asks for the recording
+static void onFileReceive(uint16_t link, const uint8_t *data, size_t len) {
+    if (len == 1 && data[0] == 0x01) {
+        workQueuePost(WORK_BLE_FILE_REQUEST, nullptr, 0, link);
     }
-};
+}
+
+// Loop task
+static void onLinkEvent(uint16_t link, TransportEvent event) {
+    if (event != TP_EVT_DISCONNECTED || fileStreamActive() == 0) return;
+    fileStreamStop(link);
+    if (fileStreamActive() == 0) streamsEnded();
+}
 
-BLECharacteristicCallbacks *createFileCallbacks() {
-    return new FileCharCallbacks();
+void bleFileInit() {
+    workQueueRegister(WORK_BLE_FILE_REQUEST, handleFileRequest);
+    transportOnReceive(TP_CH_FILE, onFileReceive);
+    transportOnLinkEvent(onLinkEvent);
 }
@@ -1,6 +1,9 @@
 #pragma once
 
-#include <BLECharacteristic.h>
+#include <cstdint>
 
-BLECharacteristicCallbacks *createFileCallbacks();
-void sendRecordedFileOverBle(BLECharacteristic *pChar);
+// Initialization (initBLE): file requests and link events from the transport
+void bleFileInit();
+
+// Stream the last recording to one link (ble_file_stream.h)
+void sendRecordedFileOverBle(uint16_t link);
@@ -0,0 +1,114 @@
+#include "ble_file_stream.h"
+
+#include "ble_transport.h"
+
+constexpr size_t FILE_HEADER_SIZE = 4;
+
+struct FileStream {
+    uint16_t link;       // TRANSPORT_LINK_NONE = idle
+    const uint8_t *data;
+    size_t size;
+    size_t offset;
+    bool headerSent;
+};
+
+static FileStream s_streams[TRANSPORT_MAX_LINKS] = {
+    { TRANSPORT_LINK_NONE, nullptr, 0, 0, false },
+    { TRANSPORT_LINK_NONE, nullptr, 0, 0, false },
+    { TRANSPORT_LINK_NONE, nullptr, 0, 0, false },
+};
+static int s_active = 0;
+static int s_next = 0;
+
+static void stopStream(FileStream &s) {
+    if (s.link == TRANSPORT_LINK_NONE) return;
+    s.link = TRANSPORT_LINK_NONE;
+    s.data = nullptr;
+    s.offset = 0;
+    s_active--;
+}
+
+// Header or next chunk. False if the link refused it.
+static bool sendNext(FileStream &s) {
+    if (!s.headerSent) {
+        const uint32_t total = (uint32_t)s.size;
+        const uint8_t header[FILE_HEADER_SIZE] = {
+            (uint8_t)(total & 0xFF), (uint8_t)((total >> 8) & 0xFF),
+            (uint8_t)((total >> 16) & 0xFF), (uint8_t)((total >> 24) & 0xFF),
+        };
+        if (!transportSend(s.link, TP_CH_FILE, header, sizeof(header))) return false;
+        s.headerSent = true;
+        return true;
+    }
+
+    const size_t payloadMax = transportPayloadMax(s.link);
+    const size_t chunk = payloadMax < FILE_CHUNK_SIZE ? payloadMax : FILE_CHUNK_SIZE;
+    const size_t remaining = s.size - s.offset;
+    const size_t toSend = remaining < chunk ? remaining : chunk;
+    if (!transportSend(s.link, TP_CH_FILE, s.data + s.offset, toSend)) return false;
+    s.offset += toSend;
+    return true;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void fileStreamStart(uint16_t link, const uint8_t *data, size_t size) {
+    const int slot = transportSlot(link);
+    if (slot < 0 || !data || !size) return;
+
+    FileStream &s = s_streams[slot];
+    stopStream(s);
+    s.link = link;
+    s.data = data;
+    s.size = size;
+    s.offset = 0;
+    s.headerSent = false;
+    s_active++;
+
+    // Header right away - a refused one goes again on the first tick
+    sendNext(s);
+}
+
+void fileStreamStop(uint16_t link) {
+    for (FileStream &s : s_streams) {
+        if (s.link == link) stopStream(s);
+    }
+}
+
+void fileStreamStopAll() {
+    for (FileStream &s : s_streams) stopStream(s);
+}
+
+bool fileStreamTick() {
+    for (int k = 0; k < TRANSPORT_MAX_LINKS; k++) {
+        const int i = (s_next + k) % TRANSPORT_MAX_LINKS;
+        FileStream &s = s_streams[i];
+        if (s.link == TRANSPORT_LINK_NONE) continue;
+
+        // A dropped or unsubscribed link has no one to send to
+        if (transportSlot(s.link) < 0 || !transportSubscribed(s.link, TP_CH_FILE)) {
+            stopStream(s);
+            continue;
+        }
+        if (s.headerSent && s.offset >= s.size) {
+            stopStream(s);
+            continue;
+        }
+        if (!transportCredits(s.link)) continue;   // Its turn comes back once the stack drains
+
+        s_next = i + 1;
+        if (!sendNext(s)) {
+            transportNoteRetry(s.link);   // Same message on this link's next turn
+            return false;
+        }
+        if (s.offset >= s.size) stopStream(s);
+        return true;
+    }
+    return false;
+}
+
+int fileStreamActive() {
+    return s_active;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// =============================================================================
+// FILE STREAM - Recording download over the transport
+// =============================================================================
+// Protocol: u32 total length (little-endian), then the bytes in chunks of
+// at most FILE_CHUNK_SIZE, or the link's payload size if smaller. Each
+// tick sends one message to the next streaming link in turn - equal
+// chunks, so every link gets the same share of the bulk rate. A refused
+// message is sent again on that link's next turn; a link without credits
+// is skipped until it drains.
+//
+// Plain C++ over ble_transport.h - timers and power locks stay in
+// ble_file.cpp, so tools/transport_bench runs this same code.
+// =============================================================================
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr size_t FILE_CHUNK_SIZE = 128;
+
+// (Re)start a link's stream from the header. The buffer must stay put
+// until the stream ends.
+void fileStreamStart(uint16_t link, const uint8_t *data, size_t size);
+void fileStreamStop(uint16_t link);
+void fileStreamStopAll();
+
+// One message to the next link in turn. False if nothing went out.
+bool fileStreamTick();
+
+int fileStreamActive();   // Links still streaming
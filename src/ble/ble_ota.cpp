@@ -3,21 +3,32 @@
 #include <Arduino.h>
 #include <Update.h>
 #include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 #include <algorithm>
 #include <cctype>
 #include <cstdio>
 #include <string>
 
+#include "ble_transport.h"
 #include "../hardware_config.h"
 #include "../system/state.h"
 #include "../system/sleep.h"
+#include "../system/events.h"
+#include "../system/timer_service.h"
+#include "../system/work_queue.h"
+#include "../system/trace.h"
+#include "../power/pm_locks.h"
 
 constexpr uint32_t OTA_CHUNK_TIMEOUT_MS     = 10000;
 constexpr uint32_t OTA_RESTART_DELAY_MS     = 800;
+constexpr uint32_t OTA_RESTART_SLACK_MS     = 100;
+constexpr uint32_t OTA_TIMEOUT_SLACK_MS     = 1000;
 constexpr uint32_t OTA_PROGRESS_INTERVAL_MS = 750;
+constexpr uint32_t OTA_WRITE_STALL_MS       = 1000;   // Longest hold of the BTC task per write
 
-static BLECharacteristic *g_otaChar          = nullptr;
+static uint16_t g_otaConn                    = TRANSPORT_LINK_NONE;   // Link that sent BEGIN
 static bool g_otaActive                      = false;
 static uint32_t g_expectedSize               = 0;
 static uint32_t g_receivedSize               = 0;
@@ -25,22 +36,25 @@ static uint32_t g_lastChunkMs                = 0;
 static uint32_t g_lastProgressNotifyMs       = 0;
 static bool g_restartPending                 = false;
 static uint32_t g_restartAtMs                = 0;
-
-void initOtaCharacteristic(BLECharacteristic *c) {
-    g_otaChar = c;
-}
+static volatile bool s_otaDropped            = false;   // Work queue full - a chunk is lost
+static SemaphoreHandle_t s_otaConsumed       = nullptr;  // Loop finished the last write
 
 bool otaInProgress() {
     return g_otaActive;
 }
 
+static void sendStatusTo(uint16_t connId, const char *msg) {
+    if (!msg) return;
+    transportSend(connId, TP_CH_OTA, (const uint8_t *)msg, strlen(msg));
+}
+
+// Status of the session goes to the link running it
 static void sendStatus(const char *msg) {
-    if (!g_otaChar || !msg) return;
-    g_otaChar->setValue((uint8_t*)msg, strlen(msg));
-    g_otaChar->notify();
+    sendStatusTo(g_otaConn, msg);
 }
 
 static void resetOtaState(const char *reason) {
+    if (g_otaActive) TRACE(TR_OTA_FAIL, g_receivedSize, g_expectedSize);
     if (reason) {
         sendStatus(reason);
     }
@@ -52,6 +66,7 @@ static void resetOtaState(const char *reason) {
     g_lastProgressNotifyMs = 0;
     g_restartPending = false;
     g_restartAtMs = 0;
+    pmLockRelease(PM_LOCK_OTA);
 }
 
 static void maybeSendProgress() {
@@ -66,12 +81,17 @@ static void maybeSendProgress() {
 }
 
 static void finalizeOta() {
-    bool ok = Update.end(true);
+    bool ok;
+    {
+        PmLockGuard flashLock(PM_LOCK_FLASH);
+        ok = Update.end(true);
+    }
     if (!ok) {
         resetOtaState("ERR:END");
         return;
     }
     g_otaActive = false;
+    pmLockRelease(PM_LOCK_OTA);
     sendStatus("OTA_OK");
     g_restartPending = true;
     g_restartAtMs = millis() + OTA_RESTART_DELAY_MS;
@@ -93,7 +113,9 @@ static bool startOta(uint32_t size, const std::string &md5) {
     markActivity();
 
     Update.abort();
+    pmLockAcquire(PM_LOCK_OTA);
     if (!Update.begin(size)) {
+        pmLockRelease(PM_LOCK_OTA);
         sendStatus("ERR:BEGIN");
         return false;
     }
@@ -164,36 +186,64 @@ static void handleDataChunk(const std::string &value) {
     }
 }
 
-class OtaCharCallbacks : public BLECharacteristicCallbacks {
-    void onWrite(BLECharacteristic *c) override {
-        std::string value = c->getValue();
-        if (value.empty()) return;
-
-        if (value.rfind("BEGIN:", 0) == 0) {
-            if (g_otaActive) {
-                sendStatus("ERR:BUSY");
-            } else {
-                handleBeginMessage(value);
-            }
-            return;
+// Main loop (work queue) - flash writes and erases stay off the BTC task.
+// One session at a time; other links are told they are busy.
+static void handleOtaWrite(const WorkItem &item) {
+    const std::string value(reinterpret_cast<const char *>(item.data), item.len);
+    const bool owner = item.connId == g_otaConn;
+
+    if (value.rfind("BEGIN:", 0) == 0) {
+        if (g_otaActive) {
+            sendStatusTo(item.connId, "ERR:BUSY");
+        } else {
+            g_otaConn = item.connId;
+            handleBeginMessage(value);
         }
+        return;
+    }
 
-        if (value == "ABORT") {
-            resetOtaState("ERR:ABORT");
+    if (value == "ABORT") {
+        if (g_otaActive && !owner) {
+            sendStatusTo(item.connId, "ERR:BUSY");
             return;
         }
+        resetOtaState("ERR:ABORT");
+        return;
+    }
 
-        if (!g_otaActive) return;
+    if (!g_otaActive || !owner) return;
 
-        handleDataChunk(value);
-    }
-};
+    handleDataChunk(value);
+}
+
+static void handleOtaWriteWork(const WorkItem &item) {
+    handleOtaWrite(item);
+    xSemaphoreGive(s_otaConsumed);
+}
 
-BLECharacteristicCallbacks *createOtaCallbacks() {
-    return new OtaCharCallbacks();
+// BTC task. The protocol has no per-chunk ack, so the host paces itself on
+// the ATT write round trip. The callback holds the task until the loop has
+// written the chunk to flash: the next write waits in the stack, as it did
+// when Update.write() ran here, and the work queue holds at most one OTA
+// chunk. A loop stuck longer than OTA_WRITE_STALL_MS lets this one go
+// unconfirmed - it is still queued, only the pacing slips.
+static void onOtaReceive(uint16_t link, const uint8_t *data, size_t len) {
+    xSemaphoreTake(s_otaConsumed, 0);   // A give left over from a timed-out wait
+    if (!workQueuePost(WORK_BLE_OTA_WRITE, data, len, link)) {
+        // The image would have a hole - fail the transfer in the loop
+        if (link == g_otaConn) {
+            s_otaDropped = true;
+            eventPost(EVT_BLE);
+        }
+        return;
+    }
+    xSemaphoreTake(s_otaConsumed, pdMS_TO_TICKS(OTA_WRITE_STALL_MS));
 }
 
-void otaHandleDisconnected() {
+// Loop task
+static void onLinkEvent(uint16_t link, TransportEvent event) {
+    if (event != TP_EVT_DISCONNECTED || link != g_otaConn) return;   // Someone else's link
+    g_otaConn = TRANSPORT_LINK_NONE;
     if (g_otaActive) {
         resetOtaState(nullptr);
     }
@@ -201,7 +251,31 @@ void otaHandleDisconnected() {
     g_restartAtMs = 0;
 }
 
+void bleOtaInit() {
+    s_otaConsumed = xSemaphoreCreateBinary();
+    workQueueRegister(WORK_BLE_OTA_WRITE, handleOtaWriteWork);
+    transportOnReceive(TP_CH_OTA, onOtaReceive);
+    transportOnLinkEvent(onLinkEvent);
+}
+
+uint32_t otaMsUntilDeadline() {
+    uint32_t now = millis();
+    if (g_restartPending) {
+        return (int32_t)(g_restartAtMs - now) > 0 ? g_restartAtMs - now : 0;
+    }
+    if (g_otaActive && g_lastChunkMs > 0) {
+        uint32_t elapsed = now - g_lastChunkMs;
+        return elapsed >= OTA_CHUNK_TIMEOUT_MS ? 0 : OTA_CHUNK_TIMEOUT_MS - elapsed + 1;
+    }
+    return 0xFFFFFFFFu;
+}
+
 void otaLoop() {
+    if (s_otaDropped) {
+        s_otaDropped = false;
+        if (g_otaActive) resetOtaState("ERR:OVERFLOW");
+    }
+
     uint32_t now = millis();
     if (g_restartPending && now >= g_restartAtMs) {
         ESP.restart();
@@ -210,4 +284,13 @@ void otaLoop() {
     if (g_otaActive && g_lastChunkMs > 0 && (now - g_lastChunkMs) > OTA_CHUNK_TIMEOUT_MS) {
         resetOtaState("ERR:TIMEOUT");
     }
+
+    // Chunks only push the timeout later - an early fire re-arms here
+    uint32_t ms = otaMsUntilDeadline();
+    if (ms == 0xFFFFFFFFu) {
+        timerStop(TIMER_OTA);
+    } else {
+        timerArmEarliest(TIMER_OTA, otaLoop, ms,
+                         g_restartPending ? OTA_RESTART_SLACK_MS : OTA_TIMEOUT_SLACK_MS);
+    }
 }
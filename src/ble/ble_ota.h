@@ -1,9 +1,11 @@
 #pragma once
 
-#include <BLECharacteristic.h>
+#include <cstdint>
 
-void initOtaCharacteristic(BLECharacteristic *c);
-BLECharacteristicCallbacks *createOtaCallbacks();
+// Initialization (initBLE): OTA writes and link events from the transport.
+// A session aborts if the link that ran it drops. Each write holds the BTC
+// task until the loop has flashed it - that is the host's flow control.
+void bleOtaInit();
 void otaLoop();
-void otaHandleDisconnected();
 bool otaInProgress();
+uint32_t otaMsUntilDeadline();  // Next chunk timeout / restart (0xFFFFFFFF if idle)
@@ -0,0 +1,55 @@
+#include "ble_reconnect.h"
+
+#include <esp_gap_ble_api.h>
+#include <esp_timer.h>
+
+#include "../system/trace.h"
+
+static int s_bondCount = 0;
+static uint32_t s_connectMs = 0;
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void bleReconnectBegin() {
+    s_bondCount = esp_ble_get_bond_device_num();
+    Serial.printf("[BLE-SEC] bonded peers in NVS: %d\n", s_bondCount);
+    if (s_bondCount <= 0) return;
+
+    esp_ble_bond_dev_t *bondList = (esp_ble_bond_dev_t *)malloc(
+        s_bondCount * sizeof(esp_ble_bond_dev_t));
+    if (!bondList) return;
+
+    int actual = s_bondCount;
+    esp_ble_get_bond_device_list(&actual, bondList);
+    for (int i = 0; i < actual; i++) {
+        const uint8_t *bda = bondList[i].bd_addr;
+        const bool privateAddr = bondList[i].bond_key.key_mask & ESP_LE_KEY_PID;
+        Serial.printf("[BLE-SEC]   peer[%d]=%02X:%02X:%02X:%02X:%02X:%02X%s\n", i,
+                      bda[0], bda[1], bda[2], bda[3], bda[4], bda[5],
+                      privateAddr ? " (private address)" : "");
+    }
+    free(bondList);
+}
+
+void bleReconnectOnConnected() {
+    if (s_connectMs) return;   // Only the first link of the boot is measured
+
+    s_connectMs = (uint32_t)(esp_timer_get_time() / 1000);
+    Serial.printf("[BLE] reconnect: connected %lums after boot (%d bonds)\n",
+                  (unsigned long)s_connectMs, s_bondCount);
+    TRACE1(TR_BLE_RECONNECT, s_connectMs);
+}
+
+uint32_t bleReconnectConnectMs() {
+    return s_connectMs;
+}
+
+void bleReconnectPrint() {
+    if (!s_connectMs) {
+        Serial.printf("[BLE] reconnect: not connected yet (%d bonds)\n", s_bondCount);
+        return;
+    }
+    Serial.printf("[BLE] reconnect: connected %lums after boot\n", (unsigned long)s_connectMs);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// =============================================================================
+// BLE RECONNECT - Boot/wake to first connect
+// =============================================================================
+// Reconnecting after a wake is left to the advertising backoff profile
+// (ble_adv.h), starting with its fast burst. This module measures how long
+// it takes: the time from boot to this boot's first link, logged and fed to
+// the link telemetry (ble_telemetry.h).
+//
+// There are no directed or accept-list phases. Every phone worth
+// reconnecting to shares its IRK and connects from a resolvable private
+// address. With local privacy off the controller has no resolving list, so
+// directed advertising and the accept list compare the air address with the
+// identity address and turn the peer away; only the host resolves it, once
+// the link is up.
+// =============================================================================
+
+#include <Arduino.h>
+
+// initBLE() (boot task, after BLEDevice::init()): log the bonds in NVS
+void bleReconnectBegin();
+
+// Link up (loop task) - the first of the boot is measured
+void bleReconnectOnConnected();
+
+// Boot to connected for this boot's first link, 0 if not connected yet
+uint32_t bleReconnectConnectMs();
+
+void bleReconnectPrint();
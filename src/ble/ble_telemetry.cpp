@@ -0,0 +1,199 @@
+#include "ble_telemetry.h"
+
+#include <Arduino.h>
+
+#include "ble_core.h"
+#include "ble_conn.h"
+#include "ble_adv.h"
+#include "ble_reconnect.h"
+#include "ble_txpower.h"
+#include "diag_bytes.h"
+#include "../system/timer_service.h"
+#include "../system/work_queue.h"
+
+constexpr uint32_t TELEMETRY_PERIOD_MS = 1000;
+constexpr uint32_t TELEMETRY_SLACK_MS  = 250;
+constexpr uint32_t RATE_MIN_WINDOW_MS  = 500;    // Shortest window a rate is computed over
+
+// Per-slot counter samples. The loop timer shifts in a new one each period;
+// snapshots (also on the BTC task) compute rates from a copy up to now, so a
+// read without a subscriber - or after the last one left - still gets live
+// rates, just averaged over a longer window.
+struct RateSample {
+    uint32_t ms;
+    uint32_t notifyCount;
+    uint32_t notifyBytes;
+};
+
+struct LinkRate {
+    bool sampled;
+    uint16_t connId;
+    RateSample older;
+    RateSample newer;
+};
+
+static LinkRate s_rates[BLE_MAX_CONNS];
+static portMUX_TYPE s_rateMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void sampleRate(int slot, const BleConn &c, uint32_t now) {
+    const RateSample cur = { now, c.notifyCount, c.notifyBytes };
+    portENTER_CRITICAL(&s_rateMux);
+    LinkRate &r = s_rates[slot];
+    if (!r.sampled || r.connId != c.connId) {
+        // New link in this slot - rates start from its connect
+        r.sampled = true;
+        r.connId = c.connId;
+        r.newer = { c.connectedMs, 0, 0 };
+    }
+    r.older = r.newer;
+    r.newer = cur;
+    portEXIT_CRITICAL(&s_rateMux);
+}
+
+static void rateSince(const RateSample &base, const BleConn &c, uint32_t now,
+                      uint16_t &notifiesPerSec, uint32_t &bytesPerSec) {
+    const uint32_t dt = now - base.ms;
+    if (dt < RATE_MIN_WINDOW_MS) {
+        notifiesPerSec = 0;
+        bytesPerSec = 0;
+        return;
+    }
+    const uint32_t perSec = (uint32_t)((uint64_t)(c.notifyCount - base.notifyCount) * 1000 / dt);
+    notifiesPerSec = perSec > 0xFFFF ? 0xFFFF : (uint16_t)perSec;
+    bytesPerSec = (uint32_t)((uint64_t)(c.notifyBytes - base.notifyBytes) * 1000 / dt);
+}
+
+static void linkRate(int slot, const BleConn &c, uint32_t now,
+                     uint16_t &notifiesPerSec, uint32_t &bytesPerSec) {
+    // Link not sampled yet: its connect is the base
+    RateSample base = { c.connectedMs, 0, 0 };
+    portENTER_CRITICAL(&s_rateMux);
+    const LinkRate &r = s_rates[slot];
+    if (r.sampled && r.connId == c.connId) {
+        // Newest sample unless it's too recent to give a stable rate
+        base = (now - r.newer.ms >= RATE_MIN_WINDOW_MS) ? r.newer : r.older;
+    }
+    portEXIT_CRITICAL(&s_rateMux);
+    rateSince(base, c, now, notifiesPerSec, bytesPerSec);
+}
+
+static uint8_t *putLink(uint8_t *p, int slot, const BleConn &c, const BleConn *hub, uint32_t now) {
+    uint16_t notifiesPerSec;
+    uint32_t bytesPerSec;
+    linkRate(slot, c, now, notifiesPerSec, bytesPerSec);
+    const uint8_t flags = (c.congested ? 0x01 : 0) | (&c == hub ? 0x02 : 0) |
+                          (c.activeTransfer ? 0x04 : 0);
+    p = putU16(p, c.connId);
+    for (int i = 0; i < 6; i++) p = putU8(p, c.bda[i]);
+    p = putU16(p, c.interval);
+    p = putU16(p, c.latency);
+    p = putU16(p, c.timeout);
+    p = putU16(p, c.mtu);
+    p = putU8(p, c.txPhy);
+    p = putU8(p, c.rxPhy);
+    p = putU8(p, (uint8_t)c.rssi);
+    p = putU8(p, c.subscribed);
+    p = putU8(p, flags);
+    p = putU32(p, (now - c.connectedMs) / 1000);
+    p = putU16(p, notifiesPerSec);
+    p = putU32(p, bytesPerSec);
+    p = putU32(p, c.notifyCount);
+    p = putU32(p, c.notifyBytes);
+    p = putU32(p, c.notifyErrors);
+    p = putU32(p, c.notifyRetries);
+    p = putU16(p, c.congestEvents);
+    p = putU16(p, c.paramUpdatesOk);
+    p = putU16(p, c.paramUpdatesFailed);
+    return p;
+}
+
+static void telemetryTimer() {
+    const uint32_t now = millis();
+    for (int i = 0; i < BLE_MAX_CONNS; i++) {
+        const BleConn *c = bleConnAt(i);
+        if (c) {
+            sampleRate(i, *c, now);
+        } else {
+            portENTER_CRITICAL(&s_rateMux);
+            s_rates[i].sampled = false;
+            portEXIT_CRITICAL(&s_rateMux);
+        }
+    }
+
+    uint8_t buf[BLE_TELEMETRY_HEADER_SIZE + BLE_MAX_CONNS * BLE_TELEMETRY_LINK_SIZE];
+    for (int i = 0; i < BLE_MAX_CONNS; i++) {
+        BleConn *c = bleConnAt(i);
+        if (!c || !(c->subscribed & (1 << BLE_CH_TELEMETRY))) continue;
+        const size_t len = bleTelemetrySnapshot(buf, c->mtu - ATT_NOTIFY_OVERHEAD);
+        if (len) bleConnNotify(c, BLE_CH_TELEMETRY, buf, len);
+    }
+}
+
+class TelemetryCharCallbacks : public BLECharacteristicCallbacks {
+    void onRead(BLECharacteristic *c) override {
+        CallbackTimer timing(CB_DIAG_ACCESS);
+        uint8_t buf[BLE_TELEMETRY_HEADER_SIZE + BLE_MAX_CONNS * BLE_TELEMETRY_LINK_SIZE];
+        const size_t len = bleTelemetrySnapshot(buf, sizeof(buf));
+        c->setValue(buf, len);
+    }
+};
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+BLECharacteristicCallbacks *createTelemetryCallbacks() {
+    return new TelemetryCharCallbacks();
+}
+
+void bleTelemetryUpdate() {
+    bool listening = false;
+    for (int i = 0; i < BLE_MAX_CONNS; i++) {
+        const BleConn *c = bleConnAt(i);
+        if (c && (c->subscribed & (1 << BLE_CH_TELEMETRY))) listening = true;
+    }
+    if (!listening) {
+        timerStop(TIMER_BLE_TELEMETRY);
+    } else if (!timerIsArmed(TIMER_BLE_TELEMETRY)) {
+        timerStart(TIMER_BLE_TELEMETRY, telemetryTimer, TELEMETRY_PERIOD_MS, TELEMETRY_SLACK_MS,
+                   TELEMETRY_PERIOD_MS);
+    }
+}
+
+size_t bleTelemetrySnapshot(uint8_t *buf, size_t cap) {
+    if (!buf || cap < BLE_TELEMETRY_HEADER_SIZE) return 0;
+
+    const uint32_t now = millis();
+    const BleConn *hub = bleConnHub();
+    const AdvConnectStats adv = bleAdvConnectStats();
+
+    int links = 0;
+    for (int i = 0; i < BLE_MAX_CONNS; i++) {
+        if (bleConnAt(i)) links++;
+    }
+    const int fit = (int)((cap - BLE_TELEMETRY_HEADER_SIZE) / BLE_TELEMETRY_LINK_SIZE);
+    if (links > fit) links = fit;
+    const size_t len = BLE_TELEMETRY_HEADER_SIZE + links * BLE_TELEMETRY_LINK_SIZE;
+
+    uint8_t *p = buf;
+    p = putU8(p, 2);                 // version
+    p = putU8(p, 0);
+    p = putU16(p, (uint16_t)len);
+    p = putU32(p, now);
+    p = putU32(p, bleReconnectConnectMs());
+    p = putU32(p, adv.lastMs);
+    p = putU32(p, adv.avgMs);
+    p = putU16(p, adv.count);
+    p = putU8(p, (uint8_t)bleAdvStep());
+    p = putU8(p, (uint8_t)bleTxPowerDbm());
+    p = putU32(p, bleGetConnectionErrors());
+    p = putU8(p, (uint8_t)links);
+
+    for (int i = 0; i < BLE_MAX_CONNS && links > 0; i++) {
+        const BleConn *c = bleConnAt(i);
+        if (!c) continue;
+        p = putLink(p, i, *c, hub, now);
+        links--;
+    }
+    return (size_t)(p - buf);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// =============================================================================
+// BLE LINK TELEMETRY - Compact link health snapshots
+// =============================================================================
+// One read/notify characteristic on the diagnostics service. A read returns
+// the current snapshot; a subscribed peer gets one every second. The same
+// record is diag record DIAG_REC_BLE_LINK (ble_diag.h).
+//
+// Record v2, little-endian:
+//   u8  version, u8 reserved, u16 length
+//   u32 uptime ms
+//   u32 boot/wake to first connect ms (ble_reconnect.h)
+//   u32 advertising-to-connect last ms, u32 average ms, u16 count (ble_adv.h)
+//   u8  advertising step, i8 connection TX power dBm
+//   u32 connection errors (bleGetConnectionErrors())
+//   u8  link count, then per link (BLE_TELEMETRY_LINK_SIZE bytes):
+//     u16 conn id, 6 peer address
+//     u16 interval (1.25ms), u16 latency, u16 timeout (10ms), u16 MTU
+//     u8  TX PHY, u8 RX PHY, i8 RSSI (127 = not sampled), u8 subscribed
+//     u8  flags: bit0 congested, bit1 hub, bit2 fast params
+//     u32 connected seconds
+//     u16 notifies/s, u32 bytes/s (over the last 1-2s while a peer is
+//         subscribed, else since the last sample or the connect; 0 for
+//         the first 500ms)
+//     u32 notifies, u32 bytes, u32 notify errors, u32 retries
+//     u16 congestion events, u16 param updates ok, u16 param updates failed
+//
+// Only whole link entries are sent: a notify holds as many as fit in the
+// peer's MTU, and a peer still on the default MTU gets nothing.
+// =============================================================================
+
+#include <BLECharacteristic.h>
+
+constexpr size_t BLE_TELEMETRY_HEADER_SIZE = 29;
+constexpr size_t BLE_TELEMETRY_LINK_SIZE   = 53;
+
+BLECharacteristicCallbacks *createTelemetryCallbacks();
+
+// Loop task - a link subscribed / unsubscribed or dropped: the 1s notify
+// timer runs while anybody listens
+void bleTelemetryUpdate();
+
+// Any task (characteristic and diag reads run on the BTC task): rates are
+// computed up to now from the notify timer's samples, which it doesn't change
+size_t bleTelemetrySnapshot(uint8_t *buf, size_t cap);
@@ -2,56 +2,118 @@
 
 #include <Arduino.h>
 #include <string>
+#include <string.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/portmacro.h>
+#include <esp_timer.h>
 
+#include "ble_transport.h"
 #include "../hardware_config.h"
 #include "../system/time_sync.h"
 #include "../system/state.h"
 #include "../ui/ui_answer.h"
 #include "../system/sleep.h"
+#include "../system/events.h"
+#include "../system/timer_service.h"
+#include "../system/work_queue.h"
 
 constexpr uint32_t TEXT_CHUNK_TIMEOUT_MS = 120;
+constexpr uint32_t TEXT_READY_SLACK_MS   = 30;
+
+// Chunks are reassembled per link (transport slot), so two centrals
+// writing at once don't interleave into one message. A time reply always
+// starts a new message: whatever is still buffered is closed off into
+// `done`, so the reply's t4 is its own first chunk, not an earlier one.
+struct PendingText {
+    bool pending;
+    std::string value;
+    uint32_t readyAtMs;
+    int64_t arrivalUs;       // First chunk of value - t4 for TIMEMS replies
+    bool donePending;
+    std::string done;        // Previous message, ready now
+    int64_t doneArrivalUs;
+};
 
 static portMUX_TYPE g_textMux = portMUX_INITIALIZER_UNLOCKED;
-static bool g_textPending = false;
-static std::string g_pendingValue;
-static uint32_t g_pendingReadyAtMs = 0;
+static PendingText g_pending[TRANSPORT_MAX_LINKS];
 
-static bool popPendingText(std::string &out) {
+static bool popPendingText(std::string &out, int64_t &arrivalUs) {
     bool has = false;
     uint32_t now = millis();
     portENTER_CRITICAL(&g_textMux);
-    if (g_textPending && now >= g_pendingReadyAtMs) {
-        out.swap(g_pendingValue);
-        g_textPending = false;
+    for (PendingText &p : g_pending) {
+        if (p.donePending) {
+            out.swap(p.done);
+            p.done.clear();
+            arrivalUs = p.doneArrivalUs;
+            p.donePending = false;
+            has = true;
+            break;
+        }
+        if (!p.pending || (int32_t)(now - p.readyAtMs) < 0) continue;
+        out.swap(p.value);
+        p.value.clear();
+        arrivalUs = p.arrivalUs;
+        p.pending = false;
         has = true;
+        break;
     }
     portEXIT_CRITICAL(&g_textMux);
     return has;
 }
 
-class TextCharCallbacks : public BLECharacteristicCallbacks {
-    void onWrite(BLECharacteristic *c) override {
-        std::string value = c->getValue();
-        if (value.empty()) return;
+// BTC task
+static void onTextReceive(uint16_t link, const uint8_t *data, size_t len) {
+    const int slot = transportSlot(link);
+    if (slot < 0) return;
+    const int64_t arrivalUs = esp_timer_get_time();
+    const bool timeReply = (len >= 5 && memcmp(data, "TIME:", 5) == 0) ||
+                           (len >= 7 && memcmp(data, "TIMEMS:", 7) == 0);
 
-        portENTER_CRITICAL(&g_textMux);
-        g_pendingValue.append(value);
-        g_textPending = true;
-        g_pendingReadyAtMs = millis() + TEXT_CHUNK_TIMEOUT_MS;
-        portEXIT_CRITICAL(&g_textMux);
+    portENTER_CRITICAL(&g_textMux);
+    PendingText &p = g_pending[slot];
+    if (timeReply && !p.value.empty() && !p.donePending) {
+        p.done.swap(p.value);
+        p.value.clear();
+        p.doneArrivalUs = p.arrivalUs;
+        p.donePending = true;
     }
-};
+    if (p.value.empty()) p.arrivalUs = arrivalUs;
+    p.value.append(reinterpret_cast<const char *>(data), len);
+    p.pending = true;
+    p.readyAtMs = millis() + TEXT_CHUNK_TIMEOUT_MS;
+    portEXIT_CRITICAL(&g_textMux);
 
-BLECharacteristicCallbacks *createTextCallbacks() {
-    return new TextCharCallbacks();
+    eventPost(EVT_BLE);
 }
 
-void processPendingText() {
+void bleTextInit() {
+    transportOnReceive(TP_CH_TEXT, onTextReceive);
+}
+
+uint32_t textMsUntilReady() {
+    uint32_t remaining = 0xFFFFFFFFu;
+    uint32_t now = millis();
+    portENTER_CRITICAL(&g_textMux);
+    for (const PendingText &p : g_pending) {
+        if (!p.pending && !p.donePending) continue;
+        int32_t diff = (int32_t)(p.readyAtMs - now);
+        const uint32_t ms = (diff > 0 && !p.donePending) ? (uint32_t)diff : 0;
+        if (ms < remaining) remaining = ms;
+    }
+    portEXIT_CRITICAL(&g_textMux);
+    return remaining;
+}
+
+static void consumePendingText() {
     std::string value;
-    if (!popPendingText(value)) return;
+    int64_t arrivalUs = 0;
+    if (!popPendingText(value, arrivalUs)) return;
 
+    if (value.rfind("TIMEMS:", 0) == 0) {
+        handleTimeMsMessage(value, arrivalUs);
+        return;
+    }
     if (value.rfind("TIME:", 0) == 0) {
         handleTimeMessage(value);
         return;
@@ -64,3 +126,13 @@ void processPendingText() {
     resetAnswerScrollState();
     markActivity();
 }
+
+void processPendingText() {
+    for (int i = 0; i < TRANSPORT_MAX_LINKS; i++) consumePendingText();
+
+    // More chunks may still arrive - look again once the stream goes quiet
+    uint32_t ms = textMsUntilReady();
+    if (ms != 0xFFFFFFFFu) {
+        timerStart(TIMER_TEXT_READY, processPendingText, ms, TEXT_READY_SLACK_MS);
+    }
+}
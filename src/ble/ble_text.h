@@ -1,6 +1,10 @@
 #pragma once
 
-#include <BLECharacteristic.h>
+#include <cstdint>
 
-BLECharacteristicCallbacks *createTextCallbacks();
+// Initialization (initBLE): text writes from the transport
+void bleTextInit();
 void processPendingText();
+
+// Milliseconds until buffered text is complete (0xFFFFFFFF if none pending)
+uint32_t textMsUntilReady();
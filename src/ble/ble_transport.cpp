@@ -0,0 +1,72 @@
+#include "ble_transport.h"
+
+constexpr int TRANSPORT_MAX_LISTENERS = 4;
+
+static const TransportBackend *s_backend = nullptr;
+static TransportRxHandler s_rx[TP_CH_COUNT] = {nullptr};
+static TransportLinkHandler s_listeners[TRANSPORT_MAX_LISTENERS] = {nullptr};
+static int s_listenerCount = 0;
+
+static bool linkValid(uint16_t link) {
+    return s_backend && link != TRANSPORT_LINK_NONE;
+}
+
+// =============================================================================
+// Backend side
+// =============================================================================
+
+void transportSetBackend(const TransportBackend *backend) {
+    s_backend = backend;
+}
+
+void transportDeliver(uint16_t link, TransportChannel ch, const uint8_t *data, size_t len) {
+    if (ch >= TP_CH_COUNT || !s_rx[ch] || !data || !len) return;
+    s_rx[ch](link, data, len);
+}
+
+void transportLinkEvent(uint16_t link, TransportEvent event) {
+    for (int i = 0; i < s_listenerCount; i++) s_listeners[i](link, event);
+}
+
+// =============================================================================
+// Module side
+// =============================================================================
+
+void transportOnReceive(TransportChannel ch, TransportRxHandler handler) {
+    if (ch < TP_CH_COUNT) s_rx[ch] = handler;
+}
+
+void transportOnLinkEvent(TransportLinkHandler handler) {
+    if (!handler || s_listenerCount >= TRANSPORT_MAX_LISTENERS) return;
+    s_listeners[s_listenerCount++] = handler;
+}
+
+bool transportSend(uint16_t link, TransportChannel ch, const uint8_t *data, size_t len) {
+    if (!linkValid(link) || ch >= TP_CH_COUNT || !data || !len) return false;
+    if (len > s_backend->payloadMax(link)) return false;
+    return s_backend->send(link, ch, data, len);
+}
+
+size_t transportPayloadMax(uint16_t link) {
+    return linkValid(link) ? s_backend->payloadMax(link) : 0;
+}
+
+uint16_t transportCredits(uint16_t link) {
+    return linkValid(link) ? s_backend->credits(link) : 0;
+}
+
+bool transportSubscribed(uint16_t link, TransportChannel ch) {
+    return linkValid(link) && ch < TP_CH_COUNT && s_backend->subscribed(link, ch);
+}
+
+void transportNoteRetry(uint16_t link) {
+    if (linkValid(link)) s_backend->retried(link);
+}
+
+int transportSlot(uint16_t link) {
+    return linkValid(link) ? s_backend->slot(link) : -1;
+}
+
+uint16_t transportHub() {
+    return s_backend ? s_backend->hub() : TRANSPORT_LINK_NONE;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// =============================================================================
+// BLE TRANSPORT - What the protocol modules see of the link
+// =============================================================================
+// Audio, text, file, OTA and time sync talk to the phone through this
+// interface instead of the Arduino BLE classes: send on a channel, a
+// receive handler per channel, payload size / credits per link, and link
+// up / down events. A backend supplies the other end:
+//   - Bluedroid (ble_transport_bluedroid.h) on the watch
+//   - loopback (tools/transport_bench) on the host, with latency, loss and
+//     reordering, so the protocol code runs off-device
+//
+// Plain C++ only - no Arduino or ESP-IDF headers - so it compiles on the
+// host as-is.
+//
+// Threads on the watch: receive handlers run on the BTC task (copy, post
+// work, return); link events and sends run on the loop task.
+// =============================================================================
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr uint16_t TRANSPORT_LINK_NONE = 0xFFFF;
+constexpr int      TRANSPORT_MAX_LINKS = 3;       // Same as BLE_MAX_CONNS (ble_conn.h)
+
+enum TransportChannel : uint8_t {
+    TP_CH_AUDIO,   // Out: audio stream + control messages (hub only)
+    TP_CH_TEXT,    // In:  answers, TIME / TIMEMS replies
+    TP_CH_FILE,    // In:  request byte; out: header + chunks
+    TP_CH_OTA,     // In:  BEGIN / chunks / ABORT; out: status
+    TP_CH_COUNT
+};
+
+enum TransportEvent : uint8_t {
+    TP_EVT_CONNECTED,
+    TP_EVT_DISCONNECTED,
+};
+
+typedef void (*TransportRxHandler)(uint16_t link, const uint8_t *data, size_t len);
+typedef void (*TransportLinkHandler)(uint16_t link, TransportEvent event);
+
+// Backend operations. Every one gets a link id from the backend's own
+// space; TRANSPORT_LINK_NONE never reaches them.
+struct TransportBackend {
+    const char *name;
+    // One message to one link, len <= payloadMax. False if the link isn't
+    // subscribed to the channel or the stack refused it (the caller may send
+    // it again later).
+    bool (*send)(uint16_t link, TransportChannel ch, const uint8_t *data, size_t len);
+    // Largest message that goes out whole (ATT MTU - 3 on BLE)
+    size_t (*payloadMax)(uint16_t link);
+    // Messages the link takes right now; 0 = congested, back off
+    uint16_t (*credits)(uint16_t link);
+    bool (*subscribed)(uint16_t link, TransportChannel ch);
+    // A refused message is being sent again (link telemetry)
+    void (*retried)(uint16_t link);
+    // 0..TRANSPORT_MAX_LINKS-1 for per-link tables, -1 if not connected
+    int (*slot)(uint16_t link);
+    // Where audio and control messages go
+    uint16_t (*hub)();
+};
+
+// Backend side
+void transportSetBackend(const TransportBackend *backend);
+void transportDeliver(uint16_t link, TransportChannel ch, const uint8_t *data, size_t len);
+void transportLinkEvent(uint16_t link, TransportEvent event);
+
+// Module side. One receive handler per channel; link listeners are called
+// in registration order.
+void transportOnReceive(TransportChannel ch, TransportRxHandler handler);
+void transportOnLinkEvent(TransportLinkHandler handler);
+
+// Messages longer than transportPayloadMax(link) are refused, never cut -
+// split them, or size them to the link
+bool transportSend(uint16_t link, TransportChannel ch, const uint8_t *data, size_t len);
+size_t transportPayloadMax(uint16_t link);
+uint16_t transportCredits(uint16_t link);
+bool transportSubscribed(uint16_t link, TransportChannel ch);
+void transportNoteRetry(uint16_t link);
+int transportSlot(uint16_t link);
+uint16_t transportHub();                  // TRANSPORT_LINK_NONE if nobody listens
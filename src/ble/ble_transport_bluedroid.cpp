@@ -0,0 +1,88 @@
+#include "ble_transport_bluedroid.h"
+
+#include <string>
+#include <esp_gatt_common_api.h>
+
+#include "ble_conn.h"
+#include "../system/work_queue.h"
+
+static_assert(TRANSPORT_LINK_NONE == BLE_CONN_NONE, "link ids are connection ids");
+static_assert(TRANSPORT_MAX_LINKS == BLE_MAX_CONNS, "one slot per connection");
+
+// Notify channel per transport channel; text is write-only
+static const int NOTIFY_CHANNEL[TP_CH_COUNT] = {
+    BLE_CH_AUDIO, -1, BLE_CH_FILE, BLE_CH_OTA,
+};
+
+static const CallbackId WRITE_CALLBACK[TP_CH_COUNT] = {
+    CB_TEXT_WRITE, CB_TEXT_WRITE, CB_FILE_WRITE, CB_OTA_WRITE,
+};
+
+static bool btSend(uint16_t link, TransportChannel ch, const uint8_t *data, size_t len) {
+    if (NOTIFY_CHANNEL[ch] < 0) return false;
+    return bleConnNotify(bleConnFind(link), (BleChannel)NOTIFY_CHANNEL[ch], data, len);
+}
+
+static size_t btPayloadMax(uint16_t link) {
+    const BleConn *c = bleConnFind(link);
+    return c ? c->mtu - ATT_NOTIFY_OVERHEAD : 0;
+}
+
+static uint16_t btCredits(uint16_t link) {
+    const BleConn *c = bleConnFind(link);
+    if (!c || c->congested) return 0;
+    return esp_ble_get_cur_sendable_packets_num(link);
+}
+
+static bool btSubscribed(uint16_t link, TransportChannel ch) {
+    const BleConn *c = bleConnFind(link);
+    return c && NOTIFY_CHANNEL[ch] >= 0 && (c->subscribed & (1 << NOTIFY_CHANNEL[ch]));
+}
+
+static void btRetried(uint16_t link) {
+    BleConn *c = bleConnFind(link);
+    if (c) c->notifyRetries++;
+}
+
+static uint16_t btHub() {
+    const BleConn *hub = bleConnHub();
+    return hub ? hub->connId : TRANSPORT_LINK_NONE;
+}
+
+static const TransportBackend BLUEDROID_BACKEND = {
+    "bluedroid",
+    btSend,
+    btPayloadMax,
+    btCredits,
+    btSubscribed,
+    btRetried,
+    bleConnSlot,
+    btHub,
+};
+
+// BTC task - the value is copied out before the next write replaces it
+class TransportCharCallbacks : public BLECharacteristicCallbacks {
+public:
+    explicit TransportCharCallbacks(TransportChannel ch) : m_ch(ch) {}
+
+private:
+    void onWrite(BLECharacteristic *c, esp_ble_gatts_cb_param_t *param) override {
+        CallbackTimer timing(WRITE_CALLBACK[m_ch]);
+        std::string value = c->getValue();
+        transportDeliver(param->write.conn_id, m_ch, (const uint8_t *)value.data(), value.size());
+    }
+
+    TransportChannel m_ch;
+};
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void bleTransportInit() {
+    transportSetBackend(&BLUEDROID_BACKEND);
+}
+
+BLECharacteristicCallbacks *bleTransportCallbacks(TransportChannel ch) {
+    return new TransportCharCallbacks(ch);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+// =============================================================================
+// BLE TRANSPORT - Bluedroid backend
+// =============================================================================
+// Links are Bluedroid connection ids (ble_conn.h). Sends are per-link
+// notifications; the text, file and OTA characteristics hand their writes
+// to transportDeliver(). Credits are the controller's free ACL buffers for
+// the link, 0 while GATT reports congestion.
+// =============================================================================
+
+#include <BLECharacteristic.h>
+
+#include "ble_transport.h"
+
+// initBLE(), before the characteristics are created
+void bleTransportInit();
+
+// Write callbacks for a receiving channel's characteristic
+BLECharacteristicCallbacks *bleTransportCallbacks(TransportChannel ch);
@@ -0,0 +1,209 @@
+#include "ble_txpower.h"
+
+#include <esp_bt.h>
+#include <esp_gap_ble_api.h>
+
+#include "ble_core.h"
+#include "ble_conn.h"
+#include "../system/timer_service.h"
+#include "../system/trace.h"
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+
+struct TxLevel {
+    esp_power_level_t level;
+    int8_t dbm;
+};
+
+static const TxLevel LEVELS[] = {
+    { ESP_PWR_LVL_N12, -12 },
+    { ESP_PWR_LVL_N9,   -9 },
+    { ESP_PWR_LVL_N6,   -6 },
+    { ESP_PWR_LVL_N3,   -3 },
+    { ESP_PWR_LVL_N0,    0 },
+    { ESP_PWR_LVL_P3,    3 },   // Ceiling - the old fixed connection level
+};
+constexpr int LEVEL_COUNT = sizeof(LEVELS) / sizeof(LEVELS[0]);
+constexpr int LEVEL_MAX   = LEVEL_COUNT - 1;
+
+constexpr int8_t   RSSI_HIGH_DBM       = -55;    // Above: margin to spare, step down
+constexpr int8_t   RSSI_LOW_DBM        = -75;    // Below: step up now
+constexpr uint8_t  DOWN_SAMPLES        = 3;      // Consecutive high samples per step down
+constexpr int      UP_STEPS            = 2;      // Raise 6dB at once
+constexpr uint32_t HOLD_AFTER_RAISE_MS = 30000;  // No stepping down right after a raise
+constexpr uint32_t SAMPLE_MS           = 2000;
+constexpr uint32_t SAMPLE_SLEEP_MS     = 10000;  // bleIsInSleepMode() - link mostly idle
+
+static int s_level = LEVEL_MAX;
+static bool s_connected = false;
+static int s_sampleSlot = 0;                     // Round-robin over the links
+static float s_rssiAvg = 0.0f;                   // EWMA of the weakest link, alpha 1/4
+static bool s_haveRssi = false;
+static uint8_t s_highCount = 0;
+static uint32_t s_raisedMs = 0;
+static uint32_t s_lastErrors = 0;
+static uint32_t s_raises = 0;
+static uint32_t s_drops = 0;
+
+// Accounting - connected time at each level
+static uint32_t s_levelStartMs = 0;
+static uint32_t s_levelMs[LEVEL_COUNT] = {0};
+
+static void account() {
+    if (!s_connected) return;
+    const uint32_t now = millis();
+    s_levelMs[s_level] += now - s_levelStartMs;
+    s_levelStartMs = now;
+}
+
+static void applyLevel(int level) {
+    account();
+    s_level = level;
+    const esp_power_level_t pwr = LEVELS[level].level;
+    esp_ble_tx_power_set(ESP_BLE_PWR_TYPE_CONN_HDL0, pwr);
+    esp_ble_tx_power_set(ESP_BLE_PWR_TYPE_CONN_HDL1, pwr);
+    esp_ble_tx_power_set(ESP_BLE_PWR_TYPE_CONN_HDL2, pwr);
+}
+
+static void sampleTimer();
+
+static void scheduleSample() {
+    const uint32_t periodMs = bleIsInSleepMode() ? SAMPLE_SLEEP_MS : SAMPLE_MS;
+    timerStart(TIMER_BLE_RSSI, sampleTimer, periodMs, periodMs / 4);
+}
+
+static void sampleTimer() {
+    if (!s_connected) return;
+    for (int k = 0; k < BLE_MAX_CONNS; k++) {
+        BleConn *c = bleConnAt((s_sampleSlot + k) % BLE_MAX_CONNS);
+        if (!c) continue;
+        s_sampleSlot = (s_sampleSlot + k + 1) % BLE_MAX_CONNS;
+        if (esp_ble_gap_read_rssi(c->bda) == ESP_OK) return;   // The result re-arms
+        break;
+    }
+    scheduleSample();
+}
+
+// Weakest link's latest sample, BLE_RSSI_UNKNOWN if none yet
+static int8_t worstRssi() {
+    int8_t worst = BLE_RSSI_UNKNOWN;
+    for (int i = 0; i < BLE_MAX_CONNS; i++) {
+        const BleConn *c = bleConnAt(i);
+        if (c && c->rssi < worst) worst = c->rssi;
+    }
+    return worst;
+}
+
+static void raise(const char *why) {
+    const int level = s_level + UP_STEPS > LEVEL_MAX ? LEVEL_MAX : s_level + UP_STEPS;
+    s_raisedMs = millis();
+    s_highCount = 0;
+    if (level == s_level) return;
+    applyLevel(level);
+    s_raises++;
+    Serial.printf("[BLE] tx power -> %+ddBm (%s, rssi %d)\n", LEVELS[level].dbm, why, (int)s_rssiAvg);
+    TRACE(TR_TX_POWER, level, (uint32_t)-(int)s_rssiAvg);
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void bleTxPowerInit() {
+    applyLevel(LEVEL_MAX);
+}
+
+void bleTxPowerOnConnected() {
+    applyLevel(LEVEL_MAX);   // Start robust, earn the way down
+    if (!s_connected) s_levelStartMs = millis();
+    s_connected = true;
+    s_haveRssi = false;
+    s_highCount = 0;
+    s_raisedMs = millis();
+    s_lastErrors = bleGetConnectionErrors();
+    scheduleSample();
+}
+
+void bleTxPowerOnDisconnected() {
+    if (!s_connected) return;
+    if (bleConnCount() > 0) {
+        s_haveRssi = false;   // The weakest link may be the one that left
+        return;
+    }
+    account();
+    s_connected = false;
+    timerStop(TIMER_BLE_RSSI);
+    applyLevel(LEVEL_MAX);
+    bleTxPowerPrint();
+}
+
+void bleTxPowerOnRssi(const uint8_t *peerBda, bool ok, int8_t sample) {
+    if (!s_connected) return;
+    scheduleSample();
+    BleConn *c = bleConnFindBda(peerBda);
+    if (!ok || !c) return;
+    c->rssi = sample;
+
+    const int8_t rssi = worstRssi();
+    s_rssiAvg = s_haveRssi ? s_rssiAvg + (rssi - s_rssiAvg) / 4.0f : rssi;
+    s_haveRssi = true;
+
+    // Notify failures since the last sample count as packet loss
+    const uint32_t errors = bleGetConnectionErrors();
+    const bool lost = errors > s_lastErrors;
+    s_lastErrors = errors;
+
+    // Up fast: the raw sample, not the average, so a sudden fade is caught
+    if (lost) {
+        raise("loss");
+        return;
+    }
+    if (rssi < RSSI_LOW_DBM || s_rssiAvg < RSSI_LOW_DBM) {
+        raise("low rssi");
+        return;
+    }
+
+    // Down slowly: a run of high samples, and not right after a raise
+    if (s_rssiAvg <= RSSI_HIGH_DBM) {
+        s_highCount = 0;
+        return;
+    }
+    if (++s_highCount < DOWN_SAMPLES || s_level == 0) return;
+    if (millis() - s_raisedMs < HOLD_AFTER_RAISE_MS) return;
+
+    s_highCount = 0;
+    applyLevel(s_level - 1);
+    s_drops++;
+    Serial.printf("[BLE] tx power -> %+ddBm (rssi %d)\n", LEVELS[s_level].dbm, (int)s_rssiAvg);
+    TRACE(TR_TX_POWER, s_level, (uint32_t)-(int)s_rssiAvg);
+}
+
+int8_t bleTxPowerDbm() {
+    return LEVELS[s_level].dbm;
+}
+
+void bleTxPowerPrint() {
+    account();
+    uint32_t totalMs = 0;
+    float dbmMs = 0.0f;
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        totalMs += s_levelMs[i];
+        dbmMs += (float)LEVELS[i].dbm * s_levelMs[i];
+    }
+    if (!totalMs) {
+        Serial.println("[BLE] tx power: no connected time yet");
+        return;
+    }
+    Serial.printf("[BLE] tx power %+ddBm now, mean %+.1fdBm over %lus connected, "
+                  "%lu drops / %lu raises\n",
+                  LEVELS[s_level].dbm, dbmMs / totalMs, (unsigned long)(totalMs / 1000),
+                  (unsigned long)s_drops, (unsigned long)s_raises);
+    for (int i = LEVEL_MAX; i >= 0; i--) {
+        if (!s_levelMs[i]) continue;
+        Serial.printf("[BLE]   %+3ddBm %6lus %3lu%%\n", LEVELS[i].dbm,
+                      (unsigned long)(s_levelMs[i] / 1000),
+                      (unsigned long)((uint64_t)s_levelMs[i] * 100 / totalMs));
+    }
+}
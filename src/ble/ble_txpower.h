@@ -0,0 +1,41 @@
+#pragma once
+
+// =============================================================================
+// BLE TX POWER - RSSI-driven connection TX power
+// =============================================================================
+// The phone is usually a metre away, so a fixed +3 dBm on the link wastes
+// radio current. While connected the controller's RSSI for the link is read
+// periodically (no air time - it is measured on packets we receive anyway)
+// and smoothed:
+//   - high margin for several samples in a row -> one step down (3 dB)
+//   - low RSSI or notify failures              -> two steps up at once
+//   - in between                               -> hold (hysteresis band)
+// The level never goes above the old fixed +3 dBm.
+//
+// Path loss is taken as symmetric: the phone's signal at our antenna stands
+// in for ours at the phone. The level applies to every connection handle,
+// so with several links (ble_conn.h) each is sampled in turn and the
+// weakest one decides.
+//
+// Time spent at each level is logged at disconnect and in
+// powerPrintDiagnostics(), so the saving can be read against the radio
+// current figures.
+// =============================================================================
+
+#include <Arduino.h>
+
+// initBLE() (boot task): connection handles start at the ceiling
+void bleTxPowerInit();
+
+// Link up / down (loop task). A new link starts back at the ceiling; the
+// last one going stops sampling.
+void bleTxPowerOnConnected();
+void bleTxPowerOnDisconnected();
+
+// GAP read RSSI complete (loop task, via the work queue)
+void bleTxPowerOnRssi(const uint8_t *peerBda, bool ok, int8_t rssi);
+
+// Current connection TX power in dBm
+int8_t bleTxPowerDbm();
+
+void bleTxPowerPrint();
@@ -0,0 +1,26 @@
+#pragma once
+
+// =============================================================================
+// DIAG BYTES - Little-endian writers for diag records (ble_diag.h)
+// =============================================================================
+// Each returns the position after the value, so a snapshot is written as
+// p = putU16(p, v); ... and its length is p - buf.
+// =============================================================================
+
+#include <cstdint>
+
+inline uint8_t *putU8(uint8_t *p, uint8_t v) {
+    *p++ = v;
+    return p;
+}
+
+inline uint8_t *putU16(uint8_t *p, uint16_t v) {
+    *p++ = (uint8_t)(v & 0xFF);
+    *p++ = (uint8_t)(v >> 8);
+    return p;
+}
+
+inline uint8_t *putU32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) *p++ = (uint8_t)(v >> (8 * i));
+    return p;
+}
@@ -42,6 +42,15 @@ static bool s_wasTouched = false;
 static uint32_t s_touchDownMs = 0;
 static bool s_pendingTouch = false;
 static bool s_touchProcessed = false;  // Prevents multiple triggers per touch
+static bool s_touchIrqLatched = false; // INT edge seen since last handleTouch()
+
+void touchHandleInterrupt() {
+    s_touchIrqLatched = true;
+}
+
+bool touchIsActive() {
+    return s_wasTouched || s_pendingTouch;
+}
 
 void handleTouch() {
     // -------------------------------------------------------------------------
@@ -49,8 +58,11 @@ void handleTouch() {
     // Touch INT pin (GPIO16) goes LOW when touched - no I2C needed for wake detect
     // -------------------------------------------------------------------------
     if (g_sleeping) {
-        // Check touch interrupt pin directly (LOW = touched)
-        if (digitalRead(TOUCH_INT_PIN) == LOW) {
+        // Check touch interrupt pin directly (LOW = touched), or the latched
+        // ISR edge in case the INT pulse already ended before the loop ran
+        bool irq = s_touchIrqLatched;
+        s_touchIrqLatched = false;
+        if (irq || digitalRead(TOUCH_INT_PIN) == LOW) {
             // Touch detected during sleep - trigger wake!
             powerMarkActivity();  // This sets g_wokeFromSleep = true
             g_ignoreTap = true;   // Consume this wake tap
@@ -58,6 +70,7 @@ void handleTouch() {
         return;  // POWER: Don't poll I2C during sleep - saves ~2-5mA!
     }
 
+    s_touchIrqLatched = false;
     const uint32_t now = millis();
     lgfx::touch_point_t tp;
     bool touched = gfx.getTouch(&tp);
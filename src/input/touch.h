@@ -1,3 +1,9 @@
 #pragma once
 
 void handleTouch();
+
+// Touch INT fired (EVT_TOUCH) - latched so a short INT pulse isn't missed
+void touchHandleInterrupt();
+
+// True while a finger is down - loop must keep polling at frame rate
+bool touchIsActive();
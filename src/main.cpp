@@ -30,13 +30,28 @@
 #include "ble/ble_core.h"
 #include "ble/ble_text.h"
 #include "ble/ble_ota.h"
+#include "ble/ble_cts.h"
 #include "audio/audio_i2s.h"
 #include "power/pmu.h"
 #include "power/battery.h"
+#include "power/current_model.h"
 #include "power/power_manager.h"
+#include "power/pm_locks.h"
+#include "power/sleep_policy.h"
+#include "power/battery_policy.h"
+#include "power/energy_ledger.h"
+#include "power/headless_sync.h"
 #include "input/touch.h"
 #include "system/time_sync.h"
 #include "system/state.h"
+#include "system/events.h"
+#include "system/timer_service.h"
+#include "system/rtc_state.h"
+#include "system/rtc_clock.h"
+#include "system/work_queue.h"
+#include "system/loop_profiler.h"
+#include "system/trace.h"
+#include "system/boot_profiler.h"
 
 // =============================================================================
 // FIRMWARE VERSION
@@ -44,6 +59,55 @@
 #define FIRMWARE_VERSION "1.2.0"
 #define BUILD_DATE __DATE__ " " __TIME__
 
+// =============================================================================
+// LOOP PACING
+// =============================================================================
+// Periodic work (battery, charging, clock, time sync, advertising, waiting
+// timeout/animation, power transitions) lives on the timer service.
+// Frame pacing - only while a finger is down
+// (the active rate comes from the battery tier, ~20fps at NORMAL)
+constexpr uint32_t FRAME_DIMMED_MS = 200;   // ~5fps
+
+// Boot tasks (boot_profiler.h) - gone once setup() returns
+constexpr uint32_t BOOT_BLE_TASK_STACK = 8192;   // Same as the Arduino loop task
+constexpr uint32_t BOOT_MIC_TASK_STACK = 4096;
+constexpr BaseType_t BOOT_BLE_CORE     = 0;      // Bluedroid / controller core
+constexpr BaseType_t BOOT_MIC_CORE     = 1;      // I2S ISR on the loop core, as before
+
+// =============================================================================
+// HEADLESS SETUP - scheduled sync wake (headless_sync.h)
+// =============================================================================
+// PMU, non-UI state and BLE only: no display, touch or mic init, no first
+// frame. Touch INT stays in the FT6336 monitor mode from the last deep
+// sleep, so a touch still arrives as EVT_TOUCH (hand-off to a full boot).
+// =============================================================================
+
+static void setupHeadless() {
+    esp_task_wdt_init(30, true);
+    esp_task_wdt_add(NULL);
+
+    g_powerState = POWER_LIGHT_SLEEP;   // Screen off: current model, ledger, battery policy
+
+    g_pmuPresent = initPMU();
+    pmuDisableDisplay();                // initPMU() enables the backlight rail
+    rtcClockInit();
+    powerArmWakeInterrupts();
+    bootMark(BOOT_PMU);
+
+    initState();
+    timeSyncInit();
+    currentModelInit();
+    initBatterySimulator();
+    timerStop(TIMER_CHARGE_POLL);       // Charger changes redraw the overlay
+    batteryPolicyInit();
+    energyLedgerInit();
+    bootMark(BOOT_STATE);
+
+    initBLE();
+    bleStartMaintenance();
+    bootProfilerReport();
+}
+
 // =============================================================================
 // SETUP
 // =============================================================================
@@ -53,6 +117,7 @@ void setup() {
     // 0. SERIAL - for diagnostics (enable ARDUINO_USB_CDC_ON_BOOT=1 to see)
     // -------------------------------------------------------------------------
     Serial.begin(115200);
+    traceInit();   // Before anything that can go back to sleep or panic
 
     // -------------------------------------------------------------------------
     // 1. POWER MANAGER FIRST
@@ -60,6 +125,9 @@ void setup() {
     // This disables WiFi, sets CPU frequency, and configures power management
     // MUST happen before any other initialization
     powerManagerInit();
+    eventsInit();
+    timerServiceInit();
+    bootMark(BOOT_POWER);
 
     // -------------------------------------------------------------------------
     // 2.5. VALIDATE DEEP SLEEP WAKE - may not return if spurious
@@ -68,12 +136,32 @@ void setup() {
     // this goes back to deep sleep immediately without full init.
     powerValidateWake();
 
+    // Retained state from the deep sleep we woke from (rtc_state.h) - before
+    // any module init that resumes from it
+    rtcStateInit();
+    bootMark(BOOT_WAKE_CHECK);
+
+    // Scheduled sync wake - decided before anything powers the display
+    if (headlessSyncInit()) {
+        setupHeadless();
+        return;
+    }
+
+    // -------------------------------------------------------------------------
+    // 2.6. BLE and mic on boot tasks - in parallel with everything below
+    // -------------------------------------------------------------------------
+    // Advertising is what the user waits for; it needs only the RTC BLE
+    // hint. The I2S install (instant recording later) needs nothing at all.
+    bootRunTask("boot_ble", initBLE, BOOT_BLE_TASK_STACK, BOOT_BLE_CORE);
+    bootRunTask("boot_mic", initMic, BOOT_MIC_TASK_STACK, BOOT_MIC_CORE);
+
     esp_reset_reason_t resetReason = esp_reset_reason();
 
     // Check wake reason and handle deep sleep wake
     esp_sleep_wakeup_cause_t wakeReason = esp_sleep_get_wakeup_cause();
     bool wokeFromDeepSleep = (resetReason == ESP_RST_DEEPSLEEP) ||
                               (wakeReason == ESP_SLEEP_WAKEUP_EXT0 ||
+                               wakeReason == ESP_SLEEP_WAKEUP_ULP ||
                                wakeReason == ESP_SLEEP_WAKEUP_EXT1);
 
     // Log reset/wake reason
@@ -90,6 +178,7 @@ void setup() {
     const char *wakeStr = "NONE";
     switch (wakeReason) {
         case ESP_SLEEP_WAKEUP_EXT0:      wakeStr = "TOUCH(EXT0)"; break;
+        case ESP_SLEEP_WAKEUP_ULP:       wakeStr = "TOUCH(ULP)"; break;
         case ESP_SLEEP_WAKEUP_EXT1:      wakeStr = "BUTTON(EXT1)"; break;
         case ESP_SLEEP_WAKEUP_TIMER:     wakeStr = "TIMER"; break;
         case ESP_SLEEP_WAKEUP_GPIO:      wakeStr = "GPIO"; break;
@@ -109,15 +198,22 @@ void setup() {
     // 4. PMU (controls power rails)
     // -------------------------------------------------------------------------
     g_pmuPresent = initPMU();
+    rtcClockInit();   // Same I2C bus
+    powerArmWakeInterrupts();
+    bootMark(BOOT_PMU);
 
     // -------------------------------------------------------------------------
     // 5. Display
     // -------------------------------------------------------------------------
     uiInitDisplay();
+    bootMark(BOOT_DISPLAY);
 
     // Skip boot animation if waking from deep sleep (faster wake)
     if (!wokeFromDeepSleep) {
+        pmLockAcquire(PM_LOCK_UI_ANIM);  // No light sleep in the frame delays
         playBootAnimation();
+        pmLockRelease(PM_LOCK_UI_ANIM);
+        bootMark(BOOT_ANIMATION);
     }
 
     // -------------------------------------------------------------------------
@@ -125,49 +221,104 @@ void setup() {
     // -------------------------------------------------------------------------
     initState();
     timeSyncInit();
+    currentModelInit();
+    sleepPolicyInit();
     initBatterySimulator();
+    batteryPolicyInit();
+    energyLedgerInit();
 
     g_lastWaitAnimMs = millis();
     g_waitingDots = 0;
+    bootMark(BOOT_STATE);
 
     // -------------------------------------------------------------------------
-    // 7. BLE (after PMU and display are ready)
-    // -------------------------------------------------------------------------
-    initBLE();
-
-    // -------------------------------------------------------------------------
-    // 8. Mic - Initialize I2S driver at boot for instant recording
+    // 7. First frame - doesn't wait for BLE
     // -------------------------------------------------------------------------
-    initMic();  // Install I2S driver once, never uninstall
+    drawIdleScreen();   // Includes the battery overlay
+    lastDrawnState = IDLE;
+    bootMark(BOOT_FIRST_FRAME);
 
     // -------------------------------------------------------------------------
-    // 9. Final setup
+    // 8. Join the boot tasks, then the parts of BLE that need the loop task
     // -------------------------------------------------------------------------
-    delay(50);  // Reduced from 100ms
-    testBatteryDisplay();
-
-    drawIdleScreen();
-    lastDrawnState = IDLE;
+    bootJoinTasks();
+    bleStartMaintenance();
 
     updateChargingState();
-
+    bootProfilerReport();
 }
 
 // =============================================================================
-// MAIN LOOP - OPTIMIZED FOR RESPONSIVENESS + POWER
+// MAIN LOOP - EVENT DRIVEN
 // =============================================================================
 // Key design principles:
 // 1. Fast wake handling - check g_wokeFromSleep FIRST
 // 2. Minimal work during light sleep state
-// 3. Adaptive frame pacing for smooth UI
-// 4. Event-driven touch and BLE (via callbacks/interrupts)
+// 3. Block on the loop event group - touch/PMU ISRs, BLE callbacks and the
+//    timer service post events; frame pacing only while needed
 // =============================================================================
 
+static uint32_t s_pendingEvents = 0;
+
+static void handlePmuEvent() {
+    uint64_t irq = pmuHandleInterrupt();
+    if (irq & XPOWERS_AXP2101_PKEY_SHORT_IRQ) {
+        powerMarkActivity();
+    }
+    if (irq & (XPOWERS_AXP2101_VBUS_INSERT_IRQ | XPOWERS_AXP2101_VBUS_REMOVE_IRQ)) {
+        batteryHandleChargeEvent();
+    }
+}
+
+// How long the loop may block before it has work that no event will announce
+static uint32_t computeLoopWaitMs() {
+    // Finger down: poll for drag/release (INT only announces the touch).
+    // POWER: Hold the UI lock between frames - a light sleep entry/exit
+    // every 50ms costs more than it saves and adds drag latency.
+    const bool fingerDown = !powerIsLightSleep() && touchIsActive();
+    if (fingerDown) {
+        pmLockAcquire(PM_LOCK_UI_ANIM);
+    } else {
+        pmLockRelease(PM_LOCK_UI_ANIM);
+    }
+
+    // Recording: i2s_read() paces the loop, don't block on top of it
+    if (g_recordingInProgress || g_wokeFromSleep) return 0;
+
+    if (fingerDown) {
+        const uint32_t frameMs = batteryPolicy().frameMs;
+        if (powerIsDimmed()) return frameMs > FRAME_DIMMED_MS ? frameMs : FRAME_DIMMED_MS;
+        return frameMs;
+    }
+
+    // Everything else is announced by an event or a timer service wakeup
+    return EVENT_WAIT_FOREVER;
+}
+
 void loop() {
+    // -------------------------------------------------------------------------
+    // Headless sync wake - runs its own loop (and watchdog reset)
+    // -------------------------------------------------------------------------
+    if (headlessSyncActive()) {
+        headlessSyncLoop();   // Ends in deep sleep
+        return;
+    }
+
     // -------------------------------------------------------------------------
     // Watchdog reset
     // -------------------------------------------------------------------------
     esp_task_wdt_reset();
+    loopProfilerBegin();
+
+    // -------------------------------------------------------------------------
+    // Dispatch interrupt events from the last wait
+    // -------------------------------------------------------------------------
+    const uint32_t events = s_pendingEvents;
+    s_pendingEvents = 0;
+    if (events & EVT_TOUCH) touchHandleInterrupt();
+    if (events & EVT_PMU) handlePmuEvent();
+    workQueueRun();   // Deferred BLE callback work
+    loopProfilerMark(LOOP_SEC_EVENTS);
 
     // -------------------------------------------------------------------------
     // WAKE HANDLER - MUST RUN FIRST
@@ -178,30 +329,38 @@ void loop() {
     // 3. Consume the wake tap (don't forward to UI)
     if (g_wokeFromSleep) {
         handleWakeFromLightSleep();
+        loopProfilerMark(LOOP_SEC_WAKE);
+        loopProfilerEnd();
         return;  // Skip rest of loop this iteration
     }
 
+    // -------------------------------------------------------------------------
+    // Timers due now - all share this wakeup
+    // -------------------------------------------------------------------------
+    timerServiceDispatch();
+    loopProfilerMark(LOOP_SEC_TIMERS);
+
     // -------------------------------------------------------------------------
     // Power manager state update
     // -------------------------------------------------------------------------
     powerUpdate();
+    currentModelUpdate();
+    energyLedgerUpdate();
+    loopProfilerMark(LOOP_SEC_POWER);
 
     // -------------------------------------------------------------------------
     // Handle touch input
     // -------------------------------------------------------------------------
     handleTouch();
+    loopProfilerMark(LOOP_SEC_TOUCH);
 
     // -------------------------------------------------------------------------
     // BLE maintenance (event callbacks handle most work)
     // -------------------------------------------------------------------------
     processPendingText();
+    bleCtsProcess();
     otaLoop();
-    ensureAdvertisingAlive();
-
-    // -------------------------------------------------------------------------
-    // Check for waiting state timeout (prevents infinite wait)
-    // -------------------------------------------------------------------------
-    checkWaitingTimeout();
+    loopProfilerMark(LOOP_SEC_BLE);
 
     // -------------------------------------------------------------------------
     // Recording (only when active)
@@ -209,15 +368,13 @@ void loop() {
     if (g_recordingInProgress) {
         updateRecording();
     }
+    loopProfilerMark(LOOP_SEC_RECORDING);
 
     // -------------------------------------------------------------------------
     // UI updates (skip during light sleep to save power)
     // -------------------------------------------------------------------------
     if (!powerIsLightSleep()) {
-        // Charging state check
-        updateChargingState();
-
-        // Time sync
+        // Time sync (re-arms its own timer)
         updateTimeRequest();
 
         // Screen state machine
@@ -230,18 +387,16 @@ void loop() {
                 case WAITING_ANSWER: drawWaitingForAnswerScreen(); break;
                 default: break;
             }
+            if (currentState == WAITING_TIME || currentState == WAITING_ANSWER) {
+                startWaitingAnimation();
+                checkWaitingTimeout();  // Arms the timeout
+            }
             lastDrawnState = currentState;
         }
 
-        // Animations (dots, etc.)
-        updateWaitingForTimeAnimation();
-
-        // Clock update (throttled internally, once per minute)
+        // Clock update (once per minute, re-arms its own timer)
         refreshClockIfNeeded();
 
-        // Battery percentage (throttled internally)
-        updateBatteryPercent();
-
         // Redraw battery overlay only when percentage changes
         static int s_lastDisplayedBatteryPct = -1;
         if (g_batteryPercent != s_lastDisplayedBatteryPct) {
@@ -249,40 +404,19 @@ void loop() {
             drawBatteryOverlay(false);
         }
     }
+    loopProfilerMark(LOOP_SEC_UI);
 
     // -------------------------------------------------------------------------
-    // Frame pacing - Adaptive for smooth UI
+    // Block until the next event
     // -------------------------------------------------------------------------
-    // POWER CRITICAL: Use vTaskDelay() not delay() to allow FreeRTOS tickless idle!
-    // delay() busy-waits and prevents light sleep. vTaskDelay() yields to scheduler.
+    // POWER CRITICAL: Blocking on the event group lets FreeRTOS tickless idle
+    // enter light sleep for the whole wait. Nothing here busy-waits.
     // -------------------------------------------------------------------------
-    static uint32_t s_frameStartMs = 0;
-    uint32_t frameTime = millis() - s_frameStartMs;
-
-    if (g_recordingInProgress) {
-        // Recording: Minimal delay for audio streaming (CPU lock prevents sleep)
-        vTaskDelay(1);
-    }
-    else if (powerIsLightSleep()) {
-        // POWER: Light sleep mode - longer delay for power savings
-        // Touch GPIO check happens at start of handleTouch() - no I2C needed
-        // Using 200ms reduces polling frequency significantly
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-    else if (powerIsDimmed()) {
-        // Dimmed: ~5fps to save power
-        const uint32_t targetFrameMs = 200;
-        if (frameTime < targetFrameMs) {
-            vTaskDelay(pdMS_TO_TICKS(targetFrameMs - frameTime));
-        }
-    }
-    else {
-        // Active: ~20fps for decent UI (saves power vs 30fps)
-        const uint32_t targetFrameMs = 50;
-        if (frameTime < targetFrameMs) {
-            vTaskDelay(pdMS_TO_TICKS(targetFrameMs - frameTime));
-        }
-    }
+    powerRearmWakeInterrupts();
+    eventsMaybeLogStats();
+    pmLocksMaybeLogStats();
+    loopProfilerMark(LOOP_SEC_IDLE_PREP);
+    loopProfilerEnd();
 
-    s_frameStartMs = millis();
+    s_pendingEvents = eventWait(computeLoopWaitMs());
 }
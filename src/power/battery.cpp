@@ -5,8 +5,13 @@
 #include "../hardware_config.h"
 #include "pmu.h"
 #include "power_manager.h"
+#include "current_model.h"
+#include "battery_policy.h"
+#include "energy_ledger.h"
 #include "../ui/ui_common.h"
 #include "../system/state.h"
+#include "../system/timer_service.h"
+#include "../system/rtc_state.h"
 
 // =============================================================================
 // BATTERY MEASUREMENT - LOAD-COMPENSATED
@@ -20,7 +25,9 @@
 //   2. Load removed -> voltage recovers to 3.4V
 //   3. Last logged reading was the recovered voltage
 //
-// Solution: Estimate current draw and compensate voltage reading
+// Solution: Estimate current draw and compensate voltage reading.
+// The current comes from current_model, which is calibrated against the
+// AXP2101 fuel gauge - the same model powerEstimateCurrentMa() reports.
 // =============================================================================
 
 // Battery parameters for T-Watch S3 (400-470mAh LiPo)
@@ -39,12 +46,19 @@ constexpr int VOLTAGE_EMPTY_MV = 3000;     // 0% - cutoff
 constexpr uint32_t BATTERY_UPDATE_MS = 15000;         // Update every 15 seconds (was 5s)
 constexpr uint32_t BATTERY_UPDATE_SLEEP_MS = 60000;   // Update every 60s when sleeping
 constexpr uint32_t CHARGE_POLL_MS = 5000;             // Check charging state every 5s (was 2s)
+constexpr uint32_t CHARGE_POLL_SLEEP_MS = 60000;      // VBUS IRQ covers sleep, poll is a fallback
 constexpr uint32_t CHARGE_REDRAW_MS = 8000;           // Redraw charging animation (was 4s)
+constexpr uint32_t WAKE_STABILIZE_MS = 2000;          // Settle time after light sleep wake
+
+// Timer service slack - lets these jobs share wakeups with each other
+constexpr uint32_t BATTERY_UPDATE_SLACK_MS = 5000;
+constexpr uint32_t BATTERY_UPDATE_SLEEP_SLACK_MS = 20000;
+constexpr uint32_t CHARGE_POLL_SLACK_MS = 2500;
+constexpr uint32_t CHARGE_POLL_SLEEP_SLACK_MS = 30000;
+constexpr uint32_t CHARGE_REDRAW_SLACK_MS = 2000;
 
 // State
 uint32_t g_lastBatteryUpdateMs = 0;
-uint32_t g_lastChargeCheckMs = 0;
-uint32_t g_lastChargeRedrawMs = 0;
 int g_batteryPercent = 100;
 int g_batteryVoltageMv = 4000;  // Last raw voltage reading
 
@@ -61,8 +75,12 @@ static int s_voltageSamples[4] = {0, 0, 0, 0};
 static int s_sampleIndex = 0;
 static bool s_samplesInitialized = false;
 
+// Anti-jump filter output (readCompensatedBatteryPercent)
+static int s_lastReportedPercent = -1;
+
 // Track last drawn percentage for smart redraw (used by drawBatteryOverlay)
 static int s_lastDrawnPercent = -1;
+static char s_drawnRemaining[8] = "";
 
 // Wake stabilization - prevent voltage jumps after sleep wake
 static bool s_justWokeFromSleep = false;
@@ -72,44 +90,6 @@ static uint32_t s_wakeStabilizeUntilMs = 0;
 // Load Compensation
 // =============================================================================
 
-static int estimateLoadCurrentMa() {
-    // Estimate current draw based on device state
-    // These are approximate values - measure with a current meter for accuracy
-    int current = 0;
-
-    // Base ESP32-S3 current (varies with CPU activity)
-    if (powerIsActive()) {
-        current += 35;  // 80MHz, display on
-    } else if (powerIsDimmed()) {
-        current += 30;  // 80MHz, display dimmed
-    } else if (powerIsLightSleep()) {
-        current += 15;  // Between sleep periods
-    } else {
-        current += 25;  // Default
-    }
-
-    // BLE adds current
-    if (g_bleConnected) {
-        current += 10;  // Connected, periodic events
-    } else {
-        current += 3;   // Advertising
-    }
-
-    // Display backlight (major consumer)
-    if (powerIsActive()) {
-        current += 15;  // Full brightness
-    } else if (powerIsDimmed()) {
-        current += 3;   // Dimmed
-    }
-
-    // Recording adds significant current
-    if (g_recordingInProgress) {
-        current += 20;  // Mic + I2S + processing
-    }
-
-    return current;
-}
-
 static int compensateVoltageForLoad(int rawVoltageMv, int loadCurrentMa) {
     // V_opencircuit = V_measured + (I * R_internal)
     // This estimates what the voltage would be with no load
@@ -211,8 +191,8 @@ static int readCompensatedBatteryPercent() {
 
     g_batteryVoltageMv = avgVoltage;
 
-    // Estimate current load and compensate
-    int loadCurrent = estimateLoadCurrentMa();
+    // Compensate with the calibrated load current
+    int loadCurrent = (int)(currentModelEstimateMa() + 0.5f);
     int compensatedVoltage = compensateVoltageForLoad(avgVoltage, loadCurrent);
 
     // Convert to percentage
@@ -228,8 +208,6 @@ static int readCompensatedBatteryPercent() {
 
     // Anti-jump logic: Battery shouldn't increase much unless charging
     // But allow tiny increases (1-2%) for measurement noise / load compensation
-    static int s_lastReportedPercent = -1;
-
     // First reading - just use it
     if (s_lastReportedPercent < 0) {
         s_lastReportedPercent = s_smoothedPercent;
@@ -249,6 +227,48 @@ static int readCompensatedBatteryPercent() {
     return s_lastReportedPercent;
 }
 
+// =============================================================================
+// Timer Service Callbacks
+// =============================================================================
+
+static void batteryUpdateTimer();
+
+static void scheduleBatteryUpdate(uint32_t delayMs) {
+    uint32_t slackMs = powerIsLightSleep() ? BATTERY_UPDATE_SLEEP_SLACK_MS : BATTERY_UPDATE_SLACK_MS;
+    timerStart(TIMER_BATTERY_UPDATE, batteryUpdateTimer, delayMs, slackMs);
+}
+
+static void batteryUpdateTimer() {
+    uint32_t now = millis();
+
+    // Still settling after a wake - come back when the window closes
+    if (s_justWokeFromSleep && now < s_wakeStabilizeUntilMs) {
+        scheduleBatteryUpdate(s_wakeStabilizeUntilMs - now);
+        return;
+    }
+
+    g_lastBatteryUpdateMs = 0;  // Timer is the throttle - always read
+    updateBatteryPercent();
+
+    // POWER: Use longer interval when sleeping to reduce ADC wakeups
+    scheduleBatteryUpdate(powerIsLightSleep() ? BATTERY_UPDATE_SLEEP_MS : BATTERY_UPDATE_MS);
+}
+
+static void chargePollTimer() {
+    updateChargingState();
+
+    bool sleeping = powerIsLightSleep();
+    timerStart(TIMER_CHARGE_POLL, chargePollTimer,
+               sleeping ? CHARGE_POLL_SLEEP_MS : CHARGE_POLL_MS,
+               sleeping ? CHARGE_POLL_SLEEP_SLACK_MS : CHARGE_POLL_SLACK_MS);
+}
+
+static void chargeRedrawTimer() {
+    if (powerIsLightSleep()) return;  // Display is off
+    s_drawnBatteryLevel = -1;
+    drawBatteryOverlay(true);
+}
+
 // =============================================================================
 // Public API
 // =============================================================================
@@ -256,8 +276,6 @@ static int readCompensatedBatteryPercent() {
 void initBatterySimulator() {
     uint32_t now = millis();
     g_lastBatteryUpdateMs = now;
-    g_lastChargeCheckMs = now;
-    g_lastChargeRedrawMs = now;
     s_drawnBatteryLevel = -1;
     s_drawnCharging = false;
     s_smoothedPercent = -1;
@@ -265,9 +283,22 @@ void initBatterySimulator() {
     s_samplesInitialized = false;  // Reset multi-sample averaging
     s_sampleIndex = 0;
 
-    // Read initial battery level
-    g_batteryPercent = readCompensatedBatteryPercent();
+    if (rtcStateResumed()) {
+        // Deep sleep wake: keep the filters - a fresh read under boot load is
+        // what made the percentage jump
+        const RtcBatteryState &saved = rtcState().battery;
+        for (int i = 0; i < 4; i++) s_voltageSamples[i] = saved.voltageSamples[i];
+        s_samplesInitialized = saved.voltageSamples[0] > 0;
+        s_smoothedPercent = saved.smoothedPercent;
+        s_lastReportedPercent = saved.reportedPercent;
+        g_batteryPercent = saved.percent;
+    } else {
+        // Read initial battery level
+        g_batteryPercent = readCompensatedBatteryPercent();
+    }
 
+    scheduleBatteryUpdate(BATTERY_UPDATE_MS);
+    timerStart(TIMER_CHARGE_POLL, chargePollTimer, CHARGE_POLL_MS, CHARGE_POLL_SLACK_MS);
 }
 
 void updateBatteryPercent() {
@@ -290,27 +321,10 @@ void updateBatteryPercent() {
     int newPercent = readCompensatedBatteryPercent();
 
     g_batteryPercent = newPercent;
+    batteryPolicyUpdate(g_batteryPercent, g_isCharging);
 }
 
 void updateChargingState() {
-    uint32_t now = millis();
-
-    if (g_lastChargeCheckMs == 0) {
-        g_lastChargeCheckMs = now - CHARGE_POLL_MS;
-    }
-
-    // Handle charging animation redraw
-    if (g_isCharging && (now - g_lastChargeRedrawMs) > CHARGE_REDRAW_MS) {
-        g_lastChargeRedrawMs = now;
-        s_drawnBatteryLevel = -1;
-        drawBatteryOverlay(true);
-    }
-
-    if (now - g_lastChargeCheckMs < CHARGE_POLL_MS) {
-        return;
-    }
-    g_lastChargeCheckMs = now;
-
     bool wasCharging = g_isCharging;
     g_isCharging = g_pmuPresent ? g_pmu.isVbusIn() : false;
 
@@ -324,20 +338,34 @@ void updateChargingState() {
         // Force immediate battery update
         g_lastBatteryUpdateMs = 0;
         updateBatteryPercent();
+        batteryPolicyUpdate(g_batteryPercent, g_isCharging);
+
+        if (g_isCharging) {
+            timerStart(TIMER_CHARGE_REDRAW, chargeRedrawTimer, CHARGE_REDRAW_MS,
+                       CHARGE_REDRAW_SLACK_MS, CHARGE_REDRAW_MS);
+        } else {
+            timerStop(TIMER_CHARGE_REDRAW);
+        }
+
+        // Unplugged while asleep - leave the display off
+        if (!g_isCharging && powerIsLightSleep()) return;
 
         if (g_isCharging) {
             powerMarkActivity();  // Wake display
             gfx.setBrightness(BRIGHTNESS_CHARGING);
         } else {
-            gfx.setBrightness(BRIGHTNESS_ACTIVE);
+            gfx.setBrightness(batteryPolicyBrightness());
         }
 
         s_drawnBatteryLevel = -1;
         drawBatteryOverlay(true);
-        g_lastChargeRedrawMs = now;
     }
 }
 
+void batteryHandleChargeEvent() {
+    updateChargingState();
+}
+
 // =============================================================================
 // Battery UI
 // =============================================================================
@@ -367,10 +395,20 @@ void drawBatteryOverlay(bool force) {
 
     int level = batteryLevelBucket(pct);
 
+    // Time to empty from the energy ledger - whole hours, minutes in the last hour
+    char remainingStr[8] = "";
+    const float hoursLeft = energyLedgerHoursRemaining();
+    if (hoursLeft >= 1.0f) {
+        snprintf(remainingStr, sizeof(remainingStr), "~%dh", (int)(hoursLeft + 0.5f));
+    } else if (hoursLeft >= 0.0f) {
+        snprintf(remainingStr, sizeof(remainingStr), "~%dm", (int)(hoursLeft * 60.0f));
+    }
+
     // Skip redraw if nothing changed
     if (!force && level == s_drawnBatteryLevel &&
         s_drawnCharging == g_isCharging &&
-        pct == s_lastDrawnPercent) {
+        pct == s_lastDrawnPercent &&
+        strcmp(remainingStr, s_drawnRemaining) == 0) {
         return;
     }
 
@@ -416,9 +454,18 @@ void drawBatteryOverlay(bool force) {
         gfx.fillTriangle(cx + 3, cy + 5, cx - 1, cy + 5, cx + 1, cy - 5, TFT_YELLOW);
     }
 
+    // Time to empty under the icon
+    gfx.fillRect(x - 16, y + h + 3, w + 20, 10, TFT_BLACK);
+    if (remainingStr[0]) {
+        gfx.setTextColor(TFT_DARKGREY, TFT_BLACK);
+        gfx.setTextDatum(textdatum_t::top_right);
+        gfx.drawString(remainingStr, x + w + 3, y + h + 4);
+    }
+
     s_drawnBatteryLevel = level;
     s_drawnCharging = g_isCharging;
     s_lastDrawnPercent = pct;
+    strcpy(s_drawnRemaining, remainingStr);
 }
 
 void testBatteryDisplay() {
@@ -435,6 +482,16 @@ int getBatteryVoltageMv() {
 // Power Management Integration
 // =============================================================================
 
+void batteryPrepareDeepSleep() {
+    RtcBatteryState &saved = rtcState().battery;
+    saved.percent = (int16_t)g_batteryPercent;
+    saved.smoothedPercent = (int16_t)s_smoothedPercent;
+    saved.reportedPercent = (int16_t)s_lastReportedPercent;
+    for (int i = 0; i < 4; i++) {
+        saved.voltageSamples[i] = s_samplesInitialized ? (int16_t)s_voltageSamples[i] : 0;
+    }
+}
+
 void batteryResetAfterWake() {
     // Called when waking from light sleep to prevent voltage jump artifacts
     // The battery voltage can spike/drop when load changes dramatically
@@ -449,8 +506,9 @@ void batteryResetAfterWake() {
 
     // Flag to skip updates for a short stabilization period (2 seconds)
     s_justWokeFromSleep = true;
-    s_wakeStabilizeUntilMs = millis() + 2000;
+    s_wakeStabilizeUntilMs = millis() + WAKE_STABILIZE_MS;
 
     // Force next update to happen after stabilization period
-    g_lastBatteryUpdateMs = millis() - BATTERY_UPDATE_MS + 2000;
+    g_lastBatteryUpdateMs = millis() - BATTERY_UPDATE_MS + WAKE_STABILIZE_MS;
+    scheduleBatteryUpdate(WAKE_STABILIZE_MS);
 }
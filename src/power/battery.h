@@ -9,12 +9,16 @@ extern int g_batteryVoltageMv;    // Raw voltage in mV
 // Initialization
 void initBatterySimulator();
 
-// Periodic updates (call from main loop)
+// Battery / charging refresh - driven by the timer service (timer_service.h)
 void updateBatteryPercent();
 void updateChargingState();
 
+// VBUS insert/remove IRQ - re-check charging state immediately
+void batteryHandleChargeEvent();
+
 // Power management integration
 void batteryResetAfterWake();
+void batteryPrepareDeepSleep();   // Filters into RTC memory (rtc_state.h)
 
 // UI
 void drawBatteryOverlay(bool force = false);
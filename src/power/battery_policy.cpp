@@ -0,0 +1,114 @@
+#include "battery_policy.h"
+
+#include "battery.h"
+#include "power_manager.h"
+#include "../ui/ui_common.h"
+#include "../ble/ble_adv.h"
+#include "../ble/diag_bytes.h"
+#include "../system/state.h"
+#include "../system/time_sync.h"
+
+// =============================================================================
+// TIER TABLE
+// =============================================================================
+// NORMAL matches the firmware's regular settings. Below that, each tier
+// trades responsiveness for runtime: fewer drag frames, a dimmer backlight,
+// slower advertising (reconnects take longer), shorter recordings, rarer
+// time resyncs, an earlier deep sleep and rarer (then no) headless syncs.
+// =============================================================================
+
+static const BatteryTierPolicy TIERS[BATTERY_TIER_COUNT] = {
+    // name       max%  frame  bright adv fast   rec ms  resync ms     deep max ms  sync s
+    { "NORMAL",   100,   50,    70,    1, true,  60000,      60000, 0xFFFFFFFFu, 30 * 60 },
+    { "SAVER",     30,   66,    55,    2, false, 60000,  5 * 60000,      280000, 2 * 3600 },
+    { "LOW",       15,  100,    40,    4, false, 30000, 15 * 60000,      120000,        0 },
+    { "CRITICAL",   5,  200,    25,    8, false, 15000, 60 * 60000,       60000,        0 },
+};
+
+constexpr int TIER_HYSTERESIS_PCT = 3;   // Climb back only this far above the edge
+
+static BatteryTier s_tier = BATTERY_TIER_NORMAL;
+static int s_percent = 100;
+static bool s_charging = false;
+static uint32_t s_tierSinceMs = 0;
+
+static BatteryTier tierForPercent(int percent, bool charging) {
+    if (charging) return BATTERY_TIER_NORMAL;
+
+    int tier = BATTERY_TIER_NORMAL;
+    for (int t = BATTERY_TIER_NORMAL + 1; t < BATTERY_TIER_COUNT; t++) {
+        if (percent <= TIERS[t].maxPercent) tier = t;
+    }
+
+    // Hold a lower tier until the charge is clearly above its edge
+    if (tier < s_tier && percent <= TIERS[s_tier].maxPercent + TIER_HYSTERESIS_PCT) {
+        tier = s_tier;
+    }
+    return (BatteryTier)tier;
+}
+
+static void applyTier() {
+    if (!g_isCharging && g_powerState == POWER_ACTIVE) {
+        gfx.setBrightness(batteryPolicyBrightness());
+    }
+    bleAdvOnEvent(ADV_EVT_POLICY);
+    updateTimeRequest();  // Re-arm the resync timer with the new period
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void batteryPolicyInit() {
+    s_percent = g_batteryPercent;
+    s_charging = g_isCharging;
+    s_tier = tierForPercent(s_percent, s_charging);
+    s_tierSinceMs = millis();
+    Serial.printf("[PWR] battery tier %s (%d%%)\n", TIERS[s_tier].name, s_percent);
+
+    // BLE (bleStartMaintenance()) and time sync read the tier themselves
+    if (!s_charging) gfx.setBrightness(batteryPolicyBrightness());
+}
+
+void batteryPolicyUpdate(int percent, bool charging) {
+    s_percent = percent;
+    s_charging = charging;
+
+    const BatteryTier tier = tierForPercent(percent, charging);
+    if (tier == s_tier) return;
+
+    Serial.printf("[PWR] battery tier %s -> %s (%d%%%s)\n", TIERS[s_tier].name,
+                  TIERS[tier].name, percent, charging ? ", charging" : "");
+    s_tier = tier;
+    s_tierSinceMs = millis();
+    applyTier();
+}
+
+BatteryTier batteryPolicyTier() {
+    return s_tier;
+}
+
+const BatteryTierPolicy &batteryPolicy() {
+    return TIERS[s_tier];
+}
+
+uint8_t batteryPolicyBrightness() {
+    const uint8_t tierLevel = TIERS[s_tier].brightness;
+    return tierLevel < BRIGHTNESS_ACTIVE ? tierLevel : BRIGHTNESS_ACTIVE;
+}
+
+size_t batteryPolicySnapshot(uint8_t *buf, size_t cap) {
+    const size_t len = 4 + 4 + 4;
+    if (!buf || cap < len) return 0;
+
+    uint8_t *p = buf;
+    p = putU8(p, 1);                 // version
+    p = putU8(p, 0);
+    p = putU16(p, (uint16_t)len);
+    p = putU8(p, (uint8_t)s_tier);
+    p = putU8(p, (uint8_t)s_percent);
+    p = putU8(p, s_charging ? 1 : 0);
+    p = putU8(p, 0);
+    p = putU32(p, (millis() - s_tierSinceMs) / 1000);
+    return (size_t)(p - buf);
+}
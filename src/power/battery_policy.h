@@ -0,0 +1,52 @@
+#pragma once
+
+// =============================================================================
+// BATTERY POLICY - Graceful degradation by state of charge
+// =============================================================================
+// Instead of running flat out until checkBatteryHealth() cuts power, each
+// subsystem reads its budget from the active tier. Tiers step down as the
+// state of charge falls and step back up with a few percent of hysteresis
+// (or immediately when the charger is plugged in).
+//
+// The active tier is logged, shown in powerPrintDiagnostics() and published
+// as a BLE diagnostics record (DIAG_REC_BATTERY_TIER).
+// =============================================================================
+
+#include <Arduino.h>
+
+enum BatteryTier : uint8_t {
+    BATTERY_TIER_NORMAL,
+    BATTERY_TIER_SAVER,
+    BATTERY_TIER_LOW,
+    BATTERY_TIER_CRITICAL,
+    BATTERY_TIER_COUNT
+};
+
+struct BatteryTierPolicy {
+    const char *name;
+    uint8_t maxPercent;         // Tier applies at or below this SoC
+    uint32_t frameMs;           // Finger-down frame pacing
+    uint8_t brightness;         // Active backlight (dimmed stays BRIGHTNESS_DIM)
+    uint8_t advIntervalScale;   // Multiplier on the advertising intervals
+    bool fastAdvBurst;          // 50ms discovery burst on boot
+    uint32_t maxRecordingMs;    // Recording length cap
+    uint32_t timeResyncMs;      // Background time resync period
+    uint32_t deepSleepMaxMs;    // Cap on light sleep before deep sleep
+    uint32_t headlessSyncS;     // Deep sleep sync wake period, 0 = off (headless_sync.h)
+};
+
+// Pick the initial tier (call after initBatterySimulator())
+void batteryPolicyInit();
+
+// Re-evaluate after a battery or charger update; applies changes
+void batteryPolicyUpdate(int percent, bool charging);
+
+BatteryTier batteryPolicyTier();
+const BatteryTierPolicy &batteryPolicy();
+
+// Active backlight level for the current tier (charging has its own level)
+uint8_t batteryPolicyBrightness();
+
+// Diagnostics record: u8 version, u8 reserved, u16 length, u8 tier,
+// u8 percent, u8 charging, u8 reserved, u32 seconds in tier
+size_t batteryPolicySnapshot(uint8_t *buf, size_t cap);
@@ -0,0 +1,215 @@
+#include "current_model.h"
+
+#include <Preferences.h>
+
+#include "pmu.h"
+#include "power_manager.h"
+#include "pm_locks.h"
+#include "../system/state.h"
+
+// =============================================================================
+// CURRENT MODEL - FUEL-GAUGE CALIBRATED
+// =============================================================================
+//
+// Measurement: I_avg = (SoC_start - SoC_end) / 100 * capacity_mAh / hours
+// Prediction:  I_pred = sum(fraction_of_window_in_load[i] * I[i])
+//
+// After each window: I[i] += mu * (I_avg - I_pred) * f[i] / sum(f^2)
+// (normalized LMS - loads that dominated the window move the most)
+//
+// The gauge only has 1% resolution (~4.7mAh), so windows are long:
+// at least GAUGE_WINDOW_MIN_DROP_PCT of drop and GAUGE_WINDOW_MIN_MS of time.
+// =============================================================================
+
+constexpr uint32_t GAUGE_POLL_MS             = 60000;          // Gauge I2C read interval
+constexpr uint32_t GAUGE_WINDOW_MIN_MS       = 20 * 60 * 1000; // 20 min minimum window
+constexpr uint32_t GAUGE_WINDOW_MAX_MS       = 6 * 3600 * 1000UL;  // Discard stale windows
+constexpr int      GAUGE_WINDOW_MIN_DROP_PCT = 2;
+constexpr float    CALIBRATION_RATE          = 0.3f;           // NLMS step size (mu)
+
+constexpr const char *MODEL_PREF_NAMESPACE = "curmodel";
+constexpr const char *MODEL_PREF_TABLE_KEY = "ma";
+constexpr const char *MODEL_PREF_COUNT_KEY = "n";
+
+// Defaults - the old battery.cpp / power_manager.cpp tables reconciled.
+// Replaced by calibrated values as soon as the first window closes.
+static const float DEFAULT_LOAD_MA[LOAD_COUNT] = {
+    50.0f,   // LOAD_ACTIVE: 160MHz + backlight at BRIGHTNESS_ACTIVE
+    33.0f,   // LOAD_DIMMED: backlight at BRIGHTNESS_DIM
+    8.0f,    // LOAD_LIGHT_SLEEP: auto light sleep + advertising
+    10.0f,   // LOAD_BLE_LINK: connection events
+    20.0f    // LOAD_RECORDING: mic + I2S + streaming
+};
+
+// Sanity clamps so one bad window can't wreck the table
+static const float MIN_LOAD_MA[LOAD_COUNT] = { 15.0f, 8.0f, 0.5f, 0.5f, 5.0f };
+static const float MAX_LOAD_MA[LOAD_COUNT] = { 150.0f, 100.0f, 40.0f, 40.0f, 80.0f };
+
+static float s_loadMa[LOAD_COUNT];
+static uint32_t s_calibrations = 0;
+static float s_measuredMa = -1.0f;
+
+// Current window
+static bool s_windowOpen = false;
+static int s_windowStartPct = -1;
+static uint32_t s_windowStartMs = 0;
+static uint32_t s_windowLoadMs[LOAD_COUNT] = {0};
+
+// Load snapshot from the previous update - elapsed time is charged to it
+static bool s_prevLoads[LOAD_COUNT] = {false};
+static uint32_t s_prevUpdateMs = 0;
+static uint32_t s_lastGaugePollMs = 0;
+
+// =============================================================================
+// Internal
+// =============================================================================
+
+static void currentLoads(bool loads[LOAD_COUNT]) {
+    for (int i = 0; i < LOAD_COUNT; i++) loads[i] = false;
+
+    switch (g_powerState) {
+        case POWER_ACTIVE:      loads[LOAD_ACTIVE] = true; break;
+        case POWER_DIMMED:      loads[LOAD_DIMMED] = true; break;
+        case POWER_LIGHT_SLEEP: loads[LOAD_LIGHT_SLEEP] = true; break;
+        default: break;
+    }
+    loads[LOAD_BLE_LINK] = g_bleConnected;
+    loads[LOAD_RECORDING] = g_recordingInProgress;
+}
+
+static void saveModel() {
+    PmLockGuard flashLock(PM_LOCK_FLASH);
+    Preferences prefs;
+    if (!prefs.begin(MODEL_PREF_NAMESPACE, false)) return;
+    prefs.putBytes(MODEL_PREF_TABLE_KEY, s_loadMa, sizeof(s_loadMa));
+    prefs.putUInt(MODEL_PREF_COUNT_KEY, s_calibrations);
+    prefs.end();
+}
+
+static void resetWindow(int startPct, uint32_t now) {
+    s_windowOpen = startPct >= 0;
+    s_windowStartPct = startPct;
+    s_windowStartMs = now;
+    for (int i = 0; i < LOAD_COUNT; i++) s_windowLoadMs[i] = 0;
+}
+
+static void calibrate(float measuredMa, uint32_t windowMs) {
+    float fraction[LOAD_COUNT];
+    float predicted = 0.0f;
+    float norm = 0.0f;
+    for (int i = 0; i < LOAD_COUNT; i++) {
+        fraction[i] = (float)s_windowLoadMs[i] / (float)windowMs;
+        predicted += fraction[i] * s_loadMa[i];
+        norm += fraction[i] * fraction[i];
+    }
+    if (norm <= 0.0f) return;
+
+    const float error = measuredMa - predicted;
+    for (int i = 0; i < LOAD_COUNT; i++) {
+        float updated = s_loadMa[i] + CALIBRATION_RATE * error * fraction[i] / norm;
+        if (updated < MIN_LOAD_MA[i]) updated = MIN_LOAD_MA[i];
+        if (updated > MAX_LOAD_MA[i]) updated = MAX_LOAD_MA[i];
+        s_loadMa[i] = updated;
+    }
+
+    s_calibrations++;
+    saveModel();
+}
+
+static void pollGauge(uint32_t now) {
+    // Charging or no gauge: measurement is meaningless, drop the window
+    int pct = (g_pmuPresent && !g_isCharging) ? pmuReadGaugePercent() : -1;
+    if (pct < 0) {
+        resetWindow(-1, now);
+        return;
+    }
+
+    if (!s_windowOpen) {
+        resetWindow(pct, now);
+        return;
+    }
+
+    const uint32_t windowMs = now - s_windowStartMs;
+    const int dropPct = s_windowStartPct - pct;
+
+    // Gauge went up (recalibration jump) or window too old - start over
+    if (dropPct < 0 || windowMs > GAUGE_WINDOW_MAX_MS) {
+        resetWindow(pct, now);
+        return;
+    }
+
+    if (dropPct < GAUGE_WINDOW_MIN_DROP_PCT || windowMs < GAUGE_WINDOW_MIN_MS) {
+        return;
+    }
+
+    const float consumedMah = (dropPct / 100.0f) * pmuBatteryCapacityMah();
+    const float hours = windowMs / 3600000.0f;
+    s_measuredMa = consumedMah / hours;
+    calibrate(s_measuredMa, windowMs);
+    resetWindow(pct, now);
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void currentModelInit() {
+    for (int i = 0; i < LOAD_COUNT; i++) s_loadMa[i] = DEFAULT_LOAD_MA[i];
+
+    Preferences prefs;
+    if (prefs.begin(MODEL_PREF_NAMESPACE, true)) {
+        if (prefs.getBytesLength(MODEL_PREF_TABLE_KEY) == sizeof(s_loadMa)) {
+            prefs.getBytes(MODEL_PREF_TABLE_KEY, s_loadMa, sizeof(s_loadMa));
+            s_calibrations = prefs.getUInt(MODEL_PREF_COUNT_KEY, 0);
+        }
+        prefs.end();
+    }
+
+    const uint32_t now = millis();
+    resetWindow(-1, now);
+    currentLoads(s_prevLoads);
+    s_prevUpdateMs = now;
+    s_lastGaugePollMs = now - GAUGE_POLL_MS;
+}
+
+void currentModelUpdate() {
+    const uint32_t now = millis();
+    const uint32_t elapsed = now - s_prevUpdateMs;
+    s_prevUpdateMs = now;
+
+    if (s_windowOpen) {
+        for (int i = 0; i < LOAD_COUNT; i++) {
+            if (s_prevLoads[i]) s_windowLoadMs[i] += elapsed;
+        }
+    }
+    currentLoads(s_prevLoads);
+
+    if (now - s_lastGaugePollMs >= GAUGE_POLL_MS) {
+        s_lastGaugePollMs = now;
+        pollGauge(now);
+    }
+}
+
+float currentModelEstimateMa() {
+    bool loads[LOAD_COUNT];
+    currentLoads(loads);
+
+    float current = 0.0f;
+    for (int i = 0; i < LOAD_COUNT; i++) {
+        if (loads[i]) current += s_loadMa[i];
+    }
+    return current;
+}
+
+float currentModelLoadMa(CurrentLoad load) {
+    if (load < 0 || load >= LOAD_COUNT) return 0.0f;
+    return s_loadMa[load];
+}
+
+float currentModelMeasuredMa() {
+    return s_measuredMa;
+}
+
+uint32_t currentModelCalibrationCount() {
+    return s_calibrations;
+}
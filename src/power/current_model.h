@@ -0,0 +1,49 @@
+#pragma once
+
+// =============================================================================
+// CURRENT MODEL - Calibrated per-state load current for the T-Watch S3
+// =============================================================================
+// Single source of truth for "how much current are we drawing right now".
+// Used by battery load compensation and powerEstimateCurrentMa().
+//
+// The AXP2101 has no current ADC, so the measured discharge current comes
+// from its fuel gauge: SoC drop x capacity over a long discharge window.
+// Each closed window calibrates the per-load table (NLMS update) and the
+// table is persisted in NVS so calibration survives reboots.
+// =============================================================================
+
+#include <Arduino.h>
+
+// Load components - base states are mutually exclusive, the rest are adders
+enum CurrentLoad {
+    LOAD_ACTIVE,        // CPU awake, display on at full brightness
+    LOAD_DIMMED,        // Display dimmed
+    LOAD_LIGHT_SLEEP,   // Display off, auto light sleep between events
+    LOAD_BLE_LINK,      // Adder: BLE connection held (vs. advertising)
+    LOAD_RECORDING,     // Adder: mic + I2S + ADPCM + audio streaming
+    LOAD_COUNT
+};
+
+// Not observable by the fuel gauge windows - bench figures
+constexpr float CURRENT_DEEP_SLEEP_MA     = 0.15f;   // RTC + PMU quiescent
+constexpr float CURRENT_BLE_BULK_ADDER_MA = 12.0f;   // Fast connection interval (file/OTA)
+
+// Load NVS calibration (call once after initPMU())
+void currentModelInit();
+
+// Accumulate time spent in the current set of loads and close the
+// measurement window when the fuel gauge has moved far enough.
+// Cheap - call once per main loop iteration.
+void currentModelUpdate();
+
+// Estimated current for the device as it is right now (mA)
+float currentModelEstimateMa();
+
+// Calibrated current of a single load component (mA)
+float currentModelLoadMa(CurrentLoad load);
+
+// Last measured average discharge current (mA), or -1 if no window closed yet
+float currentModelMeasuredMa();
+
+// Number of windows that have calibrated the model (persisted)
+uint32_t currentModelCalibrationCount();
@@ -0,0 +1,344 @@
+#include "energy_ledger.h"
+
+#include <Preferences.h>
+#include <string.h>
+#include <esp_system.h>
+
+#include "battery.h"
+#include "current_model.h"
+#include "pmu.h"
+#include "power_manager.h"
+#include "pm_locks.h"
+#include "../ble/diag_bytes.h"
+#include "../system/state.h"
+#include "../system/time_sync.h"
+#include "../system/rtc_state.h"
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+
+constexpr float    PROFILE_TAU_S            = 6 * 3600.0f;   // Usage profile memory
+constexpr float    PROFILE_MIN_S            = 15 * 60.0f;    // Before this, no forecast
+constexpr int      FORECAST_WINDOW_DROP_PCT = 3;             // Gauge steps per error sample
+constexpr uint32_t GAUGE_POLL_MS            = 60000;         // Gauge I2C read interval
+constexpr float    FORECAST_ERROR_ALPHA     = 0.2f;          // Mean abs error smoothing
+constexpr uint32_t LEDGER_SAVE_INTERVAL_MS  = 30 * 60 * 1000;
+constexpr uint32_t MAX_DEEP_SLEEP_S         = 7 * 86400;     // Ignore nonsense durations
+
+constexpr const char *LEDGER_PREF_NAMESPACE = "ledger";
+constexpr const char *LEDGER_PREF_STATE_KEY = "state";
+constexpr uint32_t    LEDGER_STATE_VERSION  = 1;
+
+static const char *const BUCKET_NAMES[LEDGER_COUNT] = {
+    "active", "dimmed", "light", "deep", "link", "bulk", "record"
+};
+
+// Persisted - everything since the last charge, plus the profile
+struct LedgerState {
+    uint32_t version;
+    uint32_t seconds[LEDGER_COUNT];
+    float chargeMas[LEDGER_COUNT];
+    float profileMa;
+    float profileSeconds;         // Observed device time, capped at PROFILE_TAU_S
+    int32_t windowStartPct;       // Forecast error window, -1 = closed
+    float windowChargeMas;        // Modelled charge since the window opened
+    uint32_t forecastSamples;
+    float lastErrorPct;
+    float meanAbsErrorPct;
+    int64_t deepSleepEpoch;       // Deep sleep entry awaiting a time sync, 0 = none
+};
+
+static LedgerState s_state;
+static uint32_t s_carryMs[LEDGER_COUNT] = {0};
+static bool s_prevActive[LEDGER_COUNT] = {false};
+static uint32_t s_prevUpdateMs = 0;
+static uint32_t s_lastSaveMs = 0;
+static bool s_wasCharging = false;
+static int s_gaugePct = -1;             // Last AXP2101 reading, -1 if unusable
+static uint32_t s_lastGaugePollMs = 0;
+
+// =============================================================================
+// Internal
+// =============================================================================
+
+static void activeBuckets(bool active[LEDGER_COUNT]) {
+    for (int i = 0; i < LEDGER_COUNT; i++) active[i] = false;
+
+    switch (g_powerState) {
+        case POWER_ACTIVE:      active[LEDGER_SCREEN_ACTIVE] = true; break;
+        case POWER_DIMMED:      active[LEDGER_SCREEN_DIMMED] = true; break;
+        case POWER_LIGHT_SLEEP: active[LEDGER_LIGHT_SLEEP] = true; break;
+        default: break;
+    }
+    active[LEDGER_BLE_LINK] = g_bleConnected;
+    active[LEDGER_RECORDING] = g_recordingInProgress;
+    // Recording holds the bulk lock too - its adder already covers streaming
+    active[LEDGER_BLE_BULK] = pmLockHeld(PM_LOCK_BLE_FILE) ||
+                              (pmLockHeld(PM_LOCK_BLE_BULK) && !g_recordingInProgress);
+}
+
+static float bucketMa(int bucket) {
+    switch (bucket) {
+        case LEDGER_SCREEN_ACTIVE: return currentModelLoadMa(LOAD_ACTIVE);
+        case LEDGER_SCREEN_DIMMED: return currentModelLoadMa(LOAD_DIMMED);
+        case LEDGER_LIGHT_SLEEP:   return currentModelLoadMa(LOAD_LIGHT_SLEEP);
+        case LEDGER_DEEP_SLEEP:    return CURRENT_DEEP_SLEEP_MA;
+        case LEDGER_BLE_LINK:      return currentModelLoadMa(LOAD_BLE_LINK);
+        case LEDGER_BLE_BULK:      return CURRENT_BLE_BULK_ADDER_MA;
+        case LEDGER_RECORDING:     return currentModelLoadMa(LOAD_RECORDING);
+        default:                   return 0.0f;
+    }
+}
+
+static void resetSinceCharge() {
+    for (int i = 0; i < LEDGER_COUNT; i++) {
+        s_state.seconds[i] = 0;
+        s_state.chargeMas[i] = 0.0f;
+        s_carryMs[i] = 0;
+    }
+    s_state.windowStartPct = -1;
+    s_state.windowChargeMas = 0.0f;
+}
+
+static void saveLedger() {
+    PmLockGuard flashLock(PM_LOCK_FLASH);
+    Preferences prefs;
+    if (!prefs.begin(LEDGER_PREF_NAMESPACE, false)) return;
+    prefs.putBytes(LEDGER_PREF_STATE_KEY, &s_state, sizeof(s_state));
+    prefs.end();
+    s_lastSaveMs = millis();
+}
+
+// Time-weighted average; behaves as a plain mean until PROFILE_TAU_S is seen
+static void foldProfile(float ma, float seconds) {
+    if (seconds <= 0.0f) return;
+    const float alpha = seconds / (s_state.profileSeconds + seconds);
+    s_state.profileMa += alpha * (ma - s_state.profileMa);
+    s_state.profileSeconds += seconds;
+    if (s_state.profileSeconds > PROFILE_TAU_S) s_state.profileSeconds = PROFILE_TAU_S;
+}
+
+static void chargeTime(const bool active[LEDGER_COUNT], uint32_t elapsedMs) {
+    float totalMa = 0.0f;
+    for (int i = 0; i < LEDGER_COUNT; i++) {
+        if (!active[i]) continue;
+        const float ma = bucketMa(i);
+        const uint32_t ms = s_carryMs[i] + elapsedMs;
+        s_state.seconds[i] += ms / 1000;
+        s_carryMs[i] = ms % 1000;
+        s_state.chargeMas[i] += ma * elapsedMs / 1000.0f;
+        totalMa += ma;
+    }
+
+    if (s_state.windowStartPct >= 0) s_state.windowChargeMas += totalMa * elapsedMs / 1000.0f;
+    foldProfile(totalMa, elapsedMs / 1000.0f);
+}
+
+// Compare modelled charge with the gauge once it has moved far enough.
+// g_batteryPercent is load-compensated with the same current model; the
+// AXP2101's SoC percentage is its own voltage-based estimate (it has no
+// current ADC), independent of the model, so only it can judge the forecast.
+static void checkForecastWindow(uint32_t now) {
+    if (now - s_lastGaugePollMs < GAUGE_POLL_MS) return;
+    s_lastGaugePollMs = now;
+
+    // Charging or no gauge: no reference, drop the window
+    const int pct = (g_pmuPresent && !g_isCharging) ? pmuReadGaugePercent() : -1;
+    s_gaugePct = pct;
+    if (pct < 0) {
+        s_state.windowStartPct = -1;
+        s_state.windowChargeMas = 0.0f;
+        return;
+    }
+
+    if (s_state.windowStartPct < 0 || pct > s_state.windowStartPct) {
+        s_state.windowStartPct = pct;
+        s_state.windowChargeMas = 0.0f;
+        return;
+    }
+
+    const int dropPct = s_state.windowStartPct - pct;
+    if (dropPct < FORECAST_WINDOW_DROP_PCT) return;
+
+    const float gaugeMas = dropPct / 100.0f * pmuBatteryCapacityMah() * 3600.0f;
+    if (s_state.windowChargeMas > 0.0f) {
+        // hours_forecast / hours_actual = I_actual / I_model
+        const float errorPct = (gaugeMas / s_state.windowChargeMas - 1.0f) * 100.0f;
+        const float absError = errorPct < 0 ? -errorPct : errorPct;
+        s_state.meanAbsErrorPct = s_state.forecastSamples == 0
+            ? absError
+            : s_state.meanAbsErrorPct + FORECAST_ERROR_ALPHA * (absError - s_state.meanAbsErrorPct);
+        s_state.lastErrorPct = errorPct;
+        s_state.forecastSamples++;
+
+        Serial.printf("[PWR] forecast error %+.1f%% (model %.1fmAh, gauge %.1fmAh)\n",
+                      errorPct, s_state.windowChargeMas / 3600.0f, gaugeMas / 3600.0f);
+    }
+
+    s_state.windowStartPct = pct;
+    s_state.windowChargeMas = 0.0f;
+    saveLedger();
+}
+
+static void addDeepSleep(uint32_t sleptS) {
+    const float ma = bucketMa(LEDGER_DEEP_SLEEP);
+    s_state.seconds[LEDGER_DEEP_SLEEP] += sleptS;
+    s_state.chargeMas[LEDGER_DEEP_SLEEP] += ma * sleptS;
+    if (s_state.windowStartPct >= 0) s_state.windowChargeMas += ma * sleptS;
+    foldProfile(ma, (float)sleptS);
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void energyLedgerInit() {
+    memset(&s_state, 0, sizeof(s_state));
+
+    Preferences prefs;
+    if (prefs.begin(LEDGER_PREF_NAMESPACE, true)) {
+        if (prefs.getBytesLength(LEDGER_PREF_STATE_KEY) == sizeof(s_state)) {
+            prefs.getBytes(LEDGER_PREF_STATE_KEY, &s_state, sizeof(s_state));
+        }
+        prefs.end();
+    }
+
+    if (s_state.version != LEDGER_STATE_VERSION) {
+        memset(&s_state, 0, sizeof(s_state));
+        s_state.version = LEDGER_STATE_VERSION;
+        resetSinceCharge();
+    }
+
+    // Pending deep sleep only carries over a deep sleep wake
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP) s_state.deepSleepEpoch = 0;
+
+    // RTC timer measured the sleep - no need to wait for a time sync
+    if (rtcStateResumed()) {
+        const uint32_t sleptS = rtcStateDeepSleepSeconds();
+        if (sleptS > 0 && sleptS < MAX_DEEP_SLEEP_S) addDeepSleep(sleptS);
+        s_state.deepSleepEpoch = 0;
+    }
+
+    const uint32_t now = millis();
+    activeBuckets(s_prevActive);
+    s_prevUpdateMs = now;
+    s_lastSaveMs = now;
+    s_wasCharging = g_isCharging;
+    s_lastGaugePollMs = now - GAUGE_POLL_MS;
+}
+
+void energyLedgerUpdate() {
+    const uint32_t now = millis();
+    const uint32_t elapsed = now - s_prevUpdateMs;
+    s_prevUpdateMs = now;
+
+    if (g_isCharging) {
+        s_wasCharging = true;
+        s_state.windowStartPct = -1;
+        activeBuckets(s_prevActive);
+        return;
+    }
+    if (s_wasCharging) {
+        // Unplugged - a new "since last charge" period starts now
+        s_wasCharging = false;
+        resetSinceCharge();
+        saveLedger();
+    }
+
+    chargeTime(s_prevActive, elapsed);
+    activeBuckets(s_prevActive);
+    checkForecastWindow(now);
+
+    if (now - s_lastSaveMs >= LEDGER_SAVE_INTERVAL_MS) saveLedger();
+}
+
+float energyLedgerHoursRemaining() {
+    if (g_isCharging || s_gaugePct < 0 ||
+        s_state.profileSeconds < PROFILE_MIN_S || s_state.profileMa <= 0.0f) {
+        return -1.0f;
+    }
+    const float remainingMah = s_gaugePct / 100.0f * pmuBatteryCapacityMah();
+    return remainingMah / s_state.profileMa;
+}
+
+float energyLedgerProfileMa() {
+    return s_state.profileMa;
+}
+
+uint32_t energyLedgerBucketSeconds(LedgerBucket bucket) {
+    if (bucket < 0 || bucket >= LEDGER_COUNT) return 0;
+    return s_state.seconds[bucket];
+}
+
+float energyLedgerBucketMah(LedgerBucket bucket) {
+    if (bucket < 0 || bucket >= LEDGER_COUNT) return 0.0f;
+    return s_state.chargeMas[bucket] / 3600.0f;
+}
+
+void energyLedgerOnDeepSleep() {
+    energyLedgerUpdate();
+    s_state.deepSleepEpoch = g_haveHostTime ? (int64_t)getCurrentEpoch() : 0;
+    saveLedger();
+}
+
+void energyLedgerOnTimeSync() {
+    if (s_state.deepSleepEpoch <= 0) return;
+
+    // Boot happened at the deep sleep wake
+    const int64_t wakeEpoch = (int64_t)getCurrentEpoch() - millis() / 1000;
+    const int64_t sleptS = wakeEpoch - s_state.deepSleepEpoch;
+    s_state.deepSleepEpoch = 0;
+
+    if (sleptS > 0 && sleptS < MAX_DEEP_SLEEP_S) addDeepSleep((uint32_t)sleptS);
+    saveLedger();
+}
+
+void energyLedgerPrint() {
+    const float hours = energyLedgerHoursRemaining();
+    if (hours < 0) {
+        Serial.printf("[PWR] ledger: profile %.2fmA, no forecast\n", s_state.profileMa);
+    } else {
+        Serial.printf("[PWR] ledger: %.1fh left at %.2fmA\n", hours, s_state.profileMa);
+    }
+    Serial.printf("[PWR] forecast error last %+.1f%% mean %.1f%% (n=%lu)\n",
+                  s_state.lastErrorPct, s_state.meanAbsErrorPct,
+                  (unsigned long)s_state.forecastSamples);
+    for (int i = 0; i < LEDGER_COUNT; i++) {
+        Serial.printf("[PWR]   %-6s %7lus %6.1fmAh\n", BUCKET_NAMES[i],
+                      (unsigned long)s_state.seconds[i], s_state.chargeMas[i] / 3600.0f);
+    }
+}
+
+size_t energyLedgerSnapshot(uint8_t *buf, size_t cap) {
+    const size_t len = 4 + 2 + 2 + 1 + 1 + LEDGER_COUNT * 8 + 6;
+    if (!buf || cap < len) return 0;
+
+    const float hours = energyLedgerHoursRemaining();
+    uint32_t minutes = hours < 0 ? 0xFFFF : (uint32_t)(hours * 60.0f);
+    if (minutes > 0xFFFE && hours >= 0) minutes = 0xFFFE;
+    uint32_t profileX100 = (uint32_t)(s_state.profileMa * 100.0f);
+    if (profileX100 > 0xFFFF) profileX100 = 0xFFFF;
+
+    uint8_t *p = buf;
+    p = putU8(p, 1);                 // version
+    p = putU8(p, 0);
+    p = putU16(p, (uint16_t)len);
+    p = putU16(p, (uint16_t)minutes);
+    p = putU16(p, (uint16_t)profileX100);
+    p = putU8(p, (uint8_t)g_batteryPercent);
+    p = putU8(p, LEDGER_COUNT);
+    for (int i = 0; i < LEDGER_COUNT; i++) {
+        p = putU32(p, s_state.seconds[i]);
+        p = putU32(p, (uint32_t)s_state.chargeMas[i]);
+    }
+    p = putU16(p, (uint16_t)(s_state.forecastSamples > 0xFFFF ? 0xFFFF : s_state.forecastSamples));
+    float lastX10 = s_state.lastErrorPct * 10.0f;
+    if (lastX10 > 32767.0f) lastX10 = 32767.0f;
+    if (lastX10 < -32767.0f) lastX10 = -32767.0f;
+    float meanX10 = s_state.meanAbsErrorPct * 10.0f;
+    if (meanX10 > 65535.0f) meanX10 = 65535.0f;
+    p = putU16(p, (uint16_t)(int16_t)lastX10);
+    p = putU16(p, (uint16_t)meanX10);
+    return (size_t)(p - buf);
+}
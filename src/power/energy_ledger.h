@@ -0,0 +1,70 @@
+#pragma once
+
+// =============================================================================
+// ENERGY LEDGER - Where the charge went, and how long the rest will last
+// =============================================================================
+// Integrates time in each power state and activity against the calibrated
+// current model (current_model.h) since the last charge:
+//   - screen on (active / dimmed), light sleep, deep sleep
+//   - BLE link held, BLE bulk transfer (file/OTA), recording
+//
+// A time-weighted usage profile (average mA over the last few hours of
+// device time) turns the remaining charge into hours to empty.
+//
+// Remaining charge and forecast error both come from the AXP2101's SoC
+// percentage (pmuReadGaugePercent, its own voltage-based estimate), not
+// g_batteryPercent - that one is compensated with the same current model,
+// so it can't judge it. Over each window of a few percent of discharge, modelled charge is
+// compared with the gauge drop. The ratio is exactly the error of the hours
+// forecast made at the start of the window (hours = remaining / current).
+// No gauge (no PMU) or charging: no forecast.
+//
+// State is kept in NVS across deep sleep. Deep sleep time is resolved on
+// the first host time sync after the wake.
+// =============================================================================
+
+#include <Arduino.h>
+
+enum LedgerBucket {
+    LEDGER_SCREEN_ACTIVE,
+    LEDGER_SCREEN_DIMMED,
+    LEDGER_LIGHT_SLEEP,
+    LEDGER_DEEP_SLEEP,
+    LEDGER_BLE_LINK,      // Adder: connection held
+    LEDGER_BLE_BULK,      // Adder: file / OTA transfer (not recording)
+    LEDGER_RECORDING,     // Adder: mic + streaming
+    LEDGER_COUNT
+};
+
+// Load persisted state (call after currentModelInit() and initBatterySimulator())
+void energyLedgerInit();
+
+// Charge elapsed time to the previous state. Cheap - once per loop.
+void energyLedgerUpdate();
+
+// Hours until empty at the current usage profile, or -1 while charging
+// or before enough usage has been observed
+float energyLedgerHoursRemaining();
+
+// Usage profile: time-weighted average current (mA)
+float energyLedgerProfileMa();
+
+// Since the last charge
+uint32_t energyLedgerBucketSeconds(LedgerBucket bucket);
+float energyLedgerBucketMah(LedgerBucket bucket);
+
+// Deep sleep entry / host time sync hooks
+void energyLedgerOnDeepSleep();
+void energyLedgerOnTimeSync();
+
+// Human readable dump to Serial (powerPrintDiagnostics())
+void energyLedgerPrint();
+
+// Diagnostics record (DIAG_REC_ENERGY_LEDGER). Layout (version 1):
+//   u8  version, u8 reserved, u16 length
+//   u16 minutes_to_empty        0xFFFF = unknown
+//   u16 profile_ma_x100
+//   u8  percent, u8 bucket_count
+//   per bucket: u32 seconds, u32 charge_mas
+//   u16 forecast_samples, i16 last_error_pct_x10, u16 mean_abs_error_pct_x10
+size_t energyLedgerSnapshot(uint8_t *buf, size_t cap);
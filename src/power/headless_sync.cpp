@@ -0,0 +1,185 @@
+#include "headless_sync.h"
+
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <esp_task_wdt.h>
+#include <esp_private/esp_clk.h>
+
+#include "pmu.h"
+#include "pm_locks.h"
+#include "power_manager.h"
+#include "battery_policy.h"
+#include "current_model.h"
+#include "energy_ledger.h"
+#include "../ble/ble_cts.h"
+#include "../ble/ble_text.h"
+#include "../system/events.h"
+#include "../system/rtc_state.h"
+#include "../system/state.h"
+#include "../system/time_sync.h"
+#include "../system/timer_service.h"
+#include "../system/work_queue.h"
+#include "../system/trace.h"
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+
+constexpr uint32_t HEADLESS_ADVERTISE_MS = 8000;    // No peer by then - give up
+constexpr uint32_t HEADLESS_QUIET_MS     = 3000;    // Link idle this long = done
+constexpr uint32_t HEADLESS_MAX_MS       = 30000;   // Hard cap on the window
+constexpr float    HEADLESS_BUDGET_MAS   = 300.0f;  // ~15mA for 20s
+constexpr uint8_t  HEADLESS_MAX_BACKOFF  = 3;       // Missed syncs: period << 3 at most
+constexpr uint64_t HEADLESS_MIN_SLEEP_US = 1000000; // Past-due deadline after a spurious wake
+constexpr uint64_t HANDOFF_WAKE_US       = 1000;    // Straight into a full boot
+
+enum HeadlessEnd : uint8_t {
+    HEADLESS_END_SYNCED,      // Peer connected and went quiet / disconnected
+    HEADLESS_END_NO_PEER,     // Nobody connected while advertising
+    HEADLESS_END_BUDGET,      // Charge or time budget spent
+    HEADLESS_END_HANDOFF,     // User input - full boot next
+};
+
+static const char *const END_NAMES[] = { "synced", "no peer", "budget", "hand-off" };
+
+static bool s_active = false;
+static uint32_t s_startMs = 0;
+static uint32_t s_lastLinkMs = 0;        // Last BLE event (connect, write, ...)
+static bool s_peerSeen = false;
+static float s_chargeMas = 0.0f;
+static uint32_t s_lastChargeMs = 0;
+
+static void endWindow(HeadlessEnd reason) {
+    const uint32_t elapsedMs = millis() - s_startMs;
+    RtcSyncState &sync = rtcState().sync;
+    if (reason == HEADLESS_END_NO_PEER) {
+        if (sync.missed < 0xFF) sync.missed++;
+    } else if (reason != HEADLESS_END_BUDGET) {
+        sync.missed = 0;
+    }
+    if (reason == HEADLESS_END_HANDOFF) sync.handOff = 1;
+
+    Serial.printf("[SYNC] window ended (%s) after %lums, ~%.0fmAs\n", END_NAMES[reason],
+                  (unsigned long)elapsedMs, s_chargeMas);
+    TRACE(TR_HEADLESS_SYNC, reason, elapsedMs);
+    powerForceDeepSleep();   // Does not return
+}
+
+// Pending work that should still reach the peer before we sleep
+static bool workPending() {
+    return g_waitingForTime ||
+           textMsUntilReady() != 0xFFFFFFFFu ||
+           pmLockHeld(PM_LOCK_BLE_BULK) ||
+           pmLockHeld(PM_LOCK_BLE_FILE);
+}
+
+static void checkWindow(uint32_t now) {
+    const uint32_t elapsedMs = now - s_startMs;
+
+    if (s_chargeMas >= HEADLESS_BUDGET_MAS || elapsedMs >= HEADLESS_MAX_MS) {
+        endWindow(HEADLESS_END_BUDGET);
+    }
+    if (!g_bleConnected) {
+        if (s_peerSeen) endWindow(HEADLESS_END_SYNCED);   // Peer is done with us
+        if (elapsedMs >= HEADLESS_ADVERTISE_MS) endWindow(HEADLESS_END_NO_PEER);
+        return;
+    }
+    s_peerSeen = true;
+    if (!workPending() && now - s_lastLinkMs >= HEADLESS_QUIET_MS) {
+        endWindow(HEADLESS_END_SYNCED);
+    }
+}
+
+// Until the next window decision - everything else posts an event
+static uint32_t msUntilCheck(uint32_t now) {
+    const uint32_t elapsedMs = now - s_startMs;
+    uint32_t deadline = HEADLESS_MAX_MS;
+    if (!g_bleConnected && !s_peerSeen) {
+        deadline = HEADLESS_ADVERTISE_MS;
+    } else if (g_bleConnected && !workPending()) {   // Pending work has its own timers
+        const uint32_t quietAt = s_lastLinkMs - s_startMs + HEADLESS_QUIET_MS;
+        if (quietAt < deadline) deadline = quietAt;
+    }
+    return deadline > elapsedMs ? deadline - elapsedMs : 0;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+bool headlessSyncInit() {
+    RtcSyncState &sync = rtcState().sync;
+    const bool handOff = sync.handOff;
+    sync.handOff = 0;
+
+    s_active = rtcStateResumed() && !handOff &&
+               esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+    if (!s_active) return false;
+
+    sync.syncCount++;
+    s_startMs = millis();
+    s_lastLinkMs = s_startMs;
+    s_lastChargeMs = s_startMs;
+    Serial.printf("[SYNC] headless boot #%lu\n", (unsigned long)sync.syncCount);
+    return true;
+}
+
+bool headlessSyncActive() {
+    return s_active;
+}
+
+void headlessSyncLoop() {
+    esp_task_wdt_reset();
+
+    const uint32_t events = eventWait(msUntilCheck(millis()));
+    const uint32_t now = millis();
+
+    // User input - they want the watch, not a sync
+    if (events & EVT_TOUCH) endWindow(HEADLESS_END_HANDOFF);
+    if (events & EVT_PMU) {
+        if (pmuHandleInterrupt() & XPOWERS_AXP2101_PKEY_SHORT_IRQ) endWindow(HEADLESS_END_HANDOFF);
+    }
+    if (events & EVT_BLE) s_lastLinkMs = now;
+
+    workQueueRun();
+    timerServiceDispatch();
+    processPendingText();   // Answers are kept for the next full boot
+    bleCtsProcess();
+    energyLedgerUpdate();
+
+    s_chargeMas += currentModelEstimateMa() * (now - s_lastChargeMs) / 1000.0f;
+    s_lastChargeMs = now;
+
+    checkWindow(now);
+    powerRearmWakeInterrupts();
+}
+
+void headlessSyncPrepareDeepSleep() {
+    RtcSyncState &sync = rtcState().sync;
+    if (sync.handOff) return;   // headlessSyncArmWakeTimer() wakes right away
+
+    // Nobody to sync with, or the tier doesn't allow it
+    const uint32_t periodS = batteryPolicy().headlessSyncS;
+    if (periodS == 0 || !rtcState().ble.peerValid) {
+        sync.nextSyncRtcUs = 0;
+        return;
+    }
+
+    const uint64_t nowUs = esp_clk_rtc_time();
+    const uint8_t backoff = sync.missed < HEADLESS_MAX_BACKOFF ? sync.missed : HEADLESS_MAX_BACKOFF;
+    sync.nextSyncRtcUs = nowUs + ((uint64_t)periodS << backoff) * 1000000ULL;
+}
+
+void headlessSyncArmWakeTimer() {
+    const RtcSyncState &sync = rtcState().sync;
+    if (sync.handOff) {
+        esp_sleep_enable_timer_wakeup(HANDOFF_WAKE_US);
+        return;
+    }
+    if (sync.nextSyncRtcUs == 0) return;
+
+    const uint64_t nowUs = esp_clk_rtc_time();
+    uint64_t sleepUs = sync.nextSyncRtcUs > nowUs ? sync.nextSyncRtcUs - nowUs : 0;
+    if (sleepUs < HEADLESS_MIN_SLEEP_US) sleepUs = HEADLESS_MIN_SLEEP_US;
+    esp_sleep_enable_timer_wakeup(sleepUs);
+}
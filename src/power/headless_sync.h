@@ -0,0 +1,44 @@
+#pragma once
+
+// =============================================================================
+// HEADLESS SYNC - Scheduled deep sleep wakes without the display
+// =============================================================================
+// Deep sleep used to be "off until touched": the clock drifted and nothing
+// queued could reach the phone. Now deep sleep also arms a timer wake (the
+// period comes from the battery tier). A timer wake boots headless:
+// setup() skips display, touch and mic init and brings up only the PMU,
+// the non-UI state modules and BLE. The bonded peer then gets a short
+// window to connect, sync the time (CTS / TIMEMS) and pull or push
+// whatever is queued, then the watch goes back to deep sleep.
+//
+// The window ends when:
+//   - the link has been quiet for HEADLESS_QUIET_MS with nothing pending,
+//     or the peer disconnects
+//   - no peer connects within HEADLESS_ADVERTISE_MS
+//   - the window's estimated charge or HEADLESS_MAX_MS runs out
+// A touch or button press hands off to a full boot instead (a 1 ms timer
+// wake flagged in the RTC state block).
+//
+// The schedule is an absolute RTC timer deadline in the RTC state block, so
+// spurious wakes in between don't push it back. Syncs that find no peer
+// back off (doubling, up to 8x the tier period).
+// =============================================================================
+
+#include <Arduino.h>
+
+// Decide the boot path - after rtcStateInit(), before any display power-up.
+// True for a scheduled sync wake (not a hand-off).
+bool headlessSyncInit();
+
+bool headlessSyncActive();
+
+// One headless loop iteration (instead of the normal loop body). Goes back
+// to deep sleep - does not return - once the window ends.
+void headlessSyncLoop();
+
+// Before deep sleep (powerForceDeepSleep()): schedule the next sync
+void headlessSyncPrepareDeepSleep();
+
+// While configuring deep sleep wake sources: arm the timer wake if a sync
+// (or hand-off) is scheduled. Also used on the spurious wake paths.
+void headlessSyncArmWakeTimer();
@@ -0,0 +1,132 @@
+#include "pm_locks.h"
+
+#include <esp_pm.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+// =============================================================================
+// PM LOCKS
+// =============================================================================
+// POWER: Any held lock blocks auto light sleep. CPU_FREQ_MAX locks also pin
+// the CPU at CPU_FREQ_MAX; the FLASH lock only needs a stable 80MHz APB.
+// Between locks FreeRTOS still runs tasks at full speed (esp_pm's own
+// per-core lock) and drops to CPU_FREQ_MIN / light sleep when idle.
+// =============================================================================
+
+constexpr uint32_t STATS_LOG_INTERVAL_MS = 5 * 60 * 1000;
+
+struct PmLockDef {
+    const char *name;
+    esp_pm_lock_type_t type;
+};
+
+static const PmLockDef LOCK_DEFS[PM_LOCK_COUNT] = {
+    { "audio",    ESP_PM_CPU_FREQ_MAX },
+    { "ui_anim",  ESP_PM_CPU_FREQ_MAX },
+    { "ble_bulk", ESP_PM_CPU_FREQ_MAX },
+    { "ota",      ESP_PM_CPU_FREQ_MAX },
+    { "flash",    ESP_PM_APB_FREQ_MAX },
+    { "ble_file", ESP_PM_CPU_FREQ_MAX },
+};
+
+static esp_pm_lock_handle_t s_handles[PM_LOCK_COUNT] = {};
+static PmLockStats s_stats[PM_LOCK_COUNT] = {};
+static int64_t s_heldSinceUs[PM_LOCK_COUNT] = {};
+static portMUX_TYPE s_lockMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_lastStatsLogMs = 0;
+
+static bool validId(PmLockId id) {
+    return id >= 0 && id < PM_LOCK_COUNT;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void pmLocksInit() {
+    for (int i = 0; i < PM_LOCK_COUNT; i++) {
+        if (s_handles[i]) continue;
+        esp_pm_lock_create(LOCK_DEFS[i].type, 0, LOCK_DEFS[i].name, &s_handles[i]);
+    }
+    s_lastStatsLogMs = millis();
+}
+
+void pmLockAcquire(PmLockId id) {
+    if (!validId(id)) return;
+
+    portENTER_CRITICAL(&s_lockMux);
+    if (!s_stats[id].held) {
+        s_stats[id].held = true;
+        s_stats[id].acquisitions++;
+        s_heldSinceUs[id] = esp_timer_get_time();
+        // Inside the section so a racing release can't reorder the pair.
+        // Without esp_pm (configure failed) only the stats are kept.
+        if (s_handles[id]) esp_pm_lock_acquire(s_handles[id]);
+    }
+    portEXIT_CRITICAL(&s_lockMux);
+}
+
+void pmLockRelease(PmLockId id) {
+    if (!validId(id)) return;
+
+    portENTER_CRITICAL(&s_lockMux);
+    if (s_stats[id].held) {
+        uint64_t heldUs = esp_timer_get_time() - s_heldSinceUs[id];
+        uint32_t heldMs = (uint32_t)(heldUs / 1000);
+        s_stats[id].held = false;
+        s_stats[id].heldUs += heldUs;
+        if (heldMs > s_stats[id].longestMs) s_stats[id].longestMs = heldMs;
+        if (s_handles[id]) esp_pm_lock_release(s_handles[id]);
+    }
+    portEXIT_CRITICAL(&s_lockMux);
+}
+
+bool pmLockHeld(PmLockId id) {
+    if (!validId(id)) return false;
+    return s_stats[id].held;
+}
+
+const char *pmLockName(PmLockId id) {
+    if (!validId(id)) return "?";
+    return LOCK_DEFS[id].name;
+}
+
+PmLockStats pmLockGetStats(PmLockId id) {
+    PmLockStats out = {};
+    if (!validId(id)) return out;
+
+    portENTER_CRITICAL(&s_lockMux);
+    out = s_stats[id];
+    if (out.held) out.heldUs += esp_timer_get_time() - s_heldSinceUs[id];
+    portEXIT_CRITICAL(&s_lockMux);
+    return out;
+}
+
+PmLockId pmLockTopHolder() {
+    PmLockId top = PM_LOCK_COUNT;
+    uint64_t topUs = 0;
+    for (int i = 0; i < PM_LOCK_COUNT; i++) {
+        uint64_t us = pmLockGetStats((PmLockId)i).heldUs;
+        if (us > topUs) {
+            topUs = us;
+            top = (PmLockId)i;
+        }
+    }
+    return top;
+}
+
+void pmLocksMaybeLogStats() {
+    uint32_t now = millis();
+    if (now - s_lastStatsLogMs < STATS_LOG_INTERVAL_MS) return;
+    s_lastStatsLogMs = now;
+
+    Serial.print("[PM] lock held s:");
+    for (int i = 0; i < PM_LOCK_COUNT; i++) {
+        PmLockStats s = pmLockGetStats((PmLockId)i);
+        Serial.printf(" %s=%lu(%lux,max %lums)", pmLockName((PmLockId)i),
+                      (unsigned long)(s.heldUs / 1000000ULL),
+                      (unsigned long)s.acquisitions, (unsigned long)s.longestMs);
+    }
+    PmLockId top = pmLockTopHolder();
+    Serial.printf(" | top=%s\n", top == PM_LOCK_COUNT ? "none" : pmLockName(top));
+}
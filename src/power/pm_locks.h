@@ -0,0 +1,65 @@
+#pragma once
+
+// =============================================================================
+// PM LOCKS - Named per-subsystem esp_pm locks with hold-time telemetry
+// =============================================================================
+// CPU frequency and auto light sleep are owned by esp_pm. Nobody calls
+// setCpuFrequencyMhz() at runtime - a subsystem that needs the chip awake
+// (or at full speed) takes its own lock for exactly as long as it needs it.
+// Each lock tracks how often and how long it was held, so a battery
+// regression can be traced to the subsystem that kept the chip up.
+// =============================================================================
+
+#include <Arduino.h>
+
+enum PmLockId {
+    PM_LOCK_AUDIO,      // Mic + I2S + ADPCM while recording        (CPU max)
+    PM_LOCK_UI_ANIM,    // Finger down / wake redraw / boot anim    (CPU max)
+    PM_LOCK_BLE_BULK,   // Audio streaming, fast link params        (CPU max)
+    PM_LOCK_OTA,        // Firmware image receive + verify          (CPU max)
+    PM_LOCK_FLASH,      // NVS / flash writes                       (APB max)
+    PM_LOCK_BLE_FILE,   // Recording file streams (ble_file.h)      (CPU max)
+    PM_LOCK_COUNT
+};
+
+struct PmLockStats {
+    uint32_t acquisitions;   // Times the lock was taken
+    uint64_t heldUs;         // Total time held, including a hold in progress
+    uint32_t longestMs;      // Longest single hold
+    bool held;
+};
+
+// Create the locks (called by powerManagerInit() after esp_pm_configure())
+void pmLocksInit();
+
+// Idempotent per lock - acquiring a held lock or releasing a free one is a no-op.
+// Task context only (not ISR).
+void pmLockAcquire(PmLockId id);
+void pmLockRelease(PmLockId id);
+bool pmLockHeld(PmLockId id);
+
+// Scoped hold for short critical sections (flash writes)
+class PmLockGuard {
+public:
+    explicit PmLockGuard(PmLockId id) : m_id(id), m_wasHeld(pmLockHeld(id)) {
+        if (!m_wasHeld) pmLockAcquire(m_id);
+    }
+    ~PmLockGuard() {
+        if (!m_wasHeld) pmLockRelease(m_id);
+    }
+    PmLockGuard(const PmLockGuard &) = delete;
+    PmLockGuard &operator=(const PmLockGuard &) = delete;
+
+private:
+    PmLockId m_id;
+    bool m_wasHeld;
+};
+
+const char *pmLockName(PmLockId id);
+PmLockStats pmLockGetStats(PmLockId id);
+
+// Lock held the longest since boot (PM_LOCK_COUNT if none was ever held)
+PmLockId pmLockTopHolder();
+
+// Print per-lock hold times to Serial at most every few minutes
+void pmLocksMaybeLogStats();
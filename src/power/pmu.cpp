@@ -121,6 +121,17 @@ bool initPMU() {
     return true;
 }
 
+uint16_t pmuBatteryCapacityMah() {
+    return detectBatteryCapacityMah();
+}
+
+int pmuReadGaugePercent() {
+    if (!g_pmuPresent) return -1;
+    int pct = g_pmu.getBatteryPercent();
+    if (pct < 0 || pct > 100) return -1;
+    return pct;
+}
+
 // =============================================================================
 // POWER CONTROL FUNCTIONS
 // =============================================================================
@@ -149,6 +160,15 @@ void pmuDisableHaptics() {
     g_pmu.disableBLDO2();
 }
 
+uint64_t pmuHandleInterrupt() {
+    if (!g_pmuPresent) return 0;
+    // PMU_INT stays LOW until the status is cleared - always clear here,
+    // otherwise light sleep GPIO wake would retrigger immediately
+    uint64_t status = g_pmu.getIrqStatus();
+    g_pmu.clearIrqStatus();
+    return status;
+}
+
 void pmuPrepareDeepSleep() {
     if (!g_pmuPresent) return;
 
@@ -7,6 +7,12 @@ extern bool g_pmuPresent;
 
 bool initPMU();
 
+// Battery capacity of this board variant (mAh)
+uint16_t pmuBatteryCapacityMah();
+
+// AXP2101 fuel gauge state of charge (0-100), -1 if unavailable
+int pmuReadGaugePercent();
+
 // =============================================================================
 // POWER MANAGEMENT FUNCTIONS
 // Call these to enable/disable peripheral power rails for maximum savings
@@ -20,6 +26,10 @@ void pmuDisableDisplay();
 void pmuEnableHaptics();
 void pmuDisableHaptics();
 
+// Read and clear pending AXP2101 IRQs (call from the loop on EVT_PMU).
+// Returns the IRQ status bits that were pending.
+uint64_t pmuHandleInterrupt();
+
 // Prepare PMU for deep sleep (disable all non-essential rails)
 void pmuPrepareDeepSleep();
 
@@ -3,7 +3,7 @@
 // =============================================================================
 // Key optimizations:
 // 1. Fast wake path (<100ms from touch to screen)
-// 2. Proper CPU lock during recording/BLE transfers
+// 2. Named PM locks during recording/BLE transfers/OTA (pm_locks.h)
 // 3. Smooth state transitions with no display glitches
 // 4. ESP-IDF automatic power management enabled
 // =============================================================================
@@ -11,12 +11,32 @@
 #include "power_manager.h"
 #include "pmu.h"
 #include "battery.h"
+#include "current_model.h"
+#include "pm_locks.h"
+#include "power_profiler.h"
+#include "sleep_policy.h"
+#include "battery_policy.h"
+#include "energy_ledger.h"
+#include "ulp_touch.h"
+#include "headless_sync.h"
 #include "../hardware_config.h"
 #include "../ui/ui_common.h"
 #include "../ui/ui_idle.h"
 #include "../system/state.h"
 #include "../audio/audio_i2s.h"
 #include "../ble/ble_core.h"  // POWER: For BLE sleep mode control
+#include "../ble/ble_reconnect.h"
+#include "../ble/ble_adv.h"
+#include "../ble/ble_txpower.h"
+#include "../ble/ble_conn.h"
+#include "../system/events.h"
+#include "../system/timer_service.h"
+#include "../system/rtc_state.h"
+#include "../system/time_sync.h"
+#include "../system/clock_drift.h"
+#include "../system/work_queue.h"
+#include "../system/loop_profiler.h"
+#include "../system/trace.h"
 
 #include <esp_pm.h>
 #include <esp_sleep.h>
@@ -38,47 +58,35 @@
 PowerState g_powerState = POWER_ACTIVE;
 volatile bool g_wokeFromSleep = false;
 static uint32_t s_lastActivityMs = 0;
+static uint32_t s_wakeGapMs = 0;         // Idle gap that ended the last light sleep
 static uint32_t s_lightSleepEnteredMs = 0;
 static bool s_pmConfigured = false;
 static bool s_bleConnected = false;
 
-// Light sleep lock - prevent sleep during critical operations
-static esp_pm_lock_handle_t s_cpuLock = nullptr;
-static bool s_cpuLockHeld = false;
+// Timer service slack - how late each transition may run
+constexpr uint32_t BATTERY_HEALTH_PERIOD_MS = 10000;
+constexpr uint32_t BATTERY_HEALTH_SLACK_MS  = 5000;
+constexpr uint32_t DIM_SLACK_MS             = 500;
+constexpr uint32_t LIGHT_SLEEP_SLACK_MS     = 1000;
+constexpr uint32_t DEEP_SLEEP_SLACK_MS      = 10000;
 
-// =============================================================================
-// Internal: CPU Lock Management
-// =============================================================================
-
-static void acquireCpuLock() {
-    if (s_cpuLock && !s_cpuLockHeld) {
-        esp_pm_lock_acquire(s_cpuLock);
-        s_cpuLockHeld = true;
-    }
-}
-
-static void releaseCpuLock() {
-    if (s_cpuLock && s_cpuLockHeld) {
-        esp_pm_lock_release(s_cpuLock);
-        s_cpuLockHeld = false;
-    }
-}
+// Wake line interrupt state - cleared by the ISR, set again by rearm
+static volatile bool s_touchIrqArmed = false;
+static volatile bool s_pmuIrqArmed = false;
 
 // =============================================================================
 // Internal: Display Power Control
 // =============================================================================
 
+// POWER: No setCpuFrequencyMhz() here - esp_pm owns the clock. Drawing runs
+// at CPU_FREQ_MAX under the RTOS lock and the CPU idles at CPU_FREQ_MIN.
 static void displaySetActive() {
-    // POWER: Restore full CPU frequency for responsive UI
-    setCpuFrequencyMhz(CPU_FREQ_MAX);
     pmuEnableDisplay();
     gfx.wakeup();
-    gfx.setBrightness(g_isCharging ? BRIGHTNESS_CHARGING : BRIGHTNESS_ACTIVE);
+    gfx.setBrightness(g_isCharging ? BRIGHTNESS_CHARGING : batteryPolicyBrightness());
 }
 
 static void displaySetDimmed() {
-    // POWER: Reduce CPU frequency when dimmed (80MHz is enough for basic UI)
-    setCpuFrequencyMhz(80);
     pmuEnableDisplay();
     gfx.wakeup();
     gfx.setBrightness(BRIGHTNESS_DIM);
@@ -108,9 +116,8 @@ static bool configurePowerManagement() {
     esp_err_t err = esp_pm_configure(&pm_config);
     if (err != ESP_OK) return false;
 
-    err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "cpu_work", &s_cpuLock);
-    if (err != ESP_OK) return false;
-
+    pmLocksInit();
+    powerProfilerInit();
     return true;
 }
 
@@ -119,7 +126,7 @@ static bool configurePowerManagement() {
 // =============================================================================
 
 static void configureWakeSources() {
-    // Light sleep wake via GPIO (digital domain). Keep both lines pulled high.
+    // Light sleep wake via GPIO (digital domain). Keep all lines pulled high.
     pinMode(TOUCH_INT_PIN, INPUT_PULLUP);
     pinMode(PMU_INT_PIN, INPUT_PULLUP);
 
@@ -128,16 +135,44 @@ static void configureWakeSources() {
     esp_sleep_enable_gpio_wakeup();
 }
 
+// =============================================================================
+// Internal: Wake line ISR
+// =============================================================================
+// gpio_wakeup_enable() leaves the lines configured as LOW_LEVEL interrupts
+// (required for light sleep wake). A level interrupt would fire continuously
+// while the line is held low, so the ISR masks itself and the main loop
+// re-enables it once the line is released.
+
+static void wakeLineIsr(void *arg) {
+    const gpio_num_t pin = (gpio_num_t)(intptr_t)arg;
+    gpio_intr_disable(pin);
+    if (pin == (gpio_num_t)TOUCH_INT_PIN) {
+        s_touchIrqArmed = false;
+        eventPostFromISR(EVT_TOUCH);
+    } else {
+        s_pmuIrqArmed = false;
+        eventPostFromISR(EVT_PMU);
+    }
+}
+
 // =============================================================================
 // Internal: Brownout Detection
 // =============================================================================
 
+// Learned threshold (sleep_policy.h), capped by the battery tier
+static uint32_t deepSleepTimeoutMs() {
+    const uint32_t learnedMs = sleepPolicyDeepSleepTimeoutMs();
+    const uint32_t tierMaxMs = batteryPolicy().deepSleepMaxMs;
+    return learnedMs < tierMaxMs ? learnedMs : tierMaxMs;
+}
+
 static void checkBatteryHealth() {
     if (!g_pmuPresent) return;
 
     int voltage = g_pmu.getBattVoltage();
 
     if (voltage < SHUTDOWN_THRESHOLD_MV && !g_isCharging) {
+        TRACE1(TR_BATTERY_CUTOFF, voltage);
         // Give user visual feedback if possible
         gfx.fillScreen(TFT_RED);
         gfx.setTextColor(TFT_WHITE);
@@ -150,6 +185,31 @@ static void checkBatteryHealth() {
     }
 }
 
+// =============================================================================
+// Internal: Timer service callbacks
+// =============================================================================
+
+// The loop runs powerUpdate() on every wakeup; this timer only guarantees
+// there is a wakeup when the next transition falls due.
+static void powerTransitionTimer() {
+    powerUpdate();
+}
+
+static void schedulePowerTransition() {
+    const uint32_t ms = powerMsUntilNextTransition();
+    if (ms == 0xFFFFFFFFu) {
+        timerStop(TIMER_POWER_STATE);
+        return;
+    }
+
+    uint32_t slackMs = DIM_SLACK_MS;
+    if (g_powerState == POWER_DIMMED) slackMs = LIGHT_SLEEP_SLACK_MS;
+    if (g_powerState == POWER_LIGHT_SLEEP) slackMs = DEEP_SLEEP_SLACK_MS;
+
+    // Activity only pushes the transition later - an early fire re-arms here
+    timerArmEarliest(TIMER_POWER_STATE, powerTransitionTimer, ms, slackMs);
+}
+
 // =============================================================================
 // Public: Initialization
 // =============================================================================
@@ -179,6 +239,9 @@ bool powerManagerInit() {
     s_lastActivityMs = millis();
     g_powerState = POWER_ACTIVE;
 
+    timerStart(TIMER_BATTERY_HEALTH, checkBatteryHealth, BATTERY_HEALTH_PERIOD_MS,
+               BATTERY_HEALTH_SLACK_MS, BATTERY_HEALTH_PERIOD_MS);
+
     return s_pmConfigured;
 }
 
@@ -187,7 +250,11 @@ bool powerManagerInit() {
 // =============================================================================
 
 void powerMarkActivity() {
-    s_lastActivityMs = millis();
+    const uint32_t now = millis();
+    if (g_powerState == POWER_LIGHT_SLEEP && !g_wokeFromSleep) {
+        s_wakeGapMs = now - s_lastActivityMs;  // Consumed by handleWakeFromLightSleep()
+    }
+    s_lastActivityMs = now;
 
     // If we were in light sleep mode, set wake flag for main loop
     if (g_powerState == POWER_LIGHT_SLEEP) {
@@ -223,13 +290,6 @@ bool powerUpdate() {
     const uint32_t now = millis();
     const uint32_t idleMs = now - s_lastActivityMs;
 
-    // Check battery health periodically
-    static uint32_t lastBatteryCheck = 0;
-    if (now - lastBatteryCheck > 10000) {
-        lastBatteryCheck = now;
-        checkBatteryHealth();
-    }
-
     // Don't transition during recording
     if (g_recordingInProgress) {
         if (g_powerState != POWER_ACTIVE) {
@@ -237,17 +297,17 @@ bool powerUpdate() {
             g_sleeping = false;
             g_dimmed = false;
             displaySetActive();
-            acquireCpuLock();  // Prevent auto light sleep during recording
         }
+        // PM_LOCK_AUDIO (held by the mic) keeps the CPU up while recording
+        schedulePowerTransition();
         return true;
-    } else {
-        releaseCpuLock();  // Allow auto light sleep
     }
 
     // State machine
     switch (g_powerState) {
         case POWER_ACTIVE:
             if (idleMs >= TIMEOUT_DIM_MS) {
+                TRACE(TR_POWER_STATE, POWER_ACTIVE, POWER_DIMMED);
                 g_powerState = POWER_DIMMED;
                 g_dimmed = true;
                 g_sleeping = false;
@@ -257,6 +317,7 @@ bool powerUpdate() {
 
         case POWER_DIMMED:
             if (idleMs >= TIMEOUT_LIGHT_SLEEP_MS) {
+                TRACE(TR_POWER_STATE, POWER_DIMMED, POWER_LIGHT_SLEEP);
                 g_powerState = POWER_LIGHT_SLEEP;
                 g_sleeping = true;
                 g_dimmed = false;
@@ -269,7 +330,8 @@ bool powerUpdate() {
         case POWER_LIGHT_SLEEP:
             if (TIMEOUT_DEEP_SLEEP_MS > 0) {
                 uint32_t lightSleepDuration = now - s_lightSleepEnteredMs;
-                if (lightSleepDuration >= TIMEOUT_DEEP_SLEEP_MS) {
+                if (lightSleepDuration >= deepSleepTimeoutMs()) {
+                    sleepPolicyOnDeepSleep(idleMs);
                     powerForceDeepSleep();  // Does not return
                 }
             }
@@ -280,6 +342,7 @@ bool powerUpdate() {
             break;
     }
 
+    schedulePowerTransition();
     return true;
 }
 
@@ -397,35 +460,52 @@ static void configureRtcWakeInput(gpio_num_t pin) {
 static bool configureDeepSleepWakeSources() {
     esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
 
-    // EXT0 needs RTC IO and RTC_PERIPH power domain alive.
+    // The ULP filter only arms once it sees INT high - a latched INT would
+    // disable touch wake for the whole sleep, so clear it and keep EXT0 if
+    // it stays asserted (finger on the glass).
+    bool touchIdle = digitalRead(TOUCH_INT_PIN) == HIGH || clearTouchInterrupt();
+
+    // EXT0 / ULP need RTC IO and RTC_PERIPH power domain alive.
     configureRtcWakeInput((gpio_num_t)TOUCH_INT_PIN);
     configureRtcWakeInput((gpio_num_t)PMU_INT_PIN);
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_FAST_MEM, ESP_PD_OPTION_OFF);
-    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_OFF);
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_ON);   // rtc_state.h block + ULP
 
-    esp_err_t err = esp_sleep_enable_ext0_wakeup((gpio_num_t)TOUCH_INT_PIN, 0);
-    if (err != ESP_OK) {
-        return false;
+    if (!touchIdle || !ulpTouchArm()) {
+        Serial.println("[PWR] touch wake via EXT0 (ULP filter not armed)");
+        esp_err_t err = esp_sleep_enable_ext0_wakeup((gpio_num_t)TOUCH_INT_PIN, 0);
+        if (err != ESP_OK) {
+            return false;
+        }
     }
 
     // Keep PMU interrupt/button wake as a secondary wake source.
-    err = esp_sleep_enable_ext1_wakeup((1ULL << PMU_INT_PIN), ESP_EXT1_WAKEUP_ALL_LOW);
+    esp_err_t err = esp_sleep_enable_ext1_wakeup((1ULL << PMU_INT_PIN), ESP_EXT1_WAKEUP_ALL_LOW);
     if (err != ESP_OK) {
         return false;
     }
 
+    // Scheduled headless sync (or hand-off to a full boot)
+    headlessSyncArmWakeTimer();
+
     return true;
 }
 
 void powerForceDeepSleep() {
+    energyLedgerOnDeepSleep();
+    timeSyncPrepareDeepSleep();
+    batteryPrepareDeepSleep();
+    statePrepareDeepSleep();
+    headlessSyncPrepareDeepSleep();
+    TRACE(TR_DEEP_SLEEP, g_batteryPercent, powerGetIdleTimeMs() / 1000);
     Serial.println("[PWR] entering deep sleep");
     Serial.flush();
 
     // Shutdown peripherals
     if (isMicRunning()) stopMic();
     deinitMic();
-    gfx.setBrightness(0);
+    if (!headlessSyncActive()) gfx.setBrightness(0);   // Panel never initialized headless
     pmuDisableDisplay();
     bleFullShutdown();
     pmuPrepareDeepSleep();
@@ -438,6 +518,7 @@ void powerForceDeepSleep() {
 
     delay(100);
 
+    rtcStateSeal();
     esp_deep_sleep_start();
 }
 
@@ -449,6 +530,11 @@ void powerForceDeepSleep() {
 // =============================================================================
 
 void handleWakeFromLightSleep() {
+    if (s_wakeGapMs > 0) {
+        sleepPolicyRecordGap(s_wakeGapMs);
+        s_wakeGapMs = 0;
+    }
+
     g_powerState = POWER_ACTIVE;
     g_sleeping = false;
     g_dimmed = false;
@@ -457,10 +543,10 @@ void handleWakeFromLightSleep() {
     g_wokeFromSleep = false;
 
     bleExitSleepMode();
-    acquireCpuLock();
+    pmLockAcquire(PM_LOCK_UI_ANIM);
     pmuEnableDisplay();
     gfx.wakeup();
-    gfx.setBrightness(g_isCharging ? BRIGHTNESS_CHARGING : BRIGHTNESS_ACTIVE);
+    gfx.setBrightness(g_isCharging ? BRIGHTNESS_CHARGING : batteryPolicyBrightness());
 
     currentState = IDLE;
     lastDrawnState = IDLE;
@@ -469,7 +555,7 @@ void handleWakeFromLightSleep() {
     batteryResetAfterWake();
     g_ignoreTap = true;
 
-    releaseCpuLock();
+    pmLockRelease(PM_LOCK_UI_ANIM);
 }
 
 // =============================================================================
@@ -496,36 +582,59 @@ uint32_t powerGetIdleTimeMs() {
     return millis() - s_lastActivityMs;
 }
 
+uint32_t powerMsUntilNextTransition() {
+    if (g_recordingInProgress) return 0xFFFFFFFFu;
+
+    const uint32_t now = millis();
+    const uint32_t idleMs = now - s_lastActivityMs;
+    uint32_t targetMs;
+    uint32_t elapsedMs;
+
+    switch (g_powerState) {
+        case POWER_ACTIVE:
+            targetMs = TIMEOUT_DIM_MS;
+            elapsedMs = idleMs;
+            break;
+        case POWER_DIMMED:
+            targetMs = TIMEOUT_LIGHT_SLEEP_MS;
+            elapsedMs = idleMs;
+            break;
+        case POWER_LIGHT_SLEEP:
+            if (TIMEOUT_DEEP_SLEEP_MS == 0) return 0xFFFFFFFFu;
+            targetMs = deepSleepTimeoutMs();
+            elapsedMs = now - s_lightSleepEnteredMs;
+            break;
+        default:
+            return 0xFFFFFFFFu;
+    }
+
+    return elapsedMs >= targetMs ? 0 : targetMs - elapsedMs;
+}
+
 // =============================================================================
 // Public: Diagnostics
 // =============================================================================
 
 void powerPrintDiagnostics() {
-    // Diagnostics removed - no serial output
+    Serial.printf("[PWR] state=%d idle=%lums est=%.1fmA\n", (int)g_powerState,
+                  (unsigned long)powerGetIdleTimeMs(), powerEstimateCurrentMa());
+    Serial.printf("[PWR] battery tier %s, deep sleep after %lus\n", batteryPolicy().name,
+                  (unsigned long)(deepSleepTimeoutMs() / 1000));
+    energyLedgerPrint();
+    clockDriftPrint();
+    workQueuePrint();
+    loopProfilerPrint();
+    ulpTouchPrint();
+    bleReconnectPrint();
+    bleAdvPrint();
+    bleTxPowerPrint();
+    bleConnPrint();
+    powerProfilerPrint();
 }
 
 float powerEstimateCurrentMa() {
-    float current = 0.0f;
-
-    // Base ESP32-S3 current at current frequency
-    int freq = getCpuFrequencyMhz();
-    if (freq >= 240) current += 50.0f;
-    else if (freq >= 160) current += 35.0f;
-    else if (freq >= 80) current += 25.0f;
-    else current += 10.0f;
-
-    // BLE adds significant current
-    if (s_bleConnected) current += 15.0f;
-    else current += 5.0f;  // Advertising
-
-    // Display
-    if (g_powerState == POWER_ACTIVE) current += 20.0f;
-    else if (g_powerState == POWER_DIMMED) current += 5.0f;
-
-    // Recording
-    if (g_recordingInProgress) current += 10.0f;
-
-    return current;
+    // Same calibrated model battery.cpp uses for load compensation
+    return currentModelEstimateMa();
 }
 
 // =============================================================================
@@ -537,11 +646,18 @@ float powerEstimateCurrentMa() {
 // =============================================================================
 
 void powerValidateWake() {
+    ulpTouchInit();
+
     esp_reset_reason_t resetReason = esp_reset_reason();
     if (resetReason != ESP_RST_DEEPSLEEP) return;
 
     esp_sleep_wakeup_cause_t wakeReason = esp_sleep_get_wakeup_cause();
     Serial.printf("[PWR] deep sleep wake, cause=%d\n", (int)wakeReason);
+    if (ulpTouchRejected()) {
+        Serial.printf("[PWR] ULP rejected %lu touch pulses so far (boots avoided)\n",
+                      (unsigned long)ulpTouchRejected());
+        TRACE(TR_WAKE_FILTERED, ulpTouchRejected(), ulpTouchCpuRejected());
+    }
 
     // Wake pins become RTC IOs in deep sleep; restore to digital GPIO for runtime.
     rtc_gpio_deinit((gpio_num_t)TOUCH_INT_PIN);
@@ -549,17 +665,22 @@ void powerValidateWake() {
     pinMode(TOUCH_INT_PIN, INPUT_PULLUP);
     pinMode(PMU_INT_PIN, INPUT_PULLUP);
 
-    // Unexpected wake sources - go back to sleep
+    // Unexpected wake sources - go back to sleep. The RTC state block is not
+    // consumed yet, so it stays valid and the sleep time keeps accumulating.
     if (wakeReason != ESP_SLEEP_WAKEUP_EXT0 &&
-        wakeReason != ESP_SLEEP_WAKEUP_EXT1) {
+        wakeReason != ESP_SLEEP_WAKEUP_ULP &&
+        wakeReason != ESP_SLEEP_WAKEUP_EXT1 &&
+        wakeReason != ESP_SLEEP_WAKEUP_TIMER) {   // Headless sync (headless_sync.h)
+        TRACE1(TR_WAKE_SPURIOUS, wakeReason);
         Serial.println("[PWR] unexpected wake source, back to sleep");
         Serial.flush();
         if (!configureDeepSleepWakeSources()) return;
         esp_deep_sleep_start();
     }
 
-    // Touch wake - validate finger is actually present
-    if (wakeReason == ESP_SLEEP_WAKEUP_EXT0) {
+    // Touch wake - validate finger is actually present. The ULP only
+    // confirmed the INT level; a latched false detection looks the same.
+    if (wakeReason == ESP_SLEEP_WAKEUP_EXT0 || wakeReason == ESP_SLEEP_WAKEUP_ULP) {
         // Step 1: Clear pending INT via I2C
         bool cleared = clearTouchInterrupt();
 
@@ -571,6 +692,8 @@ void powerValidateWake() {
         int pinState = digitalRead(TOUCH_INT_PIN);
 
         if (pinState == HIGH) {
+            ulpTouchNoteCpuReject();
+            TRACE1(TR_WAKE_SPURIOUS, wakeReason);
             Serial.println("[PWR] spurious touch wake, back to sleep");
             Serial.flush();
             if (!configureDeepSleepWakeSources()) return;
@@ -580,3 +703,31 @@ void powerValidateWake() {
         Serial.println("[PWR] touch wake validated, finger present");
     }
 }
+
+// =============================================================================
+// Public: Wake line interrupts -> loop events
+// =============================================================================
+
+void powerArmWakeInterrupts() {
+    gpio_install_isr_service(0);  // ESP_ERR_INVALID_STATE if already installed - fine
+
+    // Re-assert level wake config (pinMode() calls since init may have reset it)
+    gpio_wakeup_enable((gpio_num_t)TOUCH_INT_PIN, GPIO_INTR_LOW_LEVEL);
+    gpio_wakeup_enable((gpio_num_t)PMU_INT_PIN, GPIO_INTR_LOW_LEVEL);
+
+    gpio_isr_handler_add((gpio_num_t)TOUCH_INT_PIN, wakeLineIsr, (void *)(intptr_t)TOUCH_INT_PIN);
+    gpio_isr_handler_add((gpio_num_t)PMU_INT_PIN, wakeLineIsr, (void *)(intptr_t)PMU_INT_PIN);
+
+    powerRearmWakeInterrupts();
+}
+
+void powerRearmWakeInterrupts() {
+    if (!s_touchIrqArmed && digitalRead(TOUCH_INT_PIN) == HIGH) {
+        s_touchIrqArmed = true;
+        gpio_intr_enable((gpio_num_t)TOUCH_INT_PIN);
+    }
+    if (!s_pmuIrqArmed && digitalRead(PMU_INT_PIN) == HIGH) {
+        s_pmuIrqArmed = true;
+        gpio_intr_enable((gpio_num_t)PMU_INT_PIN);
+    }
+}
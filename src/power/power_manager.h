@@ -4,7 +4,8 @@
 // POWER MANAGER - Central power control for T-Watch S3
 // =============================================================================
 // This module owns ALL power decisions. No other module should directly
-// call esp_light_sleep_start() or modify CPU frequency.
+// call esp_light_sleep_start() or modify CPU frequency - subsystems that
+// need the CPU up take a named lock from pm_locks.h instead.
 //
 // OPTIMIZED FOR:
 // - Instant wake response (<100ms from tap to screen)
@@ -97,6 +98,10 @@ bool powerCanDoWork();  // True if not in deep sleep transition
 // Get time since last activity (for UI timeout decisions)
 uint32_t powerGetIdleTimeMs();
 
+// Milliseconds until powerUpdate() will make the next automatic transition
+// (0xFFFFFFFF if none is pending, e.g. while recording)
+uint32_t powerMsUntilNextTransition();
+
 // -----------------------------------------------------------------------------
 // Wake Handling
 // -----------------------------------------------------------------------------
@@ -113,12 +118,21 @@ void handleWakeFromLightSleep();
 // Validates deep sleep wake cause. If spurious, goes back to deep sleep (does NOT return).
 void powerValidateWake();
 
+// Attach ISRs to the touch/PMU wake lines so they post EVT_TOUCH / EVT_PMU.
+// Call after initPMU() (which reconfigures PMU_INT_PIN).
+void powerArmWakeInterrupts();
+
+// The wake lines are level-low: each ISR disables itself after firing.
+// Call from the main loop to re-enable lines that have been released.
+void powerRearmWakeInterrupts();
+
 // -----------------------------------------------------------------------------
 // Diagnostics
 // -----------------------------------------------------------------------------
 
-// Print current power state and measurements to Serial
+// Print current power state, sleep residency and PM lock breakdown to Serial
+// (the same data is readable over BLE, see ble_diag.h)
 void powerPrintDiagnostics();
 
-// Get estimated current draw in mA (rough approximation)
+// Get estimated current draw in mA (fuel-gauge calibrated, see current_model.h)
 float powerEstimateCurrentMa();
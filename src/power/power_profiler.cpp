@@ -0,0 +1,183 @@
+#include "power_profiler.h"
+
+#include <esp_cpu.h>
+#include <esp_freertos_hooks.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+#include "power_manager.h"
+#include "pm_locks.h"
+#include "../ble/diag_bytes.h"
+#include "../system/events.h"
+
+// =============================================================================
+// RESIDENCY MODEL
+// =============================================================================
+// Per idle-hook interval: dt (esp_timer us) and c (CPU cycles).
+//   Light sleep:  dt > c / F_MIN + threshold -> sleep = dt - c / F_MIN
+//   Awake:        c = F_MAX * t_max + F_MIN * t_min,  t_max + t_min = dt
+// =============================================================================
+
+constexpr int64_t SLEEP_DETECT_US = 1000;   // Below this a gap is just jitter
+constexpr uint8_t SNAPSHOT_VERSION = 1;
+constexpr int TRACKED_STATES = POWER_LIGHT_SLEEP + 1;
+
+static bool s_initialized = false;
+static portMUX_TYPE s_profMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Idle hook state (CPU0 only)
+static int64_t s_lastHookUs = 0;
+static uint32_t s_lastHookCycles = 0;
+
+// Accumulators (us)
+static uint64_t s_cpuMaxUs = 0;
+static uint64_t s_cpuMinUs = 0;
+static uint64_t s_lightSleepUs = 0;
+static uint32_t s_lightSleepEntries = 0;
+static uint16_t s_wakeCauses[PROF_WAKE_COUNT] = {0};
+
+static ProfilerWakeCause foldWakeCause(esp_sleep_wakeup_cause_t cause) {
+    switch (cause) {
+        case ESP_SLEEP_WAKEUP_TIMER: return PROF_WAKE_TIMER;
+        case ESP_SLEEP_WAKEUP_GPIO:
+        case ESP_SLEEP_WAKEUP_EXT0:
+        case ESP_SLEEP_WAKEUP_EXT1:  return PROF_WAKE_GPIO;
+        case ESP_SLEEP_WAKEUP_BT:    return PROF_WAKE_BT;
+        case ESP_SLEEP_WAKEUP_UART:  return PROF_WAKE_UART;
+        default:                     return PROF_WAKE_OTHER;
+    }
+}
+
+static bool profilerIdleHook() {
+    const int64_t nowUs = esp_timer_get_time();
+    const uint32_t cycles = esp_cpu_get_ccount();
+    const int64_t dtUs = nowUs - s_lastHookUs;
+    const uint32_t dCycles = cycles - s_lastHookCycles;  // Wraps at most once
+    s_lastHookUs = nowUs;
+    s_lastHookCycles = cycles;
+    if (dtUs <= 0) return true;
+
+    // Cycles per us == MHz
+    const int64_t awakeAtMinUs = dCycles / CPU_FREQ_MIN;
+
+    portENTER_CRITICAL(&s_profMux);
+    if (dtUs > awakeAtMinUs + SLEEP_DETECT_US) {
+        s_lightSleepUs += dtUs - awakeAtMinUs;
+        s_cpuMinUs += awakeAtMinUs;
+        s_lightSleepEntries++;
+        ProfilerWakeCause cause = foldWakeCause(esp_sleep_get_wakeup_cause());
+        if (s_wakeCauses[cause] < 0xFFFF) s_wakeCauses[cause]++;
+    } else {
+        int64_t extra = (int64_t)dCycles - (int64_t)CPU_FREQ_MIN * dtUs;
+        int64_t maxUs = extra > 0 ? extra / (CPU_FREQ_MAX - CPU_FREQ_MIN) : 0;
+        if (maxUs > dtUs) maxUs = dtUs;
+        s_cpuMaxUs += maxUs;
+        s_cpuMinUs += dtUs - maxUs;
+    }
+    portEXIT_CRITICAL(&s_profMux);
+
+    return true;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void powerProfilerInit() {
+    if (s_initialized) return;
+    s_lastHookUs = esp_timer_get_time();
+    s_lastHookCycles = esp_cpu_get_ccount();
+    s_initialized = esp_register_freertos_idle_hook_for_cpu(profilerIdleHook, 0) == ESP_OK;
+}
+
+uint32_t powerProfilerLightSleepMs() {
+    portENTER_CRITICAL(&s_profMux);
+    uint64_t us = s_lightSleepUs;
+    portEXIT_CRITICAL(&s_profMux);
+    return (uint32_t)(us / 1000);
+}
+
+uint32_t powerProfilerLightSleepEntries() {
+    return s_lightSleepEntries;
+}
+
+float powerProfilerLightSleepFraction() {
+    uint64_t uptimeUs = esp_timer_get_time();
+    if (uptimeUs == 0) return 0.0f;
+    return (float)powerProfilerLightSleepMs() * 1000.0f / (float)uptimeUs;
+}
+
+size_t powerProfilerSnapshot(uint8_t *buf, size_t cap) {
+    const size_t len = 4 + 4 + 12 + 12 + 12 + 4 + 2 * PROF_WAKE_COUNT +
+                       1 + PM_LOCK_COUNT * 6;
+    if (!buf || cap < len) return 0;
+
+    portENTER_CRITICAL(&s_profMux);
+    const uint64_t cpuMaxUs = s_cpuMaxUs;
+    const uint64_t cpuMinUs = s_cpuMinUs;
+    const uint64_t lightSleepUs = s_lightSleepUs;
+    const uint32_t entries = s_lightSleepEntries;
+    uint16_t causes[PROF_WAKE_COUNT];
+    for (int i = 0; i < PROF_WAKE_COUNT; i++) causes[i] = s_wakeCauses[i];
+    portEXIT_CRITICAL(&s_profMux);
+
+    uint8_t *p = buf;
+    p = putU8(p, SNAPSHOT_VERSION);
+    p = putU8(p, 0);
+    p = putU16(p, (uint16_t)len);
+    p = putU32(p, (uint32_t)(esp_timer_get_time() / 1000000));
+
+    for (int s = 0; s < TRACKED_STATES; s++) {
+        const LoopWakeStats &st = eventsGetStats((PowerState)s);
+        p = putU32(p, st.blockedMs + st.busyMs);
+    }
+    for (int s = 0; s < TRACKED_STATES; s++) {
+        p = putU32(p, eventsGetStats((PowerState)s).wakeups);
+    }
+
+    p = putU32(p, (uint32_t)(cpuMaxUs / 1000));
+    p = putU32(p, (uint32_t)(cpuMinUs / 1000));
+    p = putU32(p, (uint32_t)(lightSleepUs / 1000));
+    p = putU32(p, entries);
+    for (int i = 0; i < PROF_WAKE_COUNT; i++) p = putU16(p, causes[i]);
+
+    p = putU8(p, PM_LOCK_COUNT);
+    for (int i = 0; i < PM_LOCK_COUNT; i++) {
+        PmLockStats ls = pmLockGetStats((PmLockId)i);
+        p = putU32(p, (uint32_t)(ls.heldUs / 1000));
+        p = putU16(p, ls.acquisitions > 0xFFFF ? 0xFFFF : (uint16_t)ls.acquisitions);
+    }
+
+    return p - buf;
+}
+
+void powerProfilerPrint() {
+    portENTER_CRITICAL(&s_profMux);
+    const uint32_t cpuMaxMs = (uint32_t)(s_cpuMaxUs / 1000);
+    const uint32_t cpuMinMs = (uint32_t)(s_cpuMinUs / 1000);
+    const uint32_t sleepMs = (uint32_t)(s_lightSleepUs / 1000);
+    uint16_t causes[PROF_WAKE_COUNT];
+    for (int i = 0; i < PROF_WAKE_COUNT; i++) causes[i] = s_wakeCauses[i];
+    portEXIT_CRITICAL(&s_profMux);
+
+    Serial.printf("[PROF] uptime=%lus %uMHz=%lums %uMHz=%lums light_sleep=%lums (%.0f%%) entries=%lu\n",
+                  (unsigned long)(esp_timer_get_time() / 1000000),
+                  CPU_FREQ_MAX, (unsigned long)cpuMaxMs,
+                  CPU_FREQ_MIN, (unsigned long)cpuMinMs,
+                  (unsigned long)sleepMs, powerProfilerLightSleepFraction() * 100.0f,
+                  (unsigned long)s_lightSleepEntries);
+    Serial.printf("[PROF] wake causes timer=%u gpio=%u bt=%u uart=%u other=%u\n",
+                  causes[PROF_WAKE_TIMER], causes[PROF_WAKE_GPIO], causes[PROF_WAKE_BT],
+                  causes[PROF_WAKE_UART], causes[PROF_WAKE_OTHER]);
+    Serial.printf("[PROF] state ms active=%lu dim=%lu sleep=%lu\n",
+                  (unsigned long)(eventsGetStats(POWER_ACTIVE).blockedMs + eventsGetStats(POWER_ACTIVE).busyMs),
+                  (unsigned long)(eventsGetStats(POWER_DIMMED).blockedMs + eventsGetStats(POWER_DIMMED).busyMs),
+                  (unsigned long)(eventsGetStats(POWER_LIGHT_SLEEP).blockedMs + eventsGetStats(POWER_LIGHT_SLEEP).busyMs));
+    for (int i = 0; i < PM_LOCK_COUNT; i++) {
+        PmLockStats ls = pmLockGetStats((PmLockId)i);
+        Serial.printf("[PROF] lock %-8s held=%lums n=%lu%s\n", pmLockName((PmLockId)i),
+                      (unsigned long)(ls.heldUs / 1000), (unsigned long)ls.acquisitions,
+                      ls.held ? " (held)" : "");
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// =============================================================================
+// POWER PROFILER - Sleep residency and wakeup sources
+// =============================================================================
+// Accumulates, since boot:
+//   - time in each PowerState (from the loop event statistics)
+//   - time at CPU_FREQ_MAX, at CPU_FREQ_MIN and in auto light sleep
+//   - light sleep entries and the wakeup cause of each
+//   - PM lock hold times (pm_locks.h)
+//
+// IDF 4.4 has no light sleep callbacks and Arduino builds without
+// CONFIG_PM_PROFILING, so residency is inferred from a FreeRTOS idle hook:
+// CCOUNT stops in light sleep while esp_timer keeps counting. A gap
+// between two idle hook calls that is longer than the cycles could account
+// for at CPU_FREQ_MIN is light sleep. Conservative - it never over-reports.
+// =============================================================================
+
+#include <Arduino.h>
+
+// Wakeup cause buckets (esp_sleep_wakeup_cause_t folded into a fixed set)
+enum ProfilerWakeCause {
+    PROF_WAKE_TIMER,      // esp_timer / FreeRTOS tick deadline
+    PROF_WAKE_GPIO,       // Touch / PMU line
+    PROF_WAKE_BT,         // BLE controller (connection / advertising event)
+    PROF_WAKE_UART,
+    PROF_WAKE_OTHER,
+    PROF_WAKE_COUNT
+};
+
+// Register the idle hook (called by powerManagerInit() once esp_pm is configured)
+void powerProfilerInit();
+
+// Light sleep residency (ms since boot)
+uint32_t powerProfilerLightSleepMs();
+uint32_t powerProfilerLightSleepEntries();
+float powerProfilerLightSleepFraction();  // 0..1 of uptime
+
+// Compact little-endian binary snapshot for the diagnostics characteristic.
+// Returns bytes written (0 if cap is too small). Layout (version 1):
+//   u8  version, u8 reserved, u16 length
+//   u32 uptime_s
+//   u32 state_ms[3]            active, dimmed, light sleep
+//   u32 loop_wakeups[3]        per state
+//   u32 cpu_max_ms, cpu_min_ms, light_sleep_ms
+//   u32 light_sleep_entries
+//   u16 wake_cause[PROF_WAKE_COUNT]
+//   u8  lock_count, then per PM lock: u32 held_ms, u16 acquisitions
+size_t powerProfilerSnapshot(uint8_t *buf, size_t cap);
+
+// Human readable dump to Serial (powerPrintDiagnostics())
+void powerProfilerPrint();
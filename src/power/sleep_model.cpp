@@ -0,0 +1,124 @@
+#include "sleep_model.h"
+
+#include <string.h>
+
+// Upper bin edges in seconds; the last bin is open-ended
+static const uint32_t GAP_BIN_UPPER_S[SLEEP_GAP_BINS] = {
+    30, 60, 120, 300, 600, 1200, 1800, 3600, 7200, 14400, 28800, 0xFFFFFFFFu
+};
+
+// Representative gap per bin (roughly the geometric middle)
+static const uint32_t GAP_BIN_REP_S[SLEEP_GAP_BINS] = {
+    20, 45, 85, 190, 425, 850, 1470, 2550, 5100, 10200, 20400, 43200
+};
+
+// Deep sleep thresholds worth considering (seconds of light sleep)
+static const uint32_t CANDIDATE_DEEP_AFTER_S[] = {
+    60, 120, 180, 280, 600, 1200, 1800, 3600, 7200
+};
+
+constexpr uint16_t COUNT_SATURATION = 0xFFFF;
+
+// Histogram of one slot, or of all slots pooled
+static void slotCounts(const SleepGapHistogram &h, int slot, uint32_t out[SLEEP_GAP_BINS]) {
+    for (int b = 0; b < SLEEP_GAP_BINS; b++) {
+        if (slot >= 0 && slot < SLEEP_TOD_SLOTS) {
+            out[b] = h.counts[slot][b];
+        } else {
+            out[b] = 0;
+            for (int s = 0; s < SLEEP_TOD_SLOTS; s++) out[b] += h.counts[s][b];
+        }
+    }
+}
+
+static float costForCounts(const uint32_t counts[SLEEP_GAP_BINS], uint32_t deepAfterS,
+                           const SleepEnergyParams &p) {
+    uint32_t total = 0;
+    float cost = 0.0f;
+
+    for (int b = 0; b < SLEEP_GAP_BINS; b++) {
+        if (counts[b] == 0) continue;
+        total += counts[b];
+
+        const uint32_t gapS = GAP_BIN_REP_S[b];
+        if (gapS <= p.lightSleepAfterS) continue;  // Never reached light sleep
+        const uint32_t sleptS = gapS - p.lightSleepAfterS;
+
+        float gapCost;
+        if (sleptS <= deepAfterS) {
+            gapCost = p.lightSleepMa * sleptS;
+        } else {
+            gapCost = p.lightSleepMa * deepAfterS +
+                      p.deepSleepMa * (sleptS - deepAfterS) +
+                      p.wakeCostMas;
+        }
+        cost += gapCost * counts[b];
+    }
+
+    return total > 0 ? cost / total : 0.0f;
+}
+
+void sleepModelReset(SleepGapHistogram &h) {
+    memset(&h, 0, sizeof(h));
+}
+
+int sleepModelSlotForEpoch(int64_t localEpoch) {
+    if (localEpoch <= 0) return SLEEP_TOD_UNKNOWN;
+    const int hour = (int)((localEpoch % 86400) / 3600);
+    return hour / (24 / SLEEP_TOD_BUCKETS);
+}
+
+int sleepModelGapBin(uint32_t gapS) {
+    for (int b = 0; b < SLEEP_GAP_BINS; b++) {
+        if (gapS <= GAP_BIN_UPPER_S[b]) return b;
+    }
+    return SLEEP_GAP_BINS - 1;
+}
+
+void sleepModelAddGap(SleepGapHistogram &h, int slot, uint32_t gapS) {
+    if (slot < 0 || slot >= SLEEP_TOD_SLOTS) slot = SLEEP_TOD_UNKNOWN;
+    const int bin = sleepModelGapBin(gapS);
+
+    if (h.counts[slot][bin] == COUNT_SATURATION) {
+        for (int b = 0; b < SLEEP_GAP_BINS; b++) h.counts[slot][b] >>= 1;
+    }
+    h.counts[slot][bin]++;
+}
+
+uint32_t sleepModelSlotSamples(const SleepGapHistogram &h, int slot) {
+    uint32_t counts[SLEEP_GAP_BINS];
+    slotCounts(h, slot, counts);
+    uint32_t total = 0;
+    for (int b = 0; b < SLEEP_GAP_BINS; b++) total += counts[b];
+    return total;
+}
+
+float sleepModelExpectedCostMas(const SleepGapHistogram &h, int slot,
+                                uint32_t deepAfterS, const SleepEnergyParams &p) {
+    uint32_t counts[SLEEP_GAP_BINS];
+    slotCounts(h, slot, counts);
+    return costForCounts(counts, deepAfterS, p);
+}
+
+uint32_t sleepModelChooseDeepAfterS(const SleepGapHistogram &h, int slot,
+                                    const SleepEnergyParams &p, uint32_t fallbackS) {
+    // Thin slot: use every slot's data rather than guess from a handful
+    if (sleepModelSlotSamples(h, slot) < SLEEP_MIN_SAMPLES) {
+        slot = -1;
+        if (sleepModelSlotSamples(h, slot) < SLEEP_MIN_SAMPLES) return fallbackS;
+    }
+
+    uint32_t counts[SLEEP_GAP_BINS];
+    slotCounts(h, slot, counts);
+
+    uint32_t best = fallbackS;
+    float bestCost = costForCounts(counts, fallbackS, p);
+    for (uint32_t candidate : CANDIDATE_DEEP_AFTER_S) {
+        float cost = costForCounts(counts, candidate, p);
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = candidate;
+        }
+    }
+    return best;
+}
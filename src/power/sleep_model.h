@@ -0,0 +1,59 @@
+#pragma once
+
+// =============================================================================
+// SLEEP MODEL - Idle-gap statistics and deep sleep threshold selection
+// =============================================================================
+// Pure C++ (no Arduino / IDF) so tools/sleep_sim can replay usage logs
+// against exactly the code the firmware runs.
+//
+// A "gap" is the time from the last interaction (going idle) to the next
+// one. Gaps are kept in log-spaced bins, one histogram per 4-hour
+// time-of-day slot. For a candidate deep sleep threshold T (time spent in
+// light sleep before deep sleep) the expected charge per gap is:
+//
+//   gap <= L + T:  I_light * (gap - L)
+//   gap >  L + T:  I_light * T + I_deep * (gap - L - T) + Q_wake
+//
+// where L is the light sleep timeout and Q_wake the charge of a cold
+// boot + BLE reconnect. The threshold with the lowest expectation wins.
+// =============================================================================
+
+#include <stdint.h>
+
+constexpr int SLEEP_TOD_BUCKETS  = 6;                   // 4-hour slots
+constexpr int SLEEP_TOD_UNKNOWN  = SLEEP_TOD_BUCKETS;   // No wall clock yet
+constexpr int SLEEP_TOD_SLOTS    = SLEEP_TOD_BUCKETS + 1;
+constexpr int SLEEP_GAP_BINS     = 12;
+constexpr int SLEEP_MIN_SAMPLES  = 8;                   // Below this, pool all slots
+
+struct SleepGapHistogram {
+    uint16_t counts[SLEEP_TOD_SLOTS][SLEEP_GAP_BINS];
+};
+
+struct SleepEnergyParams {
+    float lightSleepMa;       // Average current in light sleep
+    float deepSleepMa;        // Average current in deep sleep
+    float wakeCostMas;        // Boot + reconnect charge (mA*s)
+    uint32_t lightSleepAfterS;  // L: idle time before light sleep
+};
+
+void sleepModelReset(SleepGapHistogram &h);
+
+// Slot for a local-time epoch (SLEEP_TOD_UNKNOWN if epoch <= 0)
+int sleepModelSlotForEpoch(int64_t localEpoch);
+
+int sleepModelGapBin(uint32_t gapS);
+
+// Add one gap. When a count saturates the whole slot is halved, so old
+// behaviour decays instead of freezing the histogram.
+void sleepModelAddGap(SleepGapHistogram &h, int slot, uint32_t gapS);
+
+uint32_t sleepModelSlotSamples(const SleepGapHistogram &h, int slot);
+
+// Expected charge per gap (mA*s) for deep sleep after deepAfterS of light sleep
+float sleepModelExpectedCostMas(const SleepGapHistogram &h, int slot,
+                                uint32_t deepAfterS, const SleepEnergyParams &p);
+
+// Best threshold from the candidate list, or fallbackS without enough data
+uint32_t sleepModelChooseDeepAfterS(const SleepGapHistogram &h, int slot,
+                                    const SleepEnergyParams &p, uint32_t fallbackS);
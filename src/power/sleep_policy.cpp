@@ -0,0 +1,144 @@
+#include "sleep_policy.h"
+
+#include <Preferences.h>
+#include <esp_system.h>
+
+#include "sleep_model.h"
+#include "current_model.h"
+#include "power_manager.h"
+#include "pm_locks.h"
+#include "../system/state.h"
+#include "../system/time_sync.h"
+#include "../system/rtc_state.h"
+
+// =============================================================================
+// ENERGY PARAMETERS
+// =============================================================================
+// Light sleep current comes from the calibrated current model. Deep sleep
+// and the wake cost are bench figures: CURRENT_DEEP_SLEEP_MA, and ~400 mA*s
+// for boot (~1.5s) plus reconnect and re-encryption (~3-4s with the
+// display on).
+// =============================================================================
+
+constexpr float WAKE_COST_MAS = 400.0f;
+
+constexpr uint32_t SAVE_EVERY_SAMPLES = 8;           // Batch NVS writes
+constexpr uint32_t MAX_DEEP_GAP_S     = 7 * 86400;   // Ignore nonsense gaps
+
+constexpr const char *POLICY_PREF_NAMESPACE = "sleeppol";
+constexpr const char *POLICY_PREF_HIST_KEY  = "hist";
+constexpr const char *POLICY_PREF_PEND_KEY  = "pend";
+
+static SleepGapHistogram s_hist;
+static uint32_t s_unsavedSamples = 0;
+static int64_t s_pendingIdleStartEpoch = 0;   // Gap open across deep sleep
+
+// Cached choice - recomputed when the slot, link or histogram changes
+static int s_cachedSlot = -1;
+static bool s_cachedConnected = false;
+static bool s_cacheValid = false;
+static uint32_t s_cachedTimeoutMs = TIMEOUT_DEEP_SLEEP_MS;
+
+static SleepEnergyParams energyParams() {
+    SleepEnergyParams p;
+    p.lightSleepMa = currentModelLoadMa(LOAD_LIGHT_SLEEP);
+    if (g_bleConnected) p.lightSleepMa += currentModelLoadMa(LOAD_BLE_LINK);
+    p.deepSleepMa = CURRENT_DEEP_SLEEP_MA;
+    p.wakeCostMas = WAKE_COST_MAS;
+    p.lightSleepAfterS = TIMEOUT_LIGHT_SLEEP_MS / 1000;
+    return p;
+}
+
+static void savePolicy() {
+    PmLockGuard flashLock(PM_LOCK_FLASH);
+    Preferences prefs;
+    if (!prefs.begin(POLICY_PREF_NAMESPACE, false)) return;
+    prefs.putBytes(POLICY_PREF_HIST_KEY, &s_hist, sizeof(s_hist));
+    prefs.putLong64(POLICY_PREF_PEND_KEY, s_pendingIdleStartEpoch);
+    prefs.end();
+    s_unsavedSamples = 0;
+}
+
+static void addGap(int64_t idleStartEpoch, uint32_t gapS) {
+    const int slot = sleepModelSlotForEpoch(idleStartEpoch);
+    sleepModelAddGap(s_hist, slot, gapS);
+    s_cacheValid = false;
+    s_unsavedSamples++;
+
+    Serial.printf("[SLP] gap %lld %lu\n", (long long)idleStartEpoch, (unsigned long)gapS);
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void sleepPolicyInit() {
+    sleepModelReset(s_hist);
+
+    Preferences prefs;
+    if (prefs.begin(POLICY_PREF_NAMESPACE, true)) {
+        if (prefs.getBytesLength(POLICY_PREF_HIST_KEY) == sizeof(s_hist)) {
+            prefs.getBytes(POLICY_PREF_HIST_KEY, &s_hist, sizeof(s_hist));
+        }
+        s_pendingIdleStartEpoch = prefs.getLong64(POLICY_PREF_PEND_KEY, 0);
+        prefs.end();
+    }
+
+    // A pending gap only means something across a deep sleep wake
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP) {
+        s_pendingIdleStartEpoch = 0;
+    }
+
+    s_cacheValid = false;
+
+    // Clock already restored from RTC memory - resolve the gap now
+    if (rtcStateResumed() && g_haveHostTime) sleepPolicyOnTimeSync();
+}
+
+void sleepPolicyRecordGap(uint32_t idleMs) {
+    const uint32_t gapS = idleMs / 1000;
+    const time_t now = getCurrentEpoch();
+    addGap(now > 0 ? (int64_t)now - gapS : 0, gapS);
+
+    if (s_unsavedSamples >= SAVE_EVERY_SAMPLES) savePolicy();
+}
+
+uint32_t sleepPolicyDeepSleepTimeoutMs() {
+    const int slot = sleepModelSlotForEpoch(getCurrentEpoch());
+    if (s_cacheValid && slot == s_cachedSlot && g_bleConnected == s_cachedConnected) {
+        return s_cachedTimeoutMs;
+    }
+
+    const uint32_t deepAfterS = sleepModelChooseDeepAfterS(
+        s_hist, slot, energyParams(), TIMEOUT_DEEP_SLEEP_MS / 1000);
+    if (deepAfterS * 1000 != s_cachedTimeoutMs) {
+        Serial.printf("[SLP] deep sleep after %lus (slot %d)\n", (unsigned long)deepAfterS, slot);
+    }
+
+    s_cachedSlot = slot;
+    s_cachedConnected = g_bleConnected;
+    s_cachedTimeoutMs = deepAfterS * 1000;
+    s_cacheValid = true;
+    return s_cachedTimeoutMs;
+}
+
+void sleepPolicyOnDeepSleep(uint32_t idleMs) {
+    const time_t now = getCurrentEpoch();
+    s_pendingIdleStartEpoch = g_haveHostTime ? (int64_t)now - idleMs / 1000 : 0;
+    savePolicy();
+}
+
+void sleepPolicyOnTimeSync() {
+    if (s_pendingIdleStartEpoch <= 0) return;
+
+    // Boot happened at the deep sleep wake
+    const int64_t wakeEpoch = (int64_t)getCurrentEpoch() - millis() / 1000;
+    const int64_t gapS = wakeEpoch - s_pendingIdleStartEpoch;
+    const int64_t idleStart = s_pendingIdleStartEpoch;
+    s_pendingIdleStartEpoch = 0;
+
+    if (gapS > 0 && gapS < MAX_DEEP_GAP_S) {
+        addGap(idleStart, (uint32_t)gapS);
+    }
+    savePolicy();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// =============================================================================
+// SLEEP POLICY - Learned deep sleep timeout
+// =============================================================================
+// Deep sleep saves milliamps but the next interaction pays a cold boot and
+// a BLE reconnect. This module records how long the user actually stays
+// away (by time of day, in NVS) and picks the light->deep sleep threshold
+// with the lowest expected charge (see sleep_model.h).
+//
+// Gaps that end in light sleep are measured directly. Gaps that end in a
+// deep sleep wake are resolved on the first host time sync after boot.
+// Each gap is also logged as "[SLP] gap <idle_start_epoch> <seconds>" -
+// the input format of tools/sleep_sim.
+// =============================================================================
+
+#include <Arduino.h>
+
+// Load the histogram from NVS (call after timeSyncInit() and currentModelInit())
+void sleepPolicyInit();
+
+// The user came back after idleMs of inactivity (light sleep wake)
+void sleepPolicyRecordGap(uint32_t idleMs);
+
+// Deep sleep timeout for the current time of day (ms of light sleep)
+uint32_t sleepPolicyDeepSleepTimeoutMs();
+
+// About to enter deep sleep after idleMs of inactivity - persist state
+void sleepPolicyOnDeepSleep(uint32_t idleMs);
+
+// Host time arrived - resolves a gap pending from before deep sleep
+void sleepPolicyOnTimeSync();
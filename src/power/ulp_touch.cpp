@@ -0,0 +1,149 @@
+#include "ulp_touch.h"
+
+#include <stddef.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <esp32s3/ulp.h>
+#include <driver/rtc_io.h>
+#include <soc/rtc.h>
+#include <soc/rtc_cntl_reg.h>
+#include <soc/rtc_io_reg.h>
+
+#include "wake_filter.h"
+#include "../hardware_config.h"
+
+// RTC slow memory words (ULP addressing). The program goes at 0, the data
+// after it - all inside the ULP reserved area.
+constexpr uint32_t ULP_PROG_WORD   = 0;
+constexpr uint32_t ULP_PROG_MAX    = 64;
+constexpr uint32_t ULP_DATA_WORD   = ULP_PROG_MAX;
+
+// Data words - the first three mirror WakeFilterState
+enum UlpDataWord : uint32_t {
+    ULP_ARMED,
+    ULP_LOW_COUNT,
+    ULP_REJECTED,
+    ULP_CPU_REJECTED,     // Written by the main cores only
+    ULP_DATA_COUNT
+};
+
+// The program below is wakeFilterStep() by hand. It mirrors, from
+// wake_filter.h:
+//   - WAKE_FILTER_PERIOD_US        ULP timer period
+//   - WAKE_FILTER_CONFIRM_SAMPLES  low samples to wake
+//   - WAKE_FILTER_COUNT_MAX        rejected counter saturation
+//   - WakeFilterState              field order = data words
+static_assert(offsetof(WakeFilterState, armed) / sizeof(uint16_t) == ULP_ARMED &&
+              offsetof(WakeFilterState, lowCount) / sizeof(uint16_t) == ULP_LOW_COUNT &&
+              offsetof(WakeFilterState, rejected) / sizeof(uint16_t) == ULP_REJECTED,
+              "ULP data words out of step with WakeFilterState");
+
+#ifdef CONFIG_ESP32S3_ULP_COPROC_RESERVE_MEM
+static_assert((ULP_DATA_WORD + ULP_DATA_COUNT) * 4 <= CONFIG_ESP32S3_ULP_COPROC_RESERVE_MEM,
+              "ULP touch program does not fit the ULP reserved memory");
+#else
+#error "ULP touch needs the ULP coprocessor (CONFIG_ESP32S3_ULP_COPROC_ENABLED + RESERVE_MEM)"
+#endif
+
+// Labels
+enum { L_LINE_HIGH, L_SET_ARMED, L_SATURATED, L_DONE };
+
+static uint32_t dataWord(UlpDataWord w) {
+    return RTC_SLOW_MEM[ULP_DATA_WORD + w] & WAKE_FILTER_COUNT_MAX;   // ULP stores 16 bits
+}
+
+static void setDataWord(UlpDataWord w, uint32_t v) {
+    RTC_SLOW_MEM[ULP_DATA_WORD + w] = v & WAKE_FILTER_COUNT_MAX;
+}
+
+static void stopUlpTimer() {
+    CLEAR_PERI_REG_MASK(RTC_CNTL_ULP_CP_TIMER_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void ulpTouchInit() {
+    stopUlpTimer();
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP) {
+        for (uint32_t w = 0; w < ULP_DATA_COUNT; w++) setDataWord((UlpDataWord)w, 0);
+    }
+}
+
+bool ulpTouchArm() {
+    const int rtcio = rtc_io_number_get((gpio_num_t)TOUCH_INT_PIN);
+    if (rtcio < 0) return false;
+    const uint32_t inBit = RTC_GPIO_IN_NEXT_S + rtcio;
+
+    // wakeFilterStep(), one sample per ULP timer wakeup
+    const ulp_insn_t program[] = {
+        I_MOVI(R3, ULP_DATA_WORD),
+        I_RD_REG(RTC_GPIO_IN_REG, inBit, inBit),   // R0 = line level
+        M_BGE(L_LINE_HIGH, 1),
+
+        // Low: count it if armed, wake at the confirmation count
+        I_LD(R0, R3, ULP_ARMED),
+        M_BL(L_DONE, 1),
+        I_LD(R0, R3, ULP_LOW_COUNT),
+        I_ADDI(R0, R0, 1),
+        I_ST(R0, R3, ULP_LOW_COUNT),
+        M_BL(L_DONE, WAKE_FILTER_CONFIRM_SAMPLES),
+        I_MOVI(R0, 0),
+        I_ST(R0, R3, ULP_ARMED),
+        I_ST(R0, R3, ULP_LOW_COUNT),
+        I_WAKE(),
+        M_BX(L_DONE),
+
+        // High: a pending low was a rejected pulse; arm
+        M_LABEL(L_LINE_HIGH),
+        I_LD(R0, R3, ULP_LOW_COUNT),
+        M_BL(L_SET_ARMED, 1),
+        I_LD(R0, R3, ULP_REJECTED),
+        M_BGE(L_SATURATED, WAKE_FILTER_COUNT_MAX),
+        I_ADDI(R0, R0, 1),
+        I_ST(R0, R3, ULP_REJECTED),
+        M_LABEL(L_SATURATED),
+        I_MOVI(R0, 0),
+        I_ST(R0, R3, ULP_LOW_COUNT),
+        M_LABEL(L_SET_ARMED),
+        I_MOVI(R0, 1),
+        I_ST(R0, R3, ULP_ARMED),
+
+        M_LABEL(L_DONE),
+        I_HALT(),
+    };
+    size_t size = sizeof(program) / sizeof(ulp_insn_t);
+    static_assert(sizeof(program) / sizeof(ulp_insn_t) <= ULP_PROG_MAX, "ULP program too large");
+
+    // Fresh filter; rejected counts accumulate
+    setDataWord(ULP_ARMED, 0);
+    setDataWord(ULP_LOW_COUNT, 0);
+
+    if (ulp_process_macros_and_load(ULP_PROG_WORD, program, &size) != ESP_OK) return false;
+    if (ulp_set_wakeup_period(0, WAKE_FILTER_PERIOD_US) != ESP_OK) return false;
+    if (ulp_run(ULP_PROG_WORD) != ESP_OK) return false;
+    if (esp_sleep_enable_ulp_wakeup() != ESP_OK) {
+        stopUlpTimer();
+        return false;
+    }
+    return true;
+}
+
+void ulpTouchNoteCpuReject() {
+    const uint32_t n = dataWord(ULP_CPU_REJECTED);
+    if (n < WAKE_FILTER_COUNT_MAX) setDataWord(ULP_CPU_REJECTED, n + 1);
+}
+
+uint32_t ulpTouchRejected() {
+    return dataWord(ULP_REJECTED);
+}
+
+uint32_t ulpTouchCpuRejected() {
+    return dataWord(ULP_CPU_REJECTED);
+}
+
+void ulpTouchPrint() {
+    Serial.printf("[PWR] touch wake filter: %lu pulses rejected by ULP, %lu boots rejected by CPU\n",
+                  (unsigned long)ulpTouchRejected(), (unsigned long)ulpTouchCpuRejected());
+}
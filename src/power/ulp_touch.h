@@ -0,0 +1,36 @@
+#pragma once
+
+// =============================================================================
+// ULP TOUCH - Touch INT debounce on the ULP while in deep sleep
+// =============================================================================
+// Instead of EXT0 waking the main cores on any low level of the touch INT
+// line, the ULP (FSM) samples it and only wakes them for a low that follows
+// a high and holds (wake_filter.h). Short pulses on the line are rejected
+// in the ULP at a few uA instead of a full boot each.
+//
+// The FT6336 is on non-RTC I2C pins, so the ULP can't read touch data -
+// powerValidateWake() still checks the finger over I2C after the wake.
+// Falls back to EXT0 when the program can't be loaded, or when INT is
+// still asserted at sleep entry (the filter could never arm).
+//
+// Counters live next to the program in RTC slow memory: they survive deep
+// sleep and reset on power-on.
+// =============================================================================
+
+#include <Arduino.h>
+
+// Early in boot (powerValidateWake()): stop the ULP, clear the counters
+// after a power-on
+void ulpTouchInit();
+
+// Load and start the filter for the coming deep sleep. False = use EXT0.
+bool ulpTouchArm();
+
+// A wake the main cores rejected anyway (powerValidateWake())
+void ulpTouchNoteCpuReject();
+
+// Low pulses the ULP rejected - each one a boot avoided
+uint32_t ulpTouchRejected();
+uint32_t ulpTouchCpuRejected();
+
+void ulpTouchPrint();
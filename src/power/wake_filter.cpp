@@ -0,0 +1,29 @@
+#include "wake_filter.h"
+
+void wakeFilterReset(WakeFilterState &s) {
+    s.armed = 0;
+    s.lowCount = 0;
+    // rejected accumulates across sleeps
+}
+
+WakeFilterResult wakeFilterStep(WakeFilterState &s, bool lineLow) {
+    if (!lineLow) {
+        if (s.lowCount > 0) {
+            // Released before confirmation
+            if (s.rejected < WAKE_FILTER_COUNT_MAX) s.rejected++;
+            s.lowCount = 0;
+        }
+        s.armed = 1;
+        return WAKE_FILTER_SLEEP;
+    }
+
+    if (!s.armed) return WAKE_FILTER_SLEEP;   // Asserted since sleep entry
+
+    s.lowCount++;
+    if (s.lowCount < WAKE_FILTER_CONFIRM_SAMPLES) return WAKE_FILTER_SLEEP;
+
+    // Disarm so the ULP doesn't keep waking a CPU that is already booting
+    s.armed = 0;
+    s.lowCount = 0;
+    return WAKE_FILTER_WAKE;
+}
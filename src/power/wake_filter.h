@@ -0,0 +1,41 @@
+#pragma once
+
+// =============================================================================
+// WAKE FILTER - Touch INT debounce for deep sleep wakes
+// =============================================================================
+// Pure C++ (no Arduino / IDF) - the reference for the ULP program in
+// ulp_touch.cpp, which runs exactly this per sample with the constants
+// below and WakeFilterState as its data words. Change both together;
+// tools/wake_filter_test checks this side on the host.
+//
+// The ULP samples the FT6336 INT line every WAKE_FILTER_PERIOD_US while the
+// main cores are in deep sleep:
+//   - A wake needs the line to have been seen HIGH first (armed). An INT
+//     left asserted at sleep entry never wakes on its own.
+//   - Then LOW for WAKE_FILTER_CONFIRM_SAMPLES consecutive samples.
+//   - A LOW that goes HIGH again before that is a rejected (spurious)
+//     pulse - counted, and the filter starts over.
+// =============================================================================
+
+#include <stdint.h>
+
+constexpr uint32_t WAKE_FILTER_PERIOD_US      = 20000;
+constexpr uint16_t WAKE_FILTER_CONFIRM_SAMPLES = 3;     // 40-60ms held low
+constexpr uint16_t WAKE_FILTER_COUNT_MAX       = 0xFFFF;  // ULP words hold 16 bits
+
+// Field order matches the ULP data words (ulp_touch.cpp)
+struct WakeFilterState {
+    uint16_t armed;        // Line seen high since the filter started
+    uint16_t lowCount;     // Consecutive low samples
+    uint16_t rejected;     // Low pulses that ended before confirmation
+};
+
+enum WakeFilterResult {
+    WAKE_FILTER_SLEEP,     // Keep sleeping
+    WAKE_FILTER_WAKE,      // Confirmed touch - wake the main cores
+};
+
+void wakeFilterReset(WakeFilterState &s);
+
+// One sample. lineLow = INT asserted.
+WakeFilterResult wakeFilterStep(WakeFilterState &s, bool lineLow);
@@ -0,0 +1,104 @@
+#include "boot_profiler.h"
+
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "trace.h"
+#include "../ble/diag_bytes.h"
+
+constexpr uint8_t SNAPSHOT_VERSION       = 1;
+constexpr UBaseType_t BOOT_TASK_PRIORITY = 1;   // Same as the loop task
+constexpr int BOOT_MAX_TASKS             = 4;
+
+static const char *const STAGE_NAMES[BOOT_STAGE_COUNT] = {
+    "power", "wake_check", "pmu", "display", "animation", "state",
+    "first_frame", "ble_stack", "advertising", "mic", "done",
+};
+
+static uint32_t s_stageUs[BOOT_STAGE_COUNT] = {0};
+static portMUX_TYPE s_bootMux = portMUX_INITIALIZER_UNLOCKED;
+
+static SemaphoreHandle_t s_taskDone = nullptr;
+static int s_tasksStarted = 0;
+
+static void bootTaskEntry(void *arg) {
+    void (*fn)() = reinterpret_cast<void (*)()>(arg);
+    fn();
+    xSemaphoreGive(s_taskDone);
+    vTaskDelete(nullptr);
+}
+
+static bool isDeepSleepWake() {
+    return esp_reset_reason() == ESP_RST_DEEPSLEEP;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void bootMark(BootStage stage) {
+    if (stage >= BOOT_STAGE_COUNT) return;
+    const uint32_t us = (uint32_t)esp_timer_get_time();
+    portENTER_CRITICAL(&s_bootMux);
+    if (s_stageUs[stage] == 0) s_stageUs[stage] = us ? us : 1;
+    portEXIT_CRITICAL(&s_bootMux);
+}
+
+uint32_t bootStageUs(BootStage stage) {
+    return stage < BOOT_STAGE_COUNT ? s_stageUs[stage] : 0;
+}
+
+void bootRunTask(const char *name, void (*fn)(), uint32_t stackBytes, BaseType_t core) {
+    if (!s_taskDone) s_taskDone = xSemaphoreCreateCounting(BOOT_MAX_TASKS, 0);
+    if (!s_taskDone || s_tasksStarted >= BOOT_MAX_TASKS ||
+        xTaskCreatePinnedToCore(bootTaskEntry, name, stackBytes, reinterpret_cast<void *>(fn),
+                                BOOT_TASK_PRIORITY, nullptr, core) != pdPASS) {
+        // No task - run it here, in order, as before
+        Serial.printf("[BOOT] %s inline\n", name);
+        fn();
+        return;
+    }
+    s_tasksStarted++;
+}
+
+void bootJoinTasks() {
+    for (; s_tasksStarted > 0; s_tasksStarted--) {
+        xSemaphoreTake(s_taskDone, portMAX_DELAY);
+    }
+}
+
+void bootProfilerReport() {
+    bootMark(BOOT_DONE);
+
+    const uint32_t advMs = s_stageUs[BOOT_ADVERTISING] / 1000;
+    const uint32_t frameMs = s_stageUs[BOOT_FIRST_FRAME] / 1000;
+    Serial.printf("[BOOT] %s: advertising %lums, first frame %lums, setup %lums\n",
+                  isDeepSleepWake() ? "deep sleep wake" : "cold boot",
+                  (unsigned long)advMs, (unsigned long)frameMs,
+                  (unsigned long)(s_stageUs[BOOT_DONE] / 1000));
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        if (!s_stageUs[i]) continue;
+        Serial.printf("[BOOT]   %-12s %6lums\n", STAGE_NAMES[i],
+                      (unsigned long)(s_stageUs[i] / 1000));
+    }
+    TRACE(TR_BOOT_READY, advMs, frameMs);
+}
+
+size_t bootProfilerSnapshot(uint8_t *buf, size_t cap) {
+    const size_t len = 4 + 3 + BOOT_STAGE_COUNT * 4;
+    if (!buf || cap < len) return 0;
+
+    uint8_t *p = buf;
+    p = putU8(p, SNAPSHOT_VERSION);
+    p = putU8(p, 0);
+    p = putU16(p, (uint16_t)len);
+    p = putU8(p, (uint8_t)esp_reset_reason());
+    p = putU8(p, (uint8_t)esp_sleep_get_wakeup_cause());
+    p = putU8(p, BOOT_STAGE_COUNT);
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) p = putU32(p, s_stageUs[i]);
+    return (size_t)(p - buf);
+}
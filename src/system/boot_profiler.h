@@ -0,0 +1,54 @@
+#pragma once
+
+// =============================================================================
+// BOOT PROFILER - Stage timestamps and parallel init tasks
+// =============================================================================
+// setup() marks each stage as it completes (esp_timer us since startup).
+// The stages that don't depend on each other run concurrently: the BLE
+// stack comes up on a core 0 task as soon as the RTC state is known, the
+// I2S driver installs on a second task, and the main task does PMU,
+// display and the boot animation meanwhile. bootJoinTasks() waits for both
+// before anything that needs them (BLE timers, the loop).
+//
+// The two numbers users feel are reported at the end of setup() for the
+// boot kind (cold / deep sleep wake): time to advertising and time to the
+// first usable frame. They also go to the trace ring (TR_BOOT_READY), so
+// the history of both kinds survives in a dump.
+// =============================================================================
+
+#include <Arduino.h>
+
+enum BootStage : uint8_t {
+    BOOT_POWER,          // Power manager, events, timer service
+    BOOT_WAKE_CHECK,     // Deep sleep wake validated, RTC state consumed
+    BOOT_PMU,            // PMU, RTC chip, wake interrupts
+    BOOT_DISPLAY,        // Panel initialized
+    BOOT_ANIMATION,      // Boot animation finished (cold boot only)
+    BOOT_STATE,          // State, time, battery, ledger
+    BOOT_FIRST_FRAME,    // Idle screen on the panel
+    BOOT_BLE_STACK,      // BLEDevice::init() done (boot task)
+    BOOT_ADVERTISING,    // Advertising started (boot task)
+    BOOT_MIC,            // I2S driver installed (boot task)
+    BOOT_DONE,           // setup() finished
+    BOOT_STAGE_COUNT
+};
+
+// Record a stage (any task). The first mark of a stage wins.
+void bootMark(BootStage stage);
+uint32_t bootStageUs(BootStage stage);   // 0 = not reached
+
+// Run fn on its own task (pinned to core), counted by bootJoinTasks()
+void bootRunTask(const char *name, void (*fn)(), uint32_t stackBytes, BaseType_t core);
+
+// Block until every bootRunTask() job has finished
+void bootJoinTasks();
+
+// Mark BOOT_DONE, print the stage table and trace the summary
+void bootProfilerReport();
+
+// Compact little-endian binary snapshot for the diagnostics characteristic.
+// Returns bytes written (0 if cap is too small). Layout (version 1):
+//   u8  version, u8 reserved, u16 length
+//   u8  reset_reason, u8 wake_cause (esp_reset_reason / esp_sleep_get_wakeup_cause)
+//   u8  stage_count, then u32 us per BootStage (0 = not reached)
+size_t bootProfilerSnapshot(uint8_t *buf, size_t cap);
@@ -0,0 +1,234 @@
+#include "clock_drift.h"
+
+#include <Preferences.h>
+#include <math.h>
+
+#include "../power/pm_locks.h"
+
+constexpr int DRIFT_MAX_SAMPLES          = 8;          // Least-squares window
+constexpr float DRIFT_TARGET_ERROR_S     = 2.0f;       // Predicted error bound
+constexpr uint32_t DRIFT_MIN_INTERVAL_S  = 60;
+constexpr uint32_t DRIFT_MAX_INTERVAL_S  = 6 * 3600;
+constexpr float DRIFT_MAX_GROWTH         = 2.0f;       // Per sync
+constexpr float DRIFT_MAX_PPM            = 5000.0f;    // Reject nonsense fits
+constexpr float DRIFT_PRIOR_INFLATE      = 2.0f;       // Temperature, aging
+constexpr float DRIFT_SIGMA_FLOOR_PPM    = 0.5f;
+constexpr float DRIFT_MIN_SPAN_S         = 30.0f;      // Shorter fits are noise
+constexpr float DRIFT_STEP_S             = 60.0f;      // Host clock stepped (TZ change)
+constexpr uint32_t DRIFT_SAVE_INTERVAL_MS = 30 * 60 * 1000;
+
+constexpr const char *DRIFT_PREF_NAMESPACE = "clkdrift";
+constexpr const char *DRIFT_PREF_MODEL_KEY = "model";
+constexpr uint8_t DRIFT_MODEL_VERSION = 1;
+
+struct DriftSample {
+    double localS;
+    double hostS;
+};
+
+struct DriftModel {
+    uint8_t version;
+    float ppm;
+    float sigmaPpm;               // <= 0 = unknown
+};
+
+static DriftSample s_samples[DRIFT_MAX_SAMPLES];
+static int s_count = 0;
+static int s_head = 0;            // Next slot to write
+
+static DriftModel s_prior = {DRIFT_MODEL_VERSION, 0.0f, 0.0f};
+static float s_ppm = 0.0f;
+static float s_sigmaPpm = 0.0f;
+static float s_noiseS = 0.5f;
+static float s_lastErrorS = 0.0f;
+static uint32_t s_intervalS = DRIFT_MIN_INTERVAL_S;
+static uint32_t s_lastSaveMs = 0;
+static bool s_dirty = false;
+
+// =============================================================================
+// Internal
+// =============================================================================
+
+static const DriftSample &sampleAt(int i) {
+    // Oldest first
+    const int start = s_count < DRIFT_MAX_SAMPLES ? 0 : s_head;
+    return s_samples[(start + i) % DRIFT_MAX_SAMPLES];
+}
+
+// Least squares of (host - local) offset against local time. Returns false
+// until the window spans enough time to say anything.
+static bool fitWindow(float sampleSigmaS, float *ppm, float *sigmaPpm) {
+    if (s_count < 2) return false;
+
+    const DriftSample &first = sampleAt(0);
+    const double offset0 = first.hostS - first.localS;
+    double sx = 0, sy = 0;
+    for (int i = 0; i < s_count; i++) {
+        const DriftSample &s = sampleAt(i);
+        sx += s.localS - first.localS;
+        sy += (s.hostS - s.localS) - offset0;
+    }
+    const double mx = sx / s_count;
+    const double my = sy / s_count;
+
+    double sxx = 0, sxy = 0;
+    for (int i = 0; i < s_count; i++) {
+        const DriftSample &s = sampleAt(i);
+        const double dx = (s.localS - first.localS) - mx;
+        const double dy = ((s.hostS - s.localS) - offset0) - my;
+        sxx += dx * dx;
+        sxy += dx * dy;
+    }
+    const double span = sampleAt(s_count - 1).localS - first.localS;
+    if (span < DRIFT_MIN_SPAN_S || sxx <= 0) return false;
+
+    const double slope = sxy / sxx;
+
+    // Noise: residual scatter, but never below what the sync reported
+    double noise = sampleSigmaS;
+    if (s_count > 2) {
+        double ss = 0;
+        for (int i = 0; i < s_count; i++) {
+            const DriftSample &s = sampleAt(i);
+            const double dx = (s.localS - first.localS) - mx;
+            const double r = ((s.hostS - s.localS) - offset0) - my - slope * dx;
+            ss += r * r;
+        }
+        const double rms = sqrt(ss / (s_count - 2));
+        if (rms > noise) noise = rms;
+    }
+
+    *ppm = (float)(slope * 1e6);
+    *sigmaPpm = (float)(noise / sqrt(sxx) * 1e6);
+    s_noiseS = (float)noise;
+    return fabsf(*ppm) <= DRIFT_MAX_PPM;
+}
+
+// Horizon at which noise + 2 sigma of drift reaches the target
+static uint32_t intervalForSigma(float sigmaPpm) {
+    if (sigmaPpm <= 0.0f) return DRIFT_MIN_INTERVAL_S;
+    const float budgetS = DRIFT_TARGET_ERROR_S - s_noiseS;
+    if (budgetS <= 0.0f) return DRIFT_MIN_INTERVAL_S;
+    const float horizonS = budgetS / (2.0f * sigmaPpm * 1e-6f);
+    if (horizonS >= DRIFT_MAX_INTERVAL_S) return DRIFT_MAX_INTERVAL_S;
+    if (horizonS <= DRIFT_MIN_INTERVAL_S) return DRIFT_MIN_INTERVAL_S;
+    return (uint32_t)horizonS;
+}
+
+static void saveModel() {
+    PmLockGuard flashLock(PM_LOCK_FLASH);
+    Preferences prefs;
+    if (!prefs.begin(DRIFT_PREF_NAMESPACE, false)) return;
+    const DriftModel model = {DRIFT_MODEL_VERSION, s_ppm, s_sigmaPpm};
+    prefs.putBytes(DRIFT_PREF_MODEL_KEY, &model, sizeof(model));
+    prefs.end();
+    s_lastSaveMs = millis();
+    s_dirty = false;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void clockDriftInit() {
+    s_count = 0;
+    s_head = 0;
+    s_prior = {DRIFT_MODEL_VERSION, 0.0f, 0.0f};
+
+    Preferences prefs;
+    if (prefs.begin(DRIFT_PREF_NAMESPACE, true)) {
+        DriftModel saved;
+        if (prefs.getBytesLength(DRIFT_PREF_MODEL_KEY) == sizeof(saved) &&
+            prefs.getBytes(DRIFT_PREF_MODEL_KEY, &saved, sizeof(saved)) == sizeof(saved) &&
+            saved.version == DRIFT_MODEL_VERSION && saved.sigmaPpm > 0.0f) {
+            s_prior = saved;
+            s_prior.sigmaPpm *= DRIFT_PRIOR_INFLATE;
+        }
+        prefs.end();
+    }
+
+    s_ppm = s_prior.ppm;
+    s_sigmaPpm = s_prior.sigmaPpm;
+    s_intervalS = intervalForSigma(s_sigmaPpm);
+    s_lastSaveMs = millis();
+    s_dirty = false;
+}
+
+void clockDriftAddSample(double localS, double hostS, float sigmaS) {
+    // How far off was the corrected clock? (needs a sync earlier this boot)
+    bool offPrediction = false;
+    double sinceLastS = 0;
+    if (s_count > 0) {
+        const DriftSample &last = sampleAt(s_count - 1);
+        sinceLastS = localS - last.localS;
+        const double predicted = last.hostS + sinceLastS * (1.0 + s_ppm * 1e-6);
+        s_lastErrorS = (float)(hostS - predicted);
+        offPrediction = fabsf(s_lastErrorS) > DRIFT_TARGET_ERROR_S;
+
+        if (fabsf(s_lastErrorS) > DRIFT_STEP_S) {
+            // Not drift - the host time itself jumped. Start a new window.
+            s_count = 0;
+            s_head = 0;
+            offPrediction = false;
+        }
+    }
+
+    s_samples[s_head] = {localS, hostS};
+    s_head = (s_head + 1) % DRIFT_MAX_SAMPLES;
+    if (s_count < DRIFT_MAX_SAMPLES) s_count++;
+
+    float fitPpm = 0.0f;
+    float fitSigma = 0.0f;
+    if (fitWindow(sigmaS, &fitPpm, &fitSigma)) {
+        if (fitSigma < DRIFT_SIGMA_FLOOR_PPM) fitSigma = DRIFT_SIGMA_FLOOR_PPM;
+        if (s_prior.sigmaPpm > 0.0f) {
+            // Inverse-variance blend with last boot's estimate
+            const float wPrior = 1.0f / (s_prior.sigmaPpm * s_prior.sigmaPpm);
+            const float wFit = 1.0f / (fitSigma * fitSigma);
+            s_ppm = (wPrior * s_prior.ppm + wFit * fitPpm) / (wPrior + wFit);
+            s_sigmaPpm = 1.0f / sqrtf(wPrior + wFit);
+        } else {
+            s_ppm = fitPpm;
+            s_sigmaPpm = fitSigma;
+        }
+        s_dirty = true;
+    }
+
+    uint32_t nextS = intervalForSigma(s_sigmaPpm);
+    if (offPrediction && sinceLastS > 0) {
+        // The model under-reported its error - widen it and back off
+        const float seenPpm = (float)(fabsf(s_lastErrorS) / sinceLastS * 1e6);
+        if (seenPpm > s_sigmaPpm) s_sigmaPpm = seenPpm;
+        const uint32_t halfS = s_intervalS / 2;
+        nextS = intervalForSigma(s_sigmaPpm);
+        if (nextS > halfS) nextS = halfS;
+    } else {
+        const uint32_t maxS = (uint32_t)(s_intervalS * DRIFT_MAX_GROWTH);
+        if (nextS > maxS) nextS = maxS;
+    }
+    if (nextS < DRIFT_MIN_INTERVAL_S) nextS = DRIFT_MIN_INTERVAL_S;
+    s_intervalS = nextS;
+
+    if (s_dirty && (millis() - s_lastSaveMs) >= DRIFT_SAVE_INTERVAL_MS) saveModel();
+}
+
+void clockDriftFlush() {
+    if (s_dirty) saveModel();
+}
+
+float clockDriftPpm() {
+    return s_ppm;
+}
+
+int64_t clockDriftCorrectMs(uint32_t elapsedMs) {
+    return (int64_t)elapsedMs + (int64_t)((double)elapsedMs * s_ppm * 1e-6);
+}
+
+uint32_t clockDriftResyncIntervalMs() {
+    return s_intervalS * 1000;
+}
+
+void clockDriftPrint() {
+    Serial.printf("[CLK] drift %+.1fppm (sigma %.1f) n=%d last err %+.2fs next sync %lus\n",
+                  s_ppm, s_sigmaPpm, s_count, s_lastErrorS, (unsigned long)s_intervalS);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// =============================================================================
+// CLOCK DRIFT - Local oscillator drift from successive host time syncs
+// =============================================================================
+// millis() runs off the main crystal while awake but off the calibrated RTC
+// slow clock in light sleep, so it gains or loses tens to hundreds of ppm.
+// Each host sync is a (local time, host time) sample; a least-squares line
+// over the recent samples gives the drift, which getCurrentEpoch() corrects.
+//
+// The slope's standard error bounds how fast the corrected clock can walk
+// away again, so the resync interval is the horizon at which the predicted
+// error reaches DRIFT_TARGET_ERROR_S - it grows from a minute toward hours
+// as the estimate tightens, and shrinks if a sync lands off-prediction.
+//
+// millis() restarts with every boot, so the fit is per boot. The result is
+// kept in NVS (inflated on load) as a prior for the next boot.
+// =============================================================================
+
+#include <Arduino.h>
+
+// Load the persisted drift estimate (call from timeSyncInit())
+void clockDriftInit();
+
+// A host sync: hostS (epoch seconds) observed at localS (esp_timer seconds
+// since boot), with sigmaS the standard deviation of its error - the fit's
+// noise floor. A protocol quantized to q seconds passes q / sqrt(12).
+void clockDriftAddSample(double localS, double hostS, float sigmaS);
+
+// Local clock drift, positive = local clock runs slow (host gains on it)
+float clockDriftPpm();
+
+// Apply the correction to an elapsed local interval
+int64_t clockDriftCorrectMs(uint32_t elapsedMs);
+
+// Interval until the predicted error reaches the target bound
+uint32_t clockDriftResyncIntervalMs();
+
+// Persist an unsaved estimate (before deep sleep)
+void clockDriftFlush();
+
+void clockDriftPrint();
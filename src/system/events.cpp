@@ -0,0 +1,108 @@
+#include "events.h"
+#include "timer_service.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+// =============================================================================
+// LOOP EVENTS
+// =============================================================================
+// POWER: Every return from eventWait() is a CPU wakeup. The old loop woke
+// 20x/s when active and 5x/s in light sleep just to poll. Now the loop only
+// wakes when something posts an event, the timer service fires, or a
+// short deadline (frame pacing while touched) expires.
+// =============================================================================
+
+// Task watchdog is 30s (see setup()) - never block longer than this
+constexpr uint32_t MAX_BLOCK_MS = 20000;
+constexpr uint32_t STATS_LOG_INTERVAL_MS = 60000;
+constexpr int POWER_STATE_COUNT = POWER_DEEP_SLEEP + 1;
+
+static EventGroupHandle_t s_events = nullptr;
+
+static LoopWakeStats s_stats[POWER_STATE_COUNT] = {};
+static uint32_t s_lastWaitReturnMs = 0;
+static uint32_t s_lastStatsLogMs = 0;
+
+void eventsInit() {
+    if (s_events) return;
+    s_events = xEventGroupCreate();
+
+    s_lastWaitReturnMs = millis();
+    s_lastStatsLogMs = s_lastWaitReturnMs;
+}
+
+void eventPost(uint32_t bits) {
+    if (!s_events) return;
+    xEventGroupSetBits(s_events, bits);
+}
+
+void eventPostFromISR(uint32_t bits) {
+    if (!s_events) return;
+    BaseType_t woken = pdFALSE;
+    xEventGroupSetBitsFromISR(s_events, bits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+uint32_t eventWait(uint32_t timeoutMs) {
+    if (!s_events) {
+        vTaskDelay(pdMS_TO_TICKS(timeoutMs < 50 ? timeoutMs : 50));
+        return 0;
+    }
+
+    const PowerState state = g_powerState;
+    const uint32_t enterMs = millis();
+    s_stats[state].busyMs += enterMs - s_lastWaitReturnMs;
+
+    if (timeoutMs > MAX_BLOCK_MS) timeoutMs = MAX_BLOCK_MS;
+    EventBits_t bits = xEventGroupWaitBits(s_events, EVT_ALL, pdTRUE, pdFALSE,
+                                           pdMS_TO_TICKS(timeoutMs));
+
+    const uint32_t returnMs = millis();
+    s_stats[state].blockedMs += returnMs - enterMs;
+    s_stats[state].wakeups++;
+    s_lastWaitReturnMs = returnMs;
+
+    return bits & EVT_ALL;
+}
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+const LoopWakeStats &eventsGetStats(PowerState state) {
+    return s_stats[state];
+}
+
+float eventsWakeupsPerMinute(PowerState state) {
+    const LoopWakeStats &s = s_stats[state];
+    uint32_t totalMs = s.blockedMs + s.busyMs;
+    if (totalMs == 0) return 0.0f;
+    return s.wakeups * 60000.0f / totalMs;
+}
+
+float eventsBlockedFraction(PowerState state) {
+    const LoopWakeStats &s = s_stats[state];
+    uint32_t totalMs = s.blockedMs + s.busyMs;
+    if (totalMs == 0) return 0.0f;
+    return (float)s.blockedMs / totalMs;
+}
+
+void eventsMaybeLogStats() {
+    uint32_t now = millis();
+    if (now - s_lastStatsLogMs < STATS_LOG_INTERVAL_MS) return;
+    s_lastStatsLogMs = now;
+
+    Serial.printf("[LOOP] wakeups/min active=%.1f dim=%.1f sleep=%.1f | blocked%% active=%.0f dim=%.0f sleep=%.0f\n",
+                  eventsWakeupsPerMinute(POWER_ACTIVE),
+                  eventsWakeupsPerMinute(POWER_DIMMED),
+                  eventsWakeupsPerMinute(POWER_LIGHT_SLEEP),
+                  eventsBlockedFraction(POWER_ACTIVE) * 100.0f,
+                  eventsBlockedFraction(POWER_DIMMED) * 100.0f,
+                  eventsBlockedFraction(POWER_LIGHT_SLEEP) * 100.0f);
+
+    const TimerServiceStats &ts = timerServiceGetStats();
+    Serial.printf("[LOOP] timers fired=%lu wakeups=%lu merged=%lu\n",
+                  (unsigned long)ts.fired, (unsigned long)ts.wakeups,
+                  (unsigned long)ts.merged);
+}
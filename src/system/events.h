@@ -0,0 +1,52 @@
+#pragma once
+
+// =============================================================================
+// LOOP EVENTS - Event group the main loop blocks on
+// =============================================================================
+// The main loop no longer polls on a fixed frame period. It blocks on a
+// FreeRTOS event group until an interrupt, BLE callback or timer posts an
+// event (or until a short deadline such as frame pacing expires).
+// Wakeup counts and blocked/busy time are kept per PowerState.
+// =============================================================================
+
+#include <Arduino.h>
+
+#include "../power/power_manager.h"
+
+// Event bits
+constexpr uint32_t EVT_TOUCH = (1u << 0);   // Touch INT asserted (ISR)
+constexpr uint32_t EVT_PMU   = (1u << 1);   // AXP2101 IRQ asserted (ISR)
+constexpr uint32_t EVT_BLE   = (1u << 2);   // GATT/GAP callback (connect, write)
+constexpr uint32_t EVT_TIMER = (1u << 3);   // Timer service wakeup (timer_service.h)
+constexpr uint32_t EVT_ALL   = EVT_TOUCH | EVT_PMU | EVT_BLE | EVT_TIMER;
+
+constexpr uint32_t EVENT_WAIT_FOREVER = 0xFFFFFFFFu;
+
+// Create the event group (call early in setup())
+void eventsInit();
+
+// Post events - task context / ISR context
+void eventPost(uint32_t bits);
+void eventPostFromISR(uint32_t bits);
+
+// Block until any event arrives or timeoutMs passes.
+// Returns the received bits (0 on timeout). Waits are capped below the
+// task watchdog timeout, so EVENT_WAIT_FOREVER still feeds the watchdog.
+uint32_t eventWait(uint32_t timeoutMs);
+
+// -----------------------------------------------------------------------------
+// Wakeup statistics (per PowerState, since boot)
+// -----------------------------------------------------------------------------
+
+struct LoopWakeStats {
+    uint32_t wakeups;     // Number of times the loop returned from eventWait()
+    uint32_t blockedMs;   // Time spent blocked in eventWait()
+    uint32_t busyMs;      // Time spent running loop work
+};
+
+const LoopWakeStats &eventsGetStats(PowerState state);
+float eventsWakeupsPerMinute(PowerState state);
+float eventsBlockedFraction(PowerState state);   // 0..1, light sleep opportunity
+
+// Print stats to Serial at most once per minute
+void eventsMaybeLogStats();
@@ -0,0 +1,212 @@
+#include "loop_profiler.h"
+
+#include <esp_cpu.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <string.h>
+
+#include "trace.h"
+#include "../ble/diag_bytes.h"
+
+constexpr uint8_t SNAPSHOT_VERSION       = 1;
+constexpr int HIST_BUCKETS               = 16;
+constexpr uint8_t HIST_BASE_SHIFT        = 6;      // Bucket 0: < 64us, last: >= ~1s
+constexpr int STALL_RING                 = 8;
+constexpr uint32_t STALL_LOG_INTERVAL_MS = 1000;   // Recording stalls every frame
+constexpr size_t STALL_RECORD_BYTES      = 13;
+
+static const char *const SECTION_NAMES[LOOP_SEC_COUNT] = {
+    "events", "wake", "timers", "power", "touch", "ble", "recording", "ui", "idle_prep",
+};
+
+struct SectionStats {
+    uint64_t totalUs;
+    uint64_t cycles;
+    uint32_t maxUs;
+};
+
+struct StallRecord {
+    uint32_t uptimeMs;
+    uint32_t iterUs;
+    uint8_t section;
+    uint32_t sectionUs;
+};
+
+// Current iteration (loop task only)
+static bool s_inIteration = false;
+static int64_t s_iterStartUs = 0;
+static int64_t s_markUs = 0;
+static uint32_t s_markCycles = 0;
+static uint32_t s_iterSectionUs[LOOP_SEC_COUNT];
+static uint32_t s_iterSectionCycles[LOOP_SEC_COUNT];
+
+// Accumulated - folded in at loopProfilerEnd(), read from the BTC task
+static portMUX_TYPE s_loopMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_iterations = 0;
+static uint32_t s_maxUs = 0;
+static uint32_t s_hist[HIST_BUCKETS] = {0};
+static SectionStats s_sections[LOOP_SEC_COUNT] = {};
+static StallRecord s_stalls[STALL_RING] = {};
+static uint32_t s_stallTotal = 0;
+static int s_stallHead = 0;   // Next slot to write
+static uint32_t s_lastStallLogMs = 0;
+
+static int bucketFor(uint32_t us) {
+    uint32_t edge = 1u << HIST_BASE_SHIFT;
+    for (int i = 0; i < HIST_BUCKETS - 1; i++) {
+        if (us < edge) return i;
+        edge <<= 1;
+    }
+    return HIST_BUCKETS - 1;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void loopProfilerBegin() {
+    s_iterStartUs = esp_timer_get_time();
+    s_markUs = s_iterStartUs;
+    s_markCycles = esp_cpu_get_ccount();
+    memset(s_iterSectionUs, 0, sizeof(s_iterSectionUs));
+    memset(s_iterSectionCycles, 0, sizeof(s_iterSectionCycles));
+    s_inIteration = true;
+}
+
+void loopProfilerMark(LoopSection section) {
+    if (!s_inIteration || section >= LOOP_SEC_COUNT) return;
+    const int64_t nowUs = esp_timer_get_time();
+    const uint32_t cycles = esp_cpu_get_ccount();
+    s_iterSectionUs[section] += (uint32_t)(nowUs - s_markUs);
+    s_iterSectionCycles[section] += cycles - s_markCycles;   // Wraps at most once
+    s_markUs = nowUs;
+    s_markCycles = cycles;
+}
+
+void loopProfilerEnd() {
+    if (!s_inIteration) return;
+    s_inIteration = false;
+    const uint32_t iterUs = (uint32_t)(esp_timer_get_time() - s_iterStartUs);
+
+    uint8_t worst = 0;
+    for (int i = 1; i < LOOP_SEC_COUNT; i++) {
+        if (s_iterSectionUs[i] > s_iterSectionUs[worst]) worst = (uint8_t)i;
+    }
+    const bool stall = iterUs >= LOOP_STALL_BUDGET_MS * 1000;
+
+    portENTER_CRITICAL(&s_loopMux);
+    s_iterations++;
+    if (iterUs > s_maxUs) s_maxUs = iterUs;
+    s_hist[bucketFor(iterUs)]++;
+    for (int i = 0; i < LOOP_SEC_COUNT; i++) {
+        SectionStats &s = s_sections[i];
+        s.totalUs += s_iterSectionUs[i];
+        s.cycles += s_iterSectionCycles[i];
+        if (s_iterSectionUs[i] > s.maxUs) s.maxUs = s_iterSectionUs[i];
+    }
+    if (stall) {
+        s_stalls[s_stallHead] = {(uint32_t)millis(), iterUs, worst, s_iterSectionUs[worst]};
+        s_stallHead = (s_stallHead + 1) % STALL_RING;
+        s_stallTotal++;
+    }
+    portEXIT_CRITICAL(&s_loopMux);
+    if (stall) TRACE(TR_LOOP_STALL, iterUs, worst);
+
+    if (stall && (millis() - s_lastStallLogMs) >= STALL_LOG_INTERVAL_MS) {
+        s_lastStallLogMs = millis();
+        Serial.printf("[LOOP] stall %lums, %s %lums (total %lu)\n",
+                      (unsigned long)(iterUs / 1000), SECTION_NAMES[worst],
+                      (unsigned long)(s_iterSectionUs[worst] / 1000),
+                      (unsigned long)s_stallTotal);
+    }
+}
+
+uint32_t loopProfilerStalls() {
+    return s_stallTotal;
+}
+
+uint32_t loopProfilerMaxUs() {
+    return s_maxUs;
+}
+
+size_t loopProfilerSnapshot(uint8_t *buf, size_t cap) {
+    const size_t fixedLen = 4 + 8 + 2 + HIST_BUCKETS * 4 + 1 + LOOP_SEC_COUNT * 12 + 4 + 1;
+    if (!buf || cap < fixedLen) return 0;
+
+    portENTER_CRITICAL(&s_loopMux);
+    const uint32_t iterations = s_iterations;
+    const uint32_t maxUs = s_maxUs;
+    const uint32_t stallTotal = s_stallTotal;
+    const int stallHead = s_stallHead;
+    uint32_t hist[HIST_BUCKETS];
+    memcpy(hist, s_hist, sizeof(hist));
+    SectionStats sections[LOOP_SEC_COUNT];
+    memcpy(sections, s_sections, sizeof(sections));
+    StallRecord stalls[STALL_RING];
+    memcpy(stalls, s_stalls, sizeof(stalls));
+    portEXIT_CRITICAL(&s_loopMux);
+
+    // As many recent stalls as fit
+    int stallCount = stallTotal < STALL_RING ? (int)stallTotal : STALL_RING;
+    const int fit = (int)((cap - fixedLen) / STALL_RECORD_BYTES);
+    if (stallCount > fit) stallCount = fit;
+    const size_t len = fixedLen + stallCount * STALL_RECORD_BYTES;
+
+    uint8_t *p = buf;
+    p = putU8(p, SNAPSHOT_VERSION);
+    p = putU8(p, 0);
+    p = putU16(p, (uint16_t)len);
+    p = putU32(p, iterations);
+    p = putU32(p, maxUs);
+    p = putU8(p, HIST_BUCKETS);
+    p = putU8(p, HIST_BASE_SHIFT);
+    for (int i = 0; i < HIST_BUCKETS; i++) p = putU32(p, hist[i]);
+    p = putU8(p, LOOP_SEC_COUNT);
+    for (int i = 0; i < LOOP_SEC_COUNT; i++) {
+        const uint64_t totalUs = sections[i].totalUs;
+        const uint64_t kcycles = sections[i].cycles / 1000;
+        p = putU32(p, totalUs > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)totalUs);
+        p = putU32(p, sections[i].maxUs);
+        p = putU32(p, kcycles > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)kcycles);
+    }
+    p = putU32(p, stallTotal);
+    p = putU8(p, (uint8_t)stallCount);
+    for (int i = 0; i < stallCount; i++) {
+        const StallRecord &s = stalls[(stallHead - 1 - i + STALL_RING) % STALL_RING];
+        p = putU32(p, s.uptimeMs);
+        p = putU32(p, s.iterUs);
+        p = putU8(p, s.section);
+        p = putU32(p, s.sectionUs);
+    }
+    return (size_t)(p - buf);
+}
+
+void loopProfilerPrint() {
+    Serial.printf("[LOOP] iterations=%lu max=%lums stalls=%lu (>%lums)\n",
+                  (unsigned long)s_iterations, (unsigned long)(s_maxUs / 1000),
+                  (unsigned long)s_stallTotal, (unsigned long)LOOP_STALL_BUDGET_MS);
+
+    Serial.print("[LOOP] hist");
+    uint32_t edge = 1u << HIST_BASE_SHIFT;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        if (s_hist[i]) {
+            if (i < HIST_BUCKETS - 1) {
+                Serial.printf(" <%lu:%lu", (unsigned long)edge, (unsigned long)s_hist[i]);
+            } else {
+                Serial.printf(" >=%lu:%lu", (unsigned long)(edge >> 1), (unsigned long)s_hist[i]);
+            }
+        }
+        edge <<= 1;
+    }
+    Serial.println("us");
+
+    for (int i = 0; i < LOOP_SEC_COUNT; i++) {
+        const SectionStats &s = s_sections[i];
+        if (!s.totalUs) continue;
+        Serial.printf("[LOOP] %-10s total=%lums max=%luus avg=%luus %lluMcyc\n",
+                      SECTION_NAMES[i], (unsigned long)(s.totalUs / 1000),
+                      (unsigned long)s.maxUs,
+                      (unsigned long)(s_iterations ? s.totalUs / s_iterations : 0),
+                      (unsigned long long)(s.cycles / 1000000));
+    }
+}
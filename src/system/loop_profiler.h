@@ -0,0 +1,60 @@
+#pragma once
+
+// =============================================================================
+// LOOP PROFILER - Iteration latency histogram, per-section cost, stalls
+// =============================================================================
+// loop() brackets each iteration with loopProfilerBegin() / loopProfilerEnd()
+// and calls loopProfilerMark(section) after each block of work; the time
+// since the previous mark is charged to that section. The wait in
+// eventWait() is outside the iteration.
+//
+// Two clocks per mark: CCOUNT (cycles - CPU work, cheap, but it stops in
+// light sleep and scales with the DFS frequency) and esp_timer (wall time -
+// what a delay() or a blocking i2s_read() actually costs in latency).
+// Histogram and stalls use wall time.
+//
+// An iteration over LOOP_STALL_BUDGET_MS is a stall: it is kept in a small
+// ring with the section that took the longest.
+// =============================================================================
+
+#include <Arduino.h>
+
+// Sections in loop() order - the snapshot layout depends on this order
+enum LoopSection : uint8_t {
+    LOOP_SEC_EVENTS,      // Interrupt event dispatch + deferred BLE work
+    LOOP_SEC_WAKE,        // Light sleep wake handler
+    LOOP_SEC_TIMERS,      // timerServiceDispatch()
+    LOOP_SEC_POWER,       // powerUpdate, current model, energy ledger
+    LOOP_SEC_TOUCH,
+    LOOP_SEC_BLE,         // Pending text, CTS, OTA
+    LOOP_SEC_RECORDING,   // updateRecording() (i2s_read)
+    LOOP_SEC_UI,          // Time request, screen state machine, overlays
+    LOOP_SEC_IDLE_PREP,   // Wake rearm, stats logging before the wait
+    LOOP_SEC_COUNT
+};
+
+constexpr uint32_t LOOP_STALL_BUDGET_MS = 50;
+
+// Called from loop() only
+void loopProfilerBegin();
+void loopProfilerMark(LoopSection section);
+void loopProfilerEnd();
+
+uint32_t loopProfilerStalls();
+uint32_t loopProfilerMaxUs();
+
+// Compact little-endian binary snapshot for the diagnostics characteristic.
+// Returns bytes written (0 if cap is too small). Layout (version 1):
+//   u8  version, u8 reserved, u16 length
+//   u32 iterations, u32 max_us
+//   u8  bucket_count, u8 base_shift   bucket 0 < 2^base_shift us, each
+//                                     next doubles, the last is open-ended
+//   u32 buckets[bucket_count]
+//   u8  section_count, then per section: u32 total_us, u32 max_us, u32 kcycles
+//   u32 stalls_total
+//   u8  stall_count, then newest first: u32 uptime_ms, u32 iter_us,
+//       u8 worst_section, u32 worst_section_us
+size_t loopProfilerSnapshot(uint8_t *buf, size_t cap);
+
+// Human readable dump to Serial (powerPrintDiagnostics())
+void loopProfilerPrint();
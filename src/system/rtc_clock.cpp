@@ -0,0 +1,113 @@
+#include "rtc_clock.h"
+
+#include <Wire.h>
+
+#include "../hardware_config.h"
+#include "time_sync.h"
+
+constexpr uint8_t PCF8563_ADDR = 0x51;
+
+// Registers
+constexpr uint8_t REG_CTRL2      = 0x01;
+constexpr uint8_t REG_SECONDS    = 0x02;   // 0x02..0x08 time/date
+constexpr uint8_t REG_CLKOUT     = 0x0D;
+constexpr uint8_t REG_TIMER_CTRL = 0x0E;
+
+constexpr uint8_t TIMER_SRC_1_60HZ = 0x03;   // Timer control source, enable bit clear
+
+constexpr uint8_t SECONDS_VL = 0x80;      // Clock integrity lost
+constexpr int RTC_BASE_YEAR  = 2000;
+
+static bool s_present = false;
+
+// =============================================================================
+// Internal: Register access
+// =============================================================================
+
+static bool writeRegs(uint8_t reg, const uint8_t *data, size_t len) {
+    Wire.beginTransmission(PCF8563_ADDR);
+    Wire.write(reg);
+    Wire.write(data, len);
+    return Wire.endTransmission() == 0;
+}
+
+static bool writeReg(uint8_t reg, uint8_t value) {
+    return writeRegs(reg, &value, 1);
+}
+
+static bool readRegs(uint8_t reg, uint8_t *data, size_t len) {
+    Wire.beginTransmission(PCF8563_ADDR);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) != 0) return false;
+    if (Wire.requestFrom(PCF8563_ADDR, (uint8_t)len) != len) return false;
+    for (size_t i = 0; i < len; i++) data[i] = Wire.read();
+    return true;
+}
+
+static uint8_t bcdToBin(uint8_t v) { return (v >> 4) * 10 + (v & 0x0F); }
+static uint8_t binToBcd(uint8_t v) { return ((v / 10) << 4) | (v % 10); }
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+bool rtcClockInit() {
+    pinMode(RTC_INT_PIN, INPUT_PULLUP);
+
+    uint8_t ctrl2 = 0;
+    s_present = readRegs(REG_CTRL2, &ctrl2, 1);
+    if (!s_present) {
+        Serial.println("[RTC] PCF8563 not found");
+        return false;
+    }
+
+    // POWER: CLKOUT defaults to 32.768kHz on an unused pin
+    writeReg(REG_CLKOUT, 0x00);
+    // Timers/alarms armed before the reset are stale - a set flag would
+    // hold RTC_INT low
+    writeReg(REG_CTRL2, 0x00);
+    writeReg(REG_TIMER_CTRL, TIMER_SRC_1_60HZ);   // Timer off, lowest-power source
+
+    Serial.printf("[RTC] PCF8563 ready, epoch=%ld\n", (long)rtcClockRead());
+    return true;
+}
+
+bool rtcClockPresent() {
+    return s_present;
+}
+
+time_t rtcClockRead() {
+    if (!s_present) return 0;
+
+    uint8_t r[7];
+    if (!readRegs(REG_SECONDS, r, sizeof(r))) return 0;
+    if (r[0] & SECONDS_VL) return 0;
+
+    const int sec   = bcdToBin(r[0] & 0x7F);
+    const int min   = bcdToBin(r[1] & 0x7F);
+    const int hour  = bcdToBin(r[2] & 0x3F);
+    const int day   = bcdToBin(r[3] & 0x3F);
+    const int month = bcdToBin(r[5] & 0x1F);
+    const int year  = RTC_BASE_YEAR + bcdToBin(r[6]);
+    return epochFromCivil(year, month, day, hour, min, sec);
+}
+
+bool rtcClockWrite(time_t epoch) {
+    if (!s_present || epoch <= 0) return false;
+
+    tm t;
+    if (!gmtime_r(&epoch, &t)) return false;
+    const int year = t.tm_year + 1900;
+    if (year < RTC_BASE_YEAR || year > RTC_BASE_YEAR + 99) return false;
+
+    const uint8_t r[7] = {
+        binToBcd((uint8_t)t.tm_sec),   // Writing seconds clears VL
+        binToBcd((uint8_t)t.tm_min),
+        binToBcd((uint8_t)t.tm_hour),
+        binToBcd((uint8_t)t.tm_mday),
+        (uint8_t)t.tm_wday,
+        binToBcd((uint8_t)(t.tm_mon + 1)),
+        binToBcd((uint8_t)(year - RTC_BASE_YEAR)),
+    };
+    return writeRegs(REG_SECONDS, r, sizeof(r));
+}
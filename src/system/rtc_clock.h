@@ -0,0 +1,33 @@
+#pragma once
+
+// =============================================================================
+// RTC CLOCK - PCF8563 on the shared I2C bus
+// =============================================================================
+// The PCF8563 runs from the backup supply and keeps counting through deep
+// sleep and resets, so it is the authoritative wall clock: read at boot,
+// written on every host time sync.
+//
+// Its timer and alarm are left off: scheduled wakes (headless_sync.h) use
+// the ESP32 RTC timer. RTC_INT_PIN is only pulled up so a flag left set
+// before a reset can't hold it low.
+//
+// The chip stores whatever epoch the host sent (it already includes the
+// host's UTC offset), 2000-2099.
+// =============================================================================
+
+#include <Arduino.h>
+#include <time.h>
+
+// Probe the chip (Wire must already be up - initPMU() starts it).
+// Disables CLKOUT and the timer/alarm interrupts.
+bool rtcClockInit();
+
+// Chip answered on the bus
+bool rtcClockPresent();
+
+// Current epoch, 0 if the chip is absent or lost its time (VL flag set
+// after the backup supply dropped out)
+time_t rtcClockRead();
+
+// Set the clock (clears the VL flag)
+bool rtcClockWrite(time_t epoch);
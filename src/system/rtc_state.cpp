@@ -0,0 +1,73 @@
+#include "rtc_state.h"
+
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_rom_crc.h>
+#include <esp_private/esp_clk.h>
+#include <string.h>
+
+constexpr uint32_t RTC_STATE_MAGIC   = 0x484C5752;   // "HLWR"
+constexpr uint16_t RTC_STATE_VERSION = 4;
+
+// RTC slow memory, not touched by the startup code
+RTC_NOINIT_ATTR static RtcStateBlock s_block;
+
+static bool s_resumed = false;
+static uint32_t s_deepSleepS = 0;
+
+static uint32_t blockCrc() {
+    return esp_rom_crc32_le(0, (const uint8_t *)&s_block, offsetof(RtcStateBlock, crc));
+}
+
+bool rtcStateInit() {
+    const bool valid = esp_reset_reason() == ESP_RST_DEEPSLEEP &&
+                       s_block.magic == RTC_STATE_MAGIC &&
+                       s_block.version == RTC_STATE_VERSION &&
+                       s_block.size == sizeof(RtcStateBlock) &&
+                       s_block.crc == blockCrc();
+
+    if (valid) {
+        // RTC timer now = sleep entry + deep sleep + time since the wake
+        const uint64_t nowUs = esp_clk_rtc_time();
+        const uint64_t sinceUs = nowUs > s_block.time.rtcUsAtSleep
+                                     ? nowUs - s_block.time.rtcUsAtSleep : 0;
+        const uint64_t bootUs = (uint64_t)millis() * 1000;
+        s_deepSleepS = sinceUs > bootUs ? (uint32_t)((sinceUs - bootUs) / 1000000) : 0;
+        s_resumed = true;
+
+        Serial.printf("[RTC] resumed after %lus deep sleep (#%lu)\n",
+                      (unsigned long)s_deepSleepS, (unsigned long)s_block.deepSleepCount);
+    } else {
+        memset(&s_block, 0, sizeof(s_block));
+        s_resumed = false;
+        s_deepSleepS = 0;
+    }
+
+    // Consumed - only the next rtcStateSeal() makes it valid again
+    s_block.magic = RTC_STATE_MAGIC;
+    s_block.version = RTC_STATE_VERSION;
+    s_block.size = sizeof(RtcStateBlock);
+    s_block.crc = ~blockCrc();
+    return s_resumed;
+}
+
+bool rtcStateResumed() {
+    return s_resumed;
+}
+
+RtcStateBlock &rtcState() {
+    return s_block;
+}
+
+uint32_t rtcStateDeepSleepSeconds() {
+    return s_deepSleepS;
+}
+
+void rtcStateSeal() {
+    s_block.magic = RTC_STATE_MAGIC;
+    s_block.version = RTC_STATE_VERSION;
+    s_block.size = sizeof(RtcStateBlock);
+    s_block.deepSleepCount++;
+    s_block.time.rtcUsAtSleep = esp_clk_rtc_time();
+    s_block.crc = blockCrc();
+}
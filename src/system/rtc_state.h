@@ -0,0 +1,78 @@
+#pragma once
+
+// =============================================================================
+// RTC STATE - Small checksummed block retained across deep sleep
+// =============================================================================
+// Lives in RTC slow memory (kept powered in deep sleep). Modules fill their
+// part just before deep sleep and read it back during setup(), so a deep
+// sleep wake resumes instead of rebuilding everything from scratch.
+//
+// The block is only trusted after a deep sleep reset with a valid magic,
+// version, size and CRC; anything else (power-on, crash, new firmware
+// layout) starts clean. It is consumed on boot, so a later crash reset
+// never resurrects stale state.
+// =============================================================================
+
+#include <Arduino.h>
+
+constexpr size_t RTC_ANSWER_MAX = 768;   // Longer answers are not resumed
+
+struct RtcTimeState {
+    int64_t epochAtSleep;         // 0 = no host time
+    uint64_t rtcUsAtSleep;        // RTC timer keeps counting in deep sleep
+};
+
+struct RtcBatteryState {
+    int16_t percent;
+    int16_t smoothedPercent;
+    int16_t reportedPercent;
+    int16_t voltageSamples[4];
+};
+
+struct RtcBleHint {
+    uint8_t peerBda[6];           // Last connected peer
+    uint8_t peerValid;
+    uint8_t wasConnected;         // Link was up when we went to sleep
+};
+
+struct RtcSyncState {
+    uint64_t nextSyncRtcUs;       // Headless sync wake (RTC timer), 0 = none
+    uint8_t handOff;              // Next timer wake is a full boot (user input)
+    uint8_t missed;               // Headless syncs in a row with no peer
+    uint16_t reserved;
+    uint32_t syncCount;           // Headless boots since power-on
+};
+
+struct RtcUiState {
+    uint16_t answerLen;           // 0 = none (or too long to keep)
+    char answer[RTC_ANSWER_MAX];
+};
+
+struct RtcStateBlock {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t deepSleepCount;
+    RtcTimeState time;
+    RtcBatteryState battery;
+    RtcBleHint ble;
+    RtcSyncState sync;
+    RtcUiState ui;
+    uint32_t crc;                 // Over everything above
+};
+
+// Validate the retained block (call first thing in setup(), after
+// powerValidateWake()). Returns true if this boot resumes a deep sleep.
+bool rtcStateInit();
+
+// Valid block from the deep sleep this boot woke from
+bool rtcStateResumed();
+
+// The block - read during init when resumed, write before deep sleep
+RtcStateBlock &rtcState();
+
+// Seconds spent in deep sleep (RTC timer), 0 if not resumed
+uint32_t rtcStateDeepSleepSeconds();
+
+// Checksum the block - call right before esp_deep_sleep_start()
+void rtcStateSeal();
@@ -7,6 +7,12 @@
 #include "../ble/ble_core.h"
 #include "../system/sleep.h"
 #include "../ui/ui_wait.h"
+#include "timer_service.h"
+#include "rtc_state.h"
+#include "time_sync.h"
+#include "trace.h"
+
+constexpr uint32_t WAITING_TIMEOUT_SLACK_MS = 5000;
 
 UIState currentState   = IDLE;
 UIState lastDrawnState = (UIState)999;
@@ -30,6 +36,27 @@ uint32_t g_waitingStartMs = 0;  // Track when we started waiting
 void initState() {
     g_lastActivityMs = millis();
     g_waitingStartMs = 0;
+
+    // Deep sleep wake: bring back the last answer (the UI still wakes to home)
+    if (rtcStateResumed()) {
+        const RtcUiState &saved = rtcState().ui;
+        if (saved.answerLen > 0 && saved.answerLen < RTC_ANSWER_MAX &&
+            saved.answer[saved.answerLen] == '\0') {
+            g_lastText = saved.answer;
+        }
+    }
+}
+
+void statePrepareDeepSleep() {
+    RtcUiState &saved = rtcState().ui;
+    const size_t len = g_lastText.length();
+    if (len > 0 && len < RTC_ANSWER_MAX) {
+        memcpy(saved.answer, g_lastText.c_str(), len + 1);
+        saved.answerLen = (uint16_t)len;
+    } else {
+        saved.answer[0] = '\0';
+        saved.answerLen = 0;
+    }
 }
 
 void finalizeRecordingTimer() {
@@ -41,14 +68,21 @@ void startRecording() {
     if (!canSendControlMessages()) return;
     markActivity();
     startMic();
+    const int64_t startUtcMs = getCurrentUtcMs();   // First sample, host clock in UTC
     clearRecordingBuffer();
     setRecordingActive(true);
     g_recordingInProgress = true;
     g_recordingStartMs = millis();
     g_waitingStartMs = 0;  // Clear waiting timestamp
     currentState = RECORDING;
+    TRACE(TR_RECORDING, 1, 0);
     ima_reset_state();
     bleSendControlMessage("START_V");
+    if (startUtcMs > 0) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "START_TS:%lld", (long long)startUtcMs);
+        bleSendControlMessage(buf);
+    }
 }
 
 void stopRecording() {
@@ -57,6 +91,7 @@ void stopRecording() {
     g_recordingInProgress = false;
     setRecordingActive(false);
     finalizeRecordingTimer();
+    TRACE(TR_RECORDING, 0, g_recorded_adpcm.size());
     resetWaitingAnimation();
     bool bleReady = canSendControlMessages();
     if (bleReady) {
@@ -69,7 +104,8 @@ void stopRecording() {
     }
 }
 
-// Call from main loop to timeout waiting states
+// Timeout waiting states - re-arms itself on the timer service until the
+// wait ends or times out
 void checkWaitingTimeout() {
     if (currentState != WAITING_ANSWER && currentState != WAITING_TIME) {
         return;
@@ -77,7 +113,6 @@ void checkWaitingTimeout() {
 
     if (g_waitingStartMs == 0) {
         g_waitingStartMs = millis();  // Safety: start timing if not set
-        return;
     }
 
     uint32_t elapsed = millis() - g_waitingStartMs;
@@ -85,5 +120,9 @@ void checkWaitingTimeout() {
         currentState = IDLE;
         g_waitingStartMs = 0;
         markActivity();
+        return;
     }
+
+    timerStart(TIMER_WAITING_TIMEOUT, checkWaitingTimeout,
+               WAITING_ANSWER_TIMEOUT_MS - elapsed, WAITING_TIMEOUT_SLACK_MS);
 }
@@ -29,7 +29,8 @@ extern uint32_t g_waitingStartMs;  // When we entered WAITING_ANSWER state
 constexpr uint32_t WAITING_ANSWER_TIMEOUT_MS = 30000;
 
 void initState();
+void statePrepareDeepSleep();   // Last answer into RTC memory (rtc_state.h)
 void startRecording();
 void stopRecording();
 void finalizeRecordingTimer();
-void checkWaitingTimeout();  // Call from main loop to timeout waiting states
+void checkWaitingTimeout();  // Call on entering a waiting state - arms its own timeout
@@ -3,19 +3,40 @@
 #include <time.h>
 #include <cstdlib>
 #include <cstdio>
+#include <math.h>
 #include <Preferences.h>
+#include <esp_timer.h>
 
 #include "../hardware_config.h"
-#include "../ble/ble_core.h"
 #include "../ble/ble_audio.h"
+#include "../ble/ble_transport.h"
+#include "../ble/ble_cts.h"
 #include "../system/state.h"
 #include "../system/sleep.h"
+#include "../system/rtc_state.h"
+#include "../system/rtc_clock.h"
+#include "../system/clock_drift.h"
+#include "../power/sleep_policy.h"
+#include "../power/battery_policy.h"
+#include "../power/energy_ledger.h"
+#include "../system/timer_service.h"
+#include "../power/power_manager.h"
+#include "../power/pm_locks.h"
 #include "../ui/ui_common.h"
 #include "../ui/ui_wait.h"
+#include "trace.h"
 
 constexpr uint32_t TIME_REQ_RETRY_MS     = 7000;
 constexpr uint8_t TIME_REQ_MAX_ATTEMPTS  = 5;
-constexpr uint32_t TIME_RESYNC_PERIOD_MS = 60000;
+constexpr uint32_t TIME_SYNC_AGE_CAP_MS  = 24UL * 60 * 60 * 1000;   // "Long ago" for scheduling
+constexpr float TIME_SYNC_RESOLUTION_S   = 1.0f;    // TIME:<epoch> is whole seconds
+constexpr uint8_t TIME_MS_FALLBACK_ATTEMPTS = 2;    // Unanswered REQ_TIMEMS -> legacy REQ_TIME
+constexpr uint8_t TIME_MS_BURST_MAX      = 4;       // Exchanges before taking the best one
+constexpr uint32_t TIME_MS_GOOD_DELAY_MS = 100;     // Acceptable with no history
+constexpr uint32_t TIME_MS_DELAY_MARGIN_MS = 20;
+constexpr int64_t TIME_MS_MAX_RTT_US     = 10LL * 1000 * 1000;   // Older echoes are stale
+constexpr uint32_t TIME_REQ_RETRY_SLACK_MS = 2000;
+constexpr uint32_t TIME_RESYNC_SLACK_MS  = 15000;
 constexpr uint32_t TIME_PERSIST_INTERVAL_MS = 15 * 60 * 1000;  // Limit NVS writes
 constexpr const char *TIME_PREF_NAMESPACE = "time";
 constexpr const char *TIME_PREF_EPOCH_KEY = "epoch";
@@ -29,7 +50,24 @@ uint32_t g_lastTimeRequestMs = 0;
 uint32_t g_lastTimeSyncMs = 0;
 static Preferences g_timePrefs;
 static bool g_timePrefsReady = false;
+static uint32_t s_lastHostSyncMs = 0;     // Resync schedule (may predate this boot)
+static bool s_rtcClockValid = false;      // PCF8563 holds a host-set time
 static uint32_t g_lastPersistMs = 0;
+static uint16_t s_buildEpochFracMs = 0;   // Sub-second part of the g_buildEpoch anchor
+
+// NTP-style exchange (REQ_TIMEMS / TIMEMS) - per connection
+enum HostTimeMode : uint8_t { HOST_TIME_UNKNOWN, HOST_TIME_MS, HOST_TIME_LEGACY };
+static HostTimeMode s_hostTimeMode = HOST_TIME_UNKNOWN;
+static uint32_t s_minDelayMs = 0xFFFFFFFFu;   // Best round trip seen on this link
+static uint8_t s_burstCount = 0;
+static uint8_t s_timeMsAttempts = 0;          // REQ_TIMEMS sent, unanswered (CTS reads not counted)
+static int64_t s_burstBestOffsetMs = 0;       // host epoch ms - local ms
+static int64_t s_burstBestLocalUs = 0;        // t4 of the best exchange
+static uint32_t s_burstBestDelayMs = 0xFFFFFFFFu;
+static int32_t s_burstTzOffsetS = 0;
+static int32_t s_hostTzOffsetS = 0;           // Local - UTC, from the last TIMEMS sync
+static bool s_haveTzOffset = false;
+static uint32_t s_lastDelayMs = 0;
 
 static void persistTimeState(bool force) {
     if (!g_timePrefsReady || g_buildEpoch <= 0) return;
@@ -38,6 +76,7 @@ static void persistTimeState(bool force) {
         (now - g_lastPersistMs) < TIME_PERSIST_INTERVAL_MS) {
         return;
     }
+    PmLockGuard flashLock(PM_LOCK_FLASH);
     g_timePrefs.putLong64(TIME_PREF_EPOCH_KEY, static_cast<int64_t>(g_buildEpoch));
     g_timePrefs.putUInt(TIME_PREF_MS_KEY, g_lastTimeSyncMs);
     g_lastPersistMs = now;
@@ -53,6 +92,7 @@ static void loadStoredTime() {
     g_buildEpoch = static_cast<time_t>(savedEpoch);
     g_haveHostTime = true;
     g_lastTimeSyncMs = nowMs;
+    s_lastHostSyncMs = nowMs;
 
     if (savedMs > 0 && nowMs > savedMs) {
         g_buildEpoch += static_cast<time_t>((nowMs - savedMs) / 1000);
@@ -62,36 +102,107 @@ static void loadStoredTime() {
     uiInvalidateClock();
 }
 
+// Deep sleep wake: the RTC timer kept counting, so the clock is exact
+static bool restoreRtcTime() {
+    if (!rtcStateResumed()) return false;
+    const RtcTimeState &saved = rtcState().time;
+    if (saved.epochAtSleep <= 0) return false;
+
+    const uint32_t nowMs = millis();
+    g_buildEpoch = static_cast<time_t>(saved.epochAtSleep + rtcStateDeepSleepSeconds() + nowMs / 1000);
+    g_haveHostTime = true;
+    g_lastTimeSyncMs = nowMs;
+    s_lastHostSyncMs = nowMs;
+    g_lastPersistMs = nowMs;
+    uiInvalidateClock();
+    return true;
+}
+
+// PCF8563 kept counting through sleep and resets - authoritative when valid
+static bool restoreClockChip() {
+    const time_t now = rtcClockRead();
+    if (now <= 0) return false;
+
+    const uint32_t nowMs = millis();
+    g_buildEpoch = now;
+    g_haveHostTime = true;
+    g_lastTimeSyncMs = nowMs;
+    s_rtcClockValid = true;
+
+    // Resync on the age of the last host sync (persisted epoch), not on
+    // this boot - otherwise every deep sleep wake would ask the phone again
+    const int64_t hostEpoch = g_timePrefsReady ? g_timePrefs.getLong64(TIME_PREF_EPOCH_KEY, 0) : 0;
+    const int64_t ageS = hostEpoch > 0 ? (int64_t)now - hostEpoch : -1;
+    uint32_t ageMs = TIME_SYNC_AGE_CAP_MS;
+    if (ageS >= 0 && ageS < (int64_t)(TIME_SYNC_AGE_CAP_MS / 1000)) ageMs = (uint32_t)ageS * 1000;
+    s_lastHostSyncMs = nowMs - ageMs;
+
+    uiInvalidateClock();
+    return true;
+}
+
 void timeSyncInit() {
     g_buildEpoch = 0;
+    s_buildEpochFracMs = 0;
     g_haveHostTime = false;
     g_waitingForTime = false;
     g_timeRequestAttempts = 0;
     g_lastTimeRequestMs = 0;
     g_lastTimeSyncMs = 0;
     g_lastPersistMs = 0;
+    s_lastHostSyncMs = 0;
+    s_rtcClockValid = false;
 
+    clockDriftInit();
     g_timePrefsReady = g_timePrefs.begin(TIME_PREF_NAMESPACE, false);
-    if (!g_timePrefsReady) {
-    } else {
+    if (!restoreClockChip() && !restoreRtcTime()) {
         loadStoredTime();
     }
 }
 
-void setCurrentEpoch(time_t epoch) {
-    if (epoch <= 0) return;
-    g_buildEpoch = epoch;
+void timeSyncPrepareDeepSleep() {
+    clockDriftFlush();
+    rtcState().time.epochAtSleep = g_haveHostTime ? static_cast<int64_t>(getCurrentEpoch()) : 0;
+}
+
+// Host time epochMs was true at local esp_timer time localUs (not now),
+// give or take sigmaS (one standard deviation)
+static void applyHostTime(int64_t epochMs, int64_t localUs, float sigmaS) {
+    clockDriftAddSample(localUs / 1e6, epochMs / 1000.0, sigmaS);
+    g_buildEpoch = static_cast<time_t>(epochMs / 1000);
+    s_buildEpochFracMs = static_cast<uint16_t>(epochMs % 1000);
     g_haveHostTime = true;
-    g_lastTimeSyncMs = millis();
+    g_lastTimeSyncMs = static_cast<uint32_t>(localUs / 1000);   // millis() at localUs
+    s_lastHostSyncMs = g_lastTimeSyncMs;
+    if (rtcClockWrite(g_buildEpoch)) s_rtcClockValid = true;
     uiInvalidateClock();
     persistTimeState(false);
+    TRACE(TR_TIME_SYNC, g_buildEpoch, sigmaS * 1000.0f);
 }
 
-time_t getCurrentEpoch() {
+void setCurrentEpoch(time_t epoch) {
+    if (epoch <= 0) return;
+    // Whole seconds: uniform quantization error
+    applyHostTime(static_cast<int64_t>(epoch) * 1000, esp_timer_get_time(),
+                  TIME_SYNC_RESOLUTION_S / sqrtf(12.0f));
+}
+
+int64_t getCurrentEpochMs() {
     if (!g_haveHostTime) return 0;
-    // Advance the stored epoch by the elapsed millis since the last sync
+    // Advance the anchor by the drift-corrected millis since the last sync
     const uint32_t elapsedMs = millis() - g_lastTimeSyncMs;
-    return g_buildEpoch + static_cast<time_t>(elapsedMs / 1000);
+    return static_cast<int64_t>(g_buildEpoch) * 1000 + s_buildEpochFracMs +
+           clockDriftCorrectMs(elapsedMs);
+}
+
+int64_t getCurrentUtcMs() {
+    if (!s_haveTzOffset) return 0;
+    const int64_t localMs = getCurrentEpochMs();
+    return localMs > 0 ? localMs - (int64_t)s_hostTzOffsetS * 1000 : 0;
+}
+
+time_t getCurrentEpoch() {
+    return static_cast<time_t>(getCurrentEpochMs() / 1000);
 }
 
 void requestTimeFromHub(bool showWaitingScreen) {
@@ -101,21 +212,79 @@ void requestTimeFromHub(bool showWaitingScreen) {
     }
     g_lastTimeRequestMs = millis();
     g_lastWaitAnimMs = millis();
-    if (!canSendControlMessages()) {
+
+    // The phone OS answers CTS reads itself - no app wakeup
+    if (bleCtsRequestRead()) {
+        g_timeRequestAttempts++;
+        return;
+    }
+
+    if (transportHub() == TRANSPORT_LINK_NONE) {
         g_lastTimeRequestMs = millis() - TIME_REQ_RETRY_MS;
         return;
     }
-    bleSendControlMessage("REQ_TIME");
+
+    // A host that never answers REQ_TIMEMS gets the legacy request
+    if (s_hostTimeMode == HOST_TIME_UNKNOWN && s_timeMsAttempts >= TIME_MS_FALLBACK_ATTEMPTS) {
+        s_hostTimeMode = HOST_TIME_LEGACY;
+    }
+    if (s_hostTimeMode == HOST_TIME_LEGACY) {
+        bleSendControlMessage("REQ_TIME");
+    } else {
+        // t1 - echoed back so the reply needs no matching
+        char buf[32];
+        snprintf(buf, sizeof(buf), "REQ_TIMEMS:%lld", (long long)(esp_timer_get_time() / 1000));
+        bleSendControlMessage(buf);
+        if (s_hostTimeMode == HOST_TIME_UNKNOWN) s_timeMsAttempts++;
+    }
     g_timeRequestAttempts++;
 }
 
-void updateTimeRequest() {
-    if (!bleIsConnected() || !bleNotifyEnabled()) return;
+// Background resync period - grows with the drift estimate (clock_drift.h),
+// and the battery tier only ever stretches it
+static uint32_t timeResyncPeriodMs() {
+    const uint32_t baseMs = clockDriftResyncIntervalMs();
+    const uint32_t tierMs = batteryPolicy().timeResyncMs;
+    return tierMs > baseMs ? tierMs : baseMs;
+}
+
+// Milliseconds until runTimeRequest() has work to do (0xFFFFFFFF = none)
+static uint32_t msUntilTimeRequest(uint32_t *slackMs) {
+    if (transportHub() == TRANSPORT_LINK_NONE) return 0xFFFFFFFFu;
+
+    const uint32_t now = millis();
+    uint32_t dueMs;
+
+    if (g_waitingForTime) {
+        uint32_t waitMs = g_timeRequestAttempts < TIME_REQ_MAX_ATTEMPTS
+                              ? TIME_REQ_RETRY_MS : TIME_REQ_RETRY_MS * 4;
+        dueMs = g_lastTimeRequestMs + waitMs + 1;
+        *slackMs = TIME_REQ_RETRY_SLACK_MS;
+    } else if (g_haveHostTime) {
+        dueMs = s_lastHostSyncMs + timeResyncPeriodMs();
+        *slackMs = TIME_RESYNC_SLACK_MS;
+    } else if (g_timeRequestAttempts == 0) {
+        *slackMs = 0;
+        return 0;
+    } else {
+        return 0xFFFFFFFFu;
+    }
+
+    return (int32_t)(dueMs - now) <= 0 ? 0 : dueMs - now;
+}
+
+static void timeSyncTimer() {
+    if (powerIsLightSleep()) return;  // Loop calls updateTimeRequest() on wake
+    updateTimeRequest();
+}
+
+static void runTimeRequest() {
+    if (transportHub() == TRANSPORT_LINK_NONE) return;
 
     const uint32_t now = millis();
 
     if (g_haveHostTime && !g_waitingForTime &&
-        (now - g_lastTimeSyncMs) >= TIME_RESYNC_PERIOD_MS) {
+        (now - s_lastHostSyncMs) >= timeResyncPeriodMs()) {
         requestTimeFromHub(false);
         return;
     }
@@ -138,15 +307,132 @@ void updateTimeRequest() {
     }
 }
 
+void updateTimeRequest() {
+    runTimeRequest();
+
+    uint32_t slackMs = 0;
+    uint32_t ms = msUntilTimeRequest(&slackMs);
+    if (ms == 0xFFFFFFFFu) {
+        timerStop(TIMER_TIME_SYNC);
+    } else {
+        timerStart(TIMER_TIME_SYNC, timeSyncTimer, ms, slackMs);
+    }
+}
+
+static void resetExchangeState() {
+    s_hostTimeMode = HOST_TIME_UNKNOWN;
+    s_timeMsAttempts = 0;
+    s_minDelayMs = 0xFFFFFFFFu;
+    s_burstCount = 0;
+    s_burstBestDelayMs = 0xFFFFFFFFu;
+    s_haveTzOffset = false;
+}
+
 void timeSyncHandleConnected() {
     g_timeRequestAttempts = 0;
     g_waitingForTime = false;
+    resetExchangeState();
+    // PCF8563 time is good - the resync schedule decides (updateTimeRequest)
+    if (s_rtcClockValid && g_haveHostTime) return;
     requestTimeFromHub(false);
 }
 
 void timeSyncHandleDisconnected() {
     g_timeRequestAttempts = 0;
     g_waitingForTime = false;
+    resetExchangeState();
+}
+
+// Common tail of both reply formats
+static void finishTimeSync(bool isBackgroundSync) {
+    sleepPolicyOnTimeSync();
+    energyLedgerOnTimeSync();
+    g_waitingForTime = false;
+    g_timeRequestAttempts = 0;
+    if (currentState == WAITING_TIME) {
+        currentState = IDLE;
+    }
+    uiInvalidateClock();
+    // Only mark activity (which prevents sleep) if this is NOT a background sync
+    // Background time syncs should not wake the device or reset sleep timer
+    if (!isBackgroundSync) {
+        markActivity();
+    }
+}
+
+// TIMEMS:<t1>:<t2>:<t3>[:<offset_s>] - t1 is our REQ_TIMEMS stamp (local
+// ms), t2/t3 the host's receive/transmit epoch ms, t4 our receive time
+void handleTimeMsMessage(const std::string &value, int64_t arrivalUs) {
+    const char *p = value.c_str() + 7;
+    char *end = nullptr;
+    const long long t1 = strtoll(p, &end, 10);
+    if (!end || *end != ':') return;
+    const long long t2 = strtoll(end + 1, &end, 10);
+    if (!end || *end != ':') return;
+    const long long t3 = strtoll(end + 1, &end, 10);
+    long tzOffsetS = 0;
+    if (end && *end == ':') tzOffsetS = strtol(end + 1, nullptr, 10);
+
+    const int64_t t4Us = arrivalUs;
+    const int64_t t1Us = (int64_t)t1 * 1000;
+    if (t1 <= 0 || t2 <= 0 || t3 < t2 || t1Us > t4Us || t4Us - t1Us > TIME_MS_MAX_RTT_US) return;
+    s_hostTimeMode = HOST_TIME_MS;
+
+    // Standard NTP offset/delay, in ms
+    const int64_t t4 = t4Us / 1000;
+    const int64_t delay = (t4 - t1) - (t3 - t2);
+    const int64_t offset = ((t2 - t1) + (t3 - t4)) / 2;
+    const uint32_t delayMs = delay > 0 ? (uint32_t)delay : 0;
+    s_lastDelayMs = delayMs;
+
+    if (delayMs < s_burstBestDelayMs) {
+        s_burstBestDelayMs = delayMs;
+        s_burstBestOffsetMs = offset;
+        s_burstBestLocalUs = t4Us;
+        s_burstTzOffsetS = tzOffsetS;
+    }
+    s_burstCount++;
+
+    // Only low-delay exchanges are trusted: close to the best this link has
+    // shown. After a full burst, take the best one and relax the reference.
+    uint32_t limitMs = TIME_MS_GOOD_DELAY_MS;
+    if (s_minDelayMs != 0xFFFFFFFFu) {
+        limitMs = s_minDelayMs + (s_minDelayMs / 2 > TIME_MS_DELAY_MARGIN_MS
+                                      ? s_minDelayMs / 2 : TIME_MS_DELAY_MARGIN_MS);
+    }
+    const bool good = delayMs <= limitMs;
+    if (!good && s_burstCount < TIME_MS_BURST_MAX) {
+        requestTimeFromHub(false);   // Try again right away, still waiting
+        return;
+    }
+    if (good) {
+        if (delayMs < s_minDelayMs) s_minDelayMs = delayMs;
+    } else {
+        s_minDelayMs = s_burstBestDelayMs;
+    }
+
+    const bool isBackgroundSync = g_haveHostTime && currentState != WAITING_TIME;
+    const int64_t localMs = s_burstBestLocalUs / 1000;
+    const int64_t epochMs = localMs + s_burstBestOffsetMs + (int64_t)s_burstTzOffsetS * 1000;
+    // Half the round trip bounds the offset error; path asymmetry isn't
+    // uniform inside it, so the whole bound is taken as one sigma
+    float sigmaS = s_burstBestDelayMs / 2000.0f;
+    if (sigmaS < 0.001f) sigmaS = 0.001f;
+    applyHostTime(epochMs, s_burstBestLocalUs, sigmaS);
+    s_hostTzOffsetS = s_burstTzOffsetS;
+    s_haveTzOffset = true;
+    Serial.printf("[CLK] ms sync delay=%lums (%u exchanges)\n",
+                  (unsigned long)s_burstBestDelayMs, (unsigned)s_burstCount);
+
+    s_burstCount = 0;
+    s_burstBestDelayMs = 0xFFFFFFFFu;
+    finishTimeSync(isBackgroundSync);
+}
+
+void handleCtsTime(int64_t epochMs, int64_t localUs, float sigmaS) {
+    const bool isBackgroundSync = g_haveHostTime && currentState != WAITING_TIME;
+    applyHostTime(epochMs, localUs, sigmaS);
+    finishTimeSync(isBackgroundSync);
 }
 
 void handleTimeMessage(const std::string &value) {
@@ -160,19 +446,37 @@ void handleTimeMessage(const std::string &value) {
     const bool isBackgroundSync = g_haveHostTime && currentState != WAITING_TIME;
 
     if (epoch > 0) {
+        if (s_hostTimeMode == HOST_TIME_UNKNOWN) s_hostTimeMode = HOST_TIME_LEGACY;
         setCurrentEpoch((time_t)(epoch + offset));
-        g_waitingForTime = false;
-        g_timeRequestAttempts = 0;
-        if (currentState == WAITING_TIME) {
-            currentState = IDLE;
-        }
-        uiInvalidateClock();
-        // Only mark activity (which prevents sleep) if this is NOT a background sync
-        // Background time syncs should not wake the device or reset sleep timer
-        if (!isBackgroundSync) {
-            markActivity();
-        }
+        finishTimeSync(isBackgroundSync);
+    }
+}
+
+uint32_t timeSyncLastDelayMs() {
+    return s_lastDelayMs;
+}
+
+bool timeSyncHostSupportsMs() {
+    return s_hostTimeMode == HOST_TIME_MS;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+static int64_t daysFromCivil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (int64_t)era * 146097 + (int64_t)doe - 719468;
+}
+
+time_t epochFromCivil(int year, int month, int day, int hour, int min, int sec) {
+    if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour < 0 || hour > 23 || min < 0 || min > 59 || sec < 0 || sec > 60) {
+        return 0;
     }
+    const int64_t days = daysFromCivil(year, (unsigned)month, (unsigned)day);
+    return (time_t)(days * 86400 + hour * 3600 + min * 60 + sec);
 }
 
 String formatClock(time_t now) {
@@ -8,10 +8,24 @@ extern bool g_waitingForTime;
 extern bool g_haveHostTime;
 
 void timeSyncInit();
+void timeSyncPrepareDeepSleep();   // Epoch into RTC memory (rtc_state.h)
 void setCurrentEpoch(time_t epoch);
 time_t getCurrentEpoch();
+int64_t getCurrentEpochMs();       // 0 until host time is known
+// Host clock as UTC ms: 0 until a TIMEMS sync on this link gave the host's
+// UTC offset (the clock itself runs in host local time)
+int64_t getCurrentUtcMs();
 String formatClock(time_t now);
+// Date/time fields to an epoch with no TZ applied (0 if out of range)
+time_t epochFromCivil(int year, int month, int day, int hour, int min, int sec);
 void handleTimeMessage(const std::string &value);
+// NTP-style reply; arrivalUs = esp_timer time the write reached us
+void handleTimeMsMessage(const std::string &value, int64_t arrivalUs);
+// Current Time Service value (ble_cts.h) observed at local esp_timer localUs,
+// sigmaS = one standard deviation of its error
+void handleCtsTime(int64_t epochMs, int64_t localUs, float sigmaS);
+uint32_t timeSyncLastDelayMs();    // Round trip of the last TIMEMS exchange
+bool timeSyncHostSupportsMs();     // Host answered REQ_TIMEMS on this link
 void requestTimeFromHub(bool showWaitingScreen);
 void updateTimeRequest();
 void timeSyncHandleConnected();
@@ -0,0 +1,159 @@
+#include "timer_service.h"
+
+#include <esp_timer.h>
+
+#include "events.h"
+
+// =============================================================================
+// TIMER SERVICE
+// =============================================================================
+// POWER: The wakeup is placed at min(deadline + slack) over all armed timers
+// - the latest moment that still honours every timer's slack - and all
+// timers whose deadline has passed by then fire together. With slack set to
+// a fraction of each period, the 5s/8s/10s/15s/30s jobs collapse into far
+// fewer wakeups and tickless idle gets long uninterrupted sleeps.
+// =============================================================================
+
+struct TimerSlot {
+    TimerCallback cb;
+    uint32_t deadlineMs;
+    uint32_t slackMs;
+    uint32_t periodMs;
+    bool armed;
+};
+
+static TimerSlot s_timers[TIMER_COUNT] = {};
+static esp_timer_handle_t s_wakeTimer = nullptr;
+static bool s_wakeArmed = false;
+static uint32_t s_wakeAtMs = 0;
+static TimerServiceStats s_stats = {};
+
+// Wrap-safe "a is before or at b" on millis() timestamps
+static bool reached(uint32_t nowMs, uint32_t atMs) {
+    return (int32_t)(nowMs - atMs) >= 0;
+}
+
+static void wakeTimerCallback(void *arg) {
+    eventPost(EVT_TIMER);
+}
+
+// Re-arm the esp_timer for the earliest latest-acceptable fire time
+static void rearmWakeTimer() {
+    if (!s_wakeTimer) return;
+
+    bool any = false;
+    uint32_t wakeAt = 0;
+    const uint32_t now = millis();
+    for (int i = 0; i < TIMER_COUNT; i++) {
+        const TimerSlot &t = s_timers[i];
+        if (!t.armed) continue;
+        uint32_t latest = t.deadlineMs + t.slackMs;
+        if (!any || (int32_t)(latest - wakeAt) < 0) {
+            wakeAt = latest;
+            any = true;
+        }
+    }
+
+    if (!any) {
+        if (s_wakeArmed) {
+            esp_timer_stop(s_wakeTimer);
+            s_wakeArmed = false;
+        }
+        return;
+    }
+
+    if (s_wakeArmed && wakeAt == s_wakeAtMs) return;
+
+    esp_timer_stop(s_wakeTimer);
+    uint32_t delayMs = reached(now, wakeAt) ? 0 : wakeAt - now;
+    esp_timer_start_once(s_wakeTimer, (uint64_t)delayMs * 1000ULL + 1);
+    s_wakeArmed = true;
+    s_wakeAtMs = wakeAt;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void timerServiceInit() {
+    if (s_wakeTimer) return;
+
+    esp_timer_create_args_t args = {};
+    args.callback = wakeTimerCallback;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "timer_svc";
+    args.skip_unhandled_events = true;
+    esp_timer_create(&args, &s_wakeTimer);
+    rearmWakeTimer();
+}
+
+void timerStart(TimerId id, TimerCallback cb, uint32_t delayMs,
+                uint32_t slackMs, uint32_t periodMs) {
+    if (id < 0 || id >= TIMER_COUNT || !cb) return;
+    TimerSlot &t = s_timers[id];
+    t.cb = cb;
+    t.deadlineMs = millis() + delayMs;
+    t.slackMs = slackMs;
+    t.periodMs = periodMs;
+    t.armed = true;
+    rearmWakeTimer();
+}
+
+void timerArmEarliest(TimerId id, TimerCallback cb, uint32_t delayMs, uint32_t slackMs) {
+    if (id < 0 || id >= TIMER_COUNT) return;
+    const TimerSlot &t = s_timers[id];
+    if (t.armed && t.cb == cb) {
+        uint32_t deadline = millis() + delayMs;
+        if ((int32_t)(deadline - t.deadlineMs) >= 0) return;
+    }
+    timerStart(id, cb, delayMs, slackMs);
+}
+
+void timerStop(TimerId id) {
+    if (id < 0 || id >= TIMER_COUNT) return;
+    if (!s_timers[id].armed) return;
+    s_timers[id].armed = false;
+    rearmWakeTimer();
+}
+
+bool timerIsArmed(TimerId id) {
+    if (id < 0 || id >= TIMER_COUNT) return false;
+    return s_timers[id].armed;
+}
+
+void timerServiceDispatch() {
+    const uint32_t now = millis();
+    uint32_t firedNow = 0;
+
+    for (int i = 0; i < TIMER_COUNT; i++) {
+        TimerSlot &t = s_timers[i];
+        if (!t.armed || !reached(now, t.deadlineMs)) continue;
+
+        // Update the slot before the callback so it may re-arm itself
+        if (t.periodMs > 0) {
+            t.deadlineMs += t.periodMs;
+            if (reached(now, t.deadlineMs)) {
+                t.deadlineMs = now + t.periodMs;  // Missed periods - don't burst
+            }
+        } else {
+            t.armed = false;
+        }
+
+        firedNow++;
+        t.cb();
+    }
+
+    if (firedNow > 0) {
+        s_stats.wakeups++;
+        s_stats.fired += firedNow;
+        s_stats.merged += firedNow - 1;
+    }
+
+    // Always re-evaluate: the fired esp_timer is one-shot
+    s_wakeArmed = s_wakeArmed && !reached(now, s_wakeAtMs);
+    rearmWakeTimer();
+}
+
+const TimerServiceStats &timerServiceGetStats() {
+    return s_stats;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+// =============================================================================
+// TIMER SERVICE - Coalescing software timers for periodic housekeeping
+// =============================================================================
+// Every periodic job (battery, charging, time sync, advertising, animations,
+// timeouts) is a slot here instead of a hand-rolled millis() check. Each
+// timer has a deadline and a slack: it may fire anywhere in
+// [deadline, deadline + slack]. One esp_timer is armed for the earliest
+// "latest acceptable" time and every timer whose window has opened fires
+// in that same wakeup.
+//
+// Callbacks run on the main loop task (timerServiceDispatch()), so they can
+// touch UI and state freely. All functions are main-loop-task only.
+// =============================================================================
+
+#include <Arduino.h>
+
+enum TimerId {
+    TIMER_POWER_STATE,       // Next dim / light sleep / deep sleep transition
+    TIMER_BATTERY_HEALTH,    // Brownout check (10s)
+    TIMER_BATTERY_UPDATE,    // Battery percent (15s awake / 60s sleeping)
+    TIMER_CHARGE_POLL,       // VBUS poll fallback (5s)
+    TIMER_CHARGE_REDRAW,     // Charging overlay refresh (8s, only while charging)
+    TIMER_CLOCK,             // Clock redraw on the minute
+    TIMER_ADV_STEP,          // Advertising profile: next backoff step
+    TIMER_ADV_RETRY,         // Advertising start failed - retry with backoff
+    TIMER_TIME_SYNC,         // Time request retry (7s) / resync (60s)
+    TIMER_WAIT_ANIM,         // Waiting dots (500ms)
+    TIMER_WAITING_TIMEOUT,   // Waiting-for-answer timeout (30s)
+    TIMER_TEXT_READY,        // BLE text chunk quiescence (120ms)
+    TIMER_OTA,               // OTA chunk timeout / restart
+    TIMER_BLE_LINK_SETUP,    // Encryption + conn params after connect (50ms)
+    TIMER_FILE_SEND,         // File stream chunk pacing (5ms)
+    TIMER_BLE_RSSI,          // Link RSSI sample for TX power (2s / 10s sleeping)
+    TIMER_BLE_TELEMETRY,     // Link telemetry notify (1s, only while subscribed)
+    TIMER_COUNT
+};
+
+typedef void (*TimerCallback)();
+
+struct TimerServiceStats {
+    uint32_t wakeups;     // Dispatches that fired at least one timer
+    uint32_t fired;       // Total timer callbacks run
+    uint32_t merged;      // Callbacks that shared a wakeup (fired - wakeups)
+};
+
+// Create the backing esp_timer (call after eventsInit()). Timers started
+// before this are kept and armed here.
+void timerServiceInit();
+
+// Arm a timer: fire after delayMs, no later than delayMs + slackMs.
+// periodMs > 0 re-arms automatically (drift-free, from the deadline).
+// Re-arming an armed timer replaces its deadline.
+void timerStart(TimerId id, TimerCallback cb, uint32_t delayMs,
+                uint32_t slackMs, uint32_t periodMs = 0);
+// Arm, or pull an armed timer's deadline earlier - never pushes it later.
+// For "re-check by then" timers whose callback re-arms itself when early.
+void timerArmEarliest(TimerId id, TimerCallback cb, uint32_t delayMs, uint32_t slackMs);
+
+void timerStop(TimerId id);
+bool timerIsArmed(TimerId id);
+
+// Run every timer whose deadline has passed. Call on every loop wakeup -
+// timers due at a touch/BLE wakeup ride along for free.
+void timerServiceDispatch();
+
+const TimerServiceStats &timerServiceGetStats();
@@ -0,0 +1,111 @@
+#include "trace.h"
+
+#include <atomic>
+#include <esp_attr.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <string.h>
+
+#include "../ble/diag_bytes.h"
+
+constexpr uint32_t TRACE_MAGIC         = 0x54524352;   // "TRCR"
+constexpr uint16_t TRACE_VERSION       = 1;
+constexpr uint8_t TRACE_DUMP_VERSION   = 1;
+constexpr size_t TRACE_DUMP_HEADER     = 10;
+
+struct TraceRing {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entrySize;
+    TraceEntry entries[TRACE_ENTRIES];
+};
+
+// RTC slow memory, not touched by the startup code
+RTC_NOINIT_ATTR static TraceRing s_ring;
+
+// Write index - DRAM so the atomic increment works; rebuilt by traceInit()
+static std::atomic<uint32_t> s_head{0};
+
+static bool ringHeaderValid() {
+    return s_ring.magic == TRACE_MAGIC && s_ring.version == TRACE_VERSION &&
+           s_ring.entrySize == sizeof(TraceEntry);
+}
+
+// Newest entry = the last one whose successor does not continue its
+// sequence. Returns the index the next entry gets, 0 for an empty ring.
+static uint32_t recoverHead() {
+    for (size_t i = 0; i < TRACE_ENTRIES; i++) {
+        const TraceEntry &e = s_ring.entries[i];
+        if (e.id == TR_NONE || e.id >= TR_COUNT) continue;
+        if ((e.seq % TRACE_ENTRIES) != i) continue;   // Torn or garbage
+        const TraceEntry &next = s_ring.entries[(i + 1) % TRACE_ENTRIES];
+        if (next.id == TR_NONE || next.seq != (uint16_t)(e.seq + 1)) {
+            return (uint32_t)e.seq + 1;
+        }
+    }
+    return 0;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void traceInit() {
+    if (ringHeaderValid()) {
+        s_head.store(recoverHead());
+    } else {
+        memset(&s_ring, 0, sizeof(s_ring));
+        s_ring.magic = TRACE_MAGIC;
+        s_ring.version = TRACE_VERSION;
+        s_ring.entrySize = sizeof(TraceEntry);
+        s_head.store(0);
+    }
+    TRACE(TR_BOOT, esp_reset_reason(), esp_sleep_get_wakeup_cause());
+}
+
+void IRAM_ATTR traceWrite(uint16_t id, uint32_t a, uint32_t b) {
+    const uint32_t index = s_head.fetch_add(1, std::memory_order_relaxed);
+    TraceEntry &e = s_ring.entries[index % TRACE_ENTRIES];
+    e.tick = xTaskGetTickCount();   // Plain load for 32-bit ticks, ISR-safe
+    e.id = id;
+    e.a = a;
+    e.b = b;
+    // Readers match seq to the slot; a half-written entry keeps the old seq
+    std::atomic_signal_fence(std::memory_order_release);
+    e.seq = (uint16_t)index;
+}
+
+uint32_t traceCount() {
+    return s_head.load(std::memory_order_relaxed);
+}
+
+size_t traceDumpPage(uint16_t start, uint8_t *buf, size_t cap) {
+    if (!buf || cap < TRACE_DUMP_HEADER) return 0;
+
+    const uint32_t head = s_head.load(std::memory_order_relaxed);
+    const uint32_t stored = head < TRACE_ENTRIES ? head : TRACE_ENTRIES;
+    const uint32_t oldest = head - stored;
+
+    size_t count = start < stored ? stored - start : 0;
+    const size_t fit = (cap - TRACE_DUMP_HEADER) / sizeof(TraceEntry);
+    if (count > fit) count = fit;
+    const size_t len = TRACE_DUMP_HEADER + count * sizeof(TraceEntry);
+
+    uint8_t *p = buf;
+    p = putU8(p, TRACE_DUMP_VERSION);
+    p = putU8(p, 0);
+    p = putU16(p, (uint16_t)len);
+    p = putU16(p, (uint16_t)head);
+    p = putU16(p, start);
+    p = putU8(p, (uint8_t)count);
+    p = putU8(p, (uint8_t)sizeof(TraceEntry));
+
+    // The ESP32-S3 is little-endian - entries go out as stored
+    for (size_t i = 0; i < count; i++) {
+        memcpy(p, &s_ring.entries[(oldest + start + i) % TRACE_ENTRIES], sizeof(TraceEntry));
+        p += sizeof(TraceEntry);
+    }
+    return len;
+}
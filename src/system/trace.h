@@ -0,0 +1,62 @@
+#pragma once
+
+// =============================================================================
+// TRACE - Binary event ring in RTC memory
+// =============================================================================
+// Serial.printf is off in production (ARDUINO_USB_CDC_ON_BOOT=0), costly when
+// on, and gone after a reset. TRACE(id, a, b) stores a format id and two raw
+// 32-bit arguments in a ring in RTC slow memory instead; the strings live in
+// trace_formats.h and tools/trace_decode rebuilds the text on the host.
+//
+// - Filtered at compile time: events above TRACE_LEVEL (build flag) compile
+//   to nothing.
+// - Lock-free and ISR-safe: a slot is claimed with one atomic increment, so
+//   any task or ISR on either core can trace. Cost is a few dozen cycles.
+// - RTC_NOINIT: the ring survives panics, watchdog resets and deep sleep.
+//   traceInit() finds the newest entry again from the sequence numbers.
+//
+// The diagnostics service has a trace characteristic that pages through
+// the ring oldest first (see traceDumpPage()).
+// =============================================================================
+
+#include <Arduino.h>
+
+#include "trace_formats.h"
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LEVEL_INFO
+#endif
+
+#define TRACE(id, a, b)                                                      \
+    do {                                                                     \
+        if (id##_LEVEL <= TRACE_LEVEL) traceWrite(id, (uint32_t)(a), (uint32_t)(b)); \
+    } while (0)
+#define TRACE0(id) TRACE(id, 0, 0)
+#define TRACE1(id, a) TRACE(id, a, 0)
+
+constexpr size_t TRACE_ENTRIES = 128;      // Power of two (divides 2^16)
+
+struct TraceEntry {
+    uint32_t tick;      // FreeRTOS tick (ms) since boot
+    uint16_t id;        // TraceId, TR_NONE = empty
+    uint16_t seq;       // Low 16 bits of the write index, written last
+    uint32_t a;
+    uint32_t b;
+};
+
+// Validate or clear the ring and log TR_BOOT (first thing in setup())
+void traceInit();
+
+void traceWrite(uint16_t id, uint32_t a, uint32_t b);
+
+// Write index - the sequence number the next entry gets
+uint32_t traceCount();
+
+// Dump page for the diagnostics characteristic, oldest first from entry
+// `start` (0 = oldest still in the ring). Returns bytes written, 0 if cap
+// is too small. Layout (version 1):
+//   u8  version, u8 reserved, u16 length
+//   u16 head_seq     sequence number the next entry gets
+//   u16 start, u8 entry_count, u8 entry_size
+//   entries (TraceEntry, little-endian, as stored)
+size_t traceDumpPage(uint16_t start, uint8_t *buf, size_t cap);
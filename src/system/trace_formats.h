@@ -0,0 +1,54 @@
+#pragma once
+
+// =============================================================================
+// TRACE FORMATS - Event ids, levels and format strings
+// =============================================================================
+// Shared by the firmware (trace.h) and the host decoder
+// (tools/trace_decode), so it must stay plain C++ with no Arduino includes.
+//
+// X(id, level, format): at most two printf arguments, each an unsigned
+// 32-bit value (%u, %x, %d for values cast from int). Ids are numbered in
+// order - append new events at the end, dumps from older firmware are
+// decoded with this table.
+// =============================================================================
+
+#include <stdint.h>
+
+#define TRACE_LEVEL_ERROR 1
+#define TRACE_LEVEL_WARN  2
+#define TRACE_LEVEL_INFO  3
+#define TRACE_LEVEL_DEBUG 4
+
+#define TRACE_EVENTS(X)                                                                 \
+    X(TR_BOOT,            TRACE_LEVEL_ERROR, "boot reset=%u wake=%u")                   \
+    X(TR_WAKE_SPURIOUS,   TRACE_LEVEL_INFO,  "spurious deep sleep wake cause=%u")       \
+    X(TR_DEEP_SLEEP,      TRACE_LEVEL_INFO,  "deep sleep, battery %u%% idle %us")       \
+    X(TR_POWER_STATE,     TRACE_LEVEL_DEBUG, "power state %u -> %u")                    \
+    X(TR_BLE_CONNECT,     TRACE_LEVEL_INFO,  "ble connect conn=%u")                     \
+    X(TR_BLE_DISCONNECT,  TRACE_LEVEL_INFO,  "ble disconnect conn=%u")                  \
+    X(TR_BLE_AUTH_FAIL,   TRACE_LEVEL_WARN,  "ble auth failed reason=0x%x")             \
+    X(TR_WORK_DROP,       TRACE_LEVEL_WARN,  "work queue full, dropped type=%u")        \
+    X(TR_LOOP_STALL,      TRACE_LEVEL_WARN,  "loop stall %uus, section %u")             \
+    X(TR_TIME_SYNC,       TRACE_LEVEL_INFO,  "time sync epoch=%u uncertainty=%ums")     \
+    X(TR_OTA_FAIL,        TRACE_LEVEL_ERROR, "ota failed at %u of %u bytes")            \
+    X(TR_BATTERY_CUTOFF,  TRACE_LEVEL_ERROR, "low battery shutdown %umV")               \
+    X(TR_RECORDING,       TRACE_LEVEL_DEBUG, "recording %u bytes=%u")                   \
+    X(TR_BOOT_READY,      TRACE_LEVEL_INFO,  "boot ready, advertising %ums, first frame %ums") \
+    X(TR_WAKE_FILTERED,   TRACE_LEVEL_INFO,  "touch pulses rejected: ulp=%u cpu=%u")    \
+    X(TR_HEADLESS_SYNC,   TRACE_LEVEL_INFO,  "headless sync ended, reason %u after %ums") \
+    X(TR_BLE_RECONNECT,   TRACE_LEVEL_INFO,  "ble connected %ums after boot") \
+    X(TR_ADV_STEP,        TRACE_LEVEL_INFO,  "advertising step %u, previous duty %uppm") \
+    X(TR_TX_POWER,        TRACE_LEVEL_DEBUG, "tx power level %u, rssi -%udBm")
+
+enum TraceId : uint16_t {
+    TR_NONE = 0,   // Empty slot
+#define TRACE_ENUM(id, level, fmt) id,
+    TRACE_EVENTS(TRACE_ENUM)
+#undef TRACE_ENUM
+    TR_COUNT
+};
+
+// Per-event level constants for the compile-time filter in trace.h
+#define TRACE_LEVEL_CONST(id, level, fmt) constexpr int id##_LEVEL = level;
+TRACE_EVENTS(TRACE_LEVEL_CONST)
+#undef TRACE_LEVEL_CONST
@@ -0,0 +1,128 @@
+#include "work_queue.h"
+
+#include <atomic>
+#include <string.h>
+#include <esp_timer.h>
+
+#include "events.h"
+#include "trace.h"
+
+constexpr uint32_t WORK_QUEUE_SLOTS  = 16;      // Power of two
+constexpr uint32_t CALLBACK_STALL_US = 20000;   // A BTC callback this slow stalls the stack
+
+static const char *const WORK_NAMES[WORK_TYPE_COUNT] = {
+    "connect", "disconnect", "file", "ota", "bonded", "adv", "rssi", "subscribe",
+};
+static const char *const CALLBACK_NAMES[CB_COUNT] = {
+    "connect", "disconnect", "auth", "text", "file", "ota", "diag", "gap",
+};
+
+static WorkItem s_slots[WORK_QUEUE_SLOTS];
+static std::atomic<uint32_t> s_head{0};   // Written by the producer only
+static std::atomic<uint32_t> s_tail{0};   // Written by the consumer only
+static uint32_t s_highWater = 0;
+
+static WorkHandler s_handlers[WORK_TYPE_COUNT] = {nullptr};
+static uint32_t s_drops[WORK_TYPE_COUNT] = {0};
+static WorkStats s_runStats[WORK_TYPE_COUNT] = {};
+static WorkStats s_cbStats[CB_COUNT] = {};
+static uint32_t s_cbStalls[CB_COUNT] = {0};
+
+static void addSample(WorkStats &s, uint32_t us) {
+    s.count++;
+    s.totalUs += us;
+    if (us > s.maxUs) s.maxUs = us;
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void workQueueRegister(WorkType type, WorkHandler handler) {
+    if (type >= WORK_TYPE_COUNT) return;
+    s_handlers[type] = handler;
+}
+
+bool workQueuePost(WorkType type, const void *data, size_t len, uint16_t connId) {
+    if (type >= WORK_TYPE_COUNT) return false;
+
+    const uint32_t head = s_head.load(std::memory_order_relaxed);
+    const uint32_t tail = s_tail.load(std::memory_order_acquire);
+    if (head - tail >= WORK_QUEUE_SLOTS || len > WORK_PAYLOAD_MAX) {
+        s_drops[type]++;
+        TRACE1(TR_WORK_DROP, type);
+        return false;
+    }
+
+    WorkItem &item = s_slots[head % WORK_QUEUE_SLOTS];
+    item.type = type;
+    item.connId = connId;
+    item.len = (uint16_t)len;
+    if (len) memcpy(item.data, data, len);
+    s_head.store(head + 1, std::memory_order_release);
+
+    if (head + 1 - tail > s_highWater) s_highWater = head + 1 - tail;
+    eventPost(EVT_BLE);
+    return true;
+}
+
+void workQueueRun() {
+    uint32_t tail = s_tail.load(std::memory_order_relaxed);
+    while (tail != s_head.load(std::memory_order_acquire)) {
+        const WorkItem &item = s_slots[tail % WORK_QUEUE_SLOTS];
+        const WorkHandler handler = s_handlers[item.type];
+        if (handler) {
+            const int64_t startUs = esp_timer_get_time();
+            handler(item);
+            addSample(s_runStats[item.type], (uint32_t)(esp_timer_get_time() - startUs));
+        }
+        // Slot is free for the producer only after the handler is done with it
+        s_tail.store(++tail, std::memory_order_release);
+    }
+}
+
+uint32_t workQueueDrops(WorkType type) {
+    return type < WORK_TYPE_COUNT ? s_drops[type] : 0;
+}
+
+WorkStats workQueueRunStats(WorkType type) {
+    return type < WORK_TYPE_COUNT ? s_runStats[type] : WorkStats{};
+}
+
+WorkStats workQueueCallbackStats(CallbackId id) {
+    return id < CB_COUNT ? s_cbStats[id] : WorkStats{};
+}
+
+void workQueuePrint() {
+    Serial.printf("[WQ] high water %lu/%lu\n",
+                  (unsigned long)s_highWater, (unsigned long)WORK_QUEUE_SLOTS);
+    for (int i = 0; i < CB_COUNT; i++) {
+        const WorkStats &s = s_cbStats[i];
+        if (!s.count) continue;
+        Serial.printf("[WQ] cb %-10s n=%lu avg=%luus max=%luus stalls=%lu\n",
+                      CALLBACK_NAMES[i], (unsigned long)s.count,
+                      (unsigned long)(s.totalUs / s.count), (unsigned long)s.maxUs,
+                      (unsigned long)s_cbStalls[i]);
+    }
+    for (int i = 0; i < WORK_TYPE_COUNT; i++) {
+        const WorkStats &s = s_runStats[i];
+        if (!s.count && !s_drops[i]) continue;
+        Serial.printf("[WQ] run %-10s n=%lu avg=%luus max=%luus drops=%lu\n",
+                      WORK_NAMES[i], (unsigned long)s.count,
+                      (unsigned long)(s.count ? s.totalUs / s.count : 0),
+                      (unsigned long)s.maxUs, (unsigned long)s_drops[i]);
+    }
+}
+
+// =============================================================================
+// CallbackTimer
+// =============================================================================
+
+CallbackTimer::CallbackTimer(CallbackId id) : m_id(id), m_startUs(esp_timer_get_time()) {}
+
+CallbackTimer::~CallbackTimer() {
+    if (m_id >= CB_COUNT) return;
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - m_startUs);
+    addSample(s_cbStats[m_id], us);
+    if (us >= CALLBACK_STALL_US) s_cbStalls[m_id]++;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+// =============================================================================
+// WORK QUEUE - BLE callbacks enqueue, the main loop runs the work
+// =============================================================================
+// GATT/GAP callbacks run on the Bluedroid (BTC) task. Anything slow there -
+// delays, I2S teardown, file streaming, flash writes - stalls every other
+// BLE event, and touching loop-owned globals (currentState, recording
+// flags) from that task races the loop. Callbacks now only record what
+// happened and post a typed item; the loop task drains the queue and runs
+// the handler, so that state has a single owner again.
+//
+// The ring is single-producer/single-consumer and lock-free: the BTC task
+// is the only producer, the loop the only consumer. Each callback is also
+// timed (CallbackTimer) so a slow one shows up before it starves the stack.
+// =============================================================================
+
+#include <Arduino.h>
+
+enum WorkType : uint8_t {
+    WORK_BLE_CONNECT,        // payload: peer address, link count at connect (7)
+    WORK_BLE_DISCONNECT,     // payload: peer address (6)
+    WORK_BLE_FILE_REQUEST,   // connId: requesting link
+    WORK_BLE_OTA_WRITE,      // payload: written value
+    WORK_BLE_BONDED,         // payload: peer identity address (6)
+    WORK_BLE_ADV_STATE,      // payload: started, ok (2)
+    WORK_BLE_RSSI,           // payload: ok, rssi, peer address (8)
+    WORK_BLE_SUBSCRIBE,      // payload: BleChannel, on (2)
+    WORK_TYPE_COUNT
+};
+
+// Callbacks that run on the BTC task
+enum CallbackId : uint8_t {
+    CB_GATTS_CONNECT,
+    CB_GATTS_DISCONNECT,
+    CB_GAP_AUTH,
+    CB_TEXT_WRITE,
+    CB_FILE_WRITE,
+    CB_OTA_WRITE,
+    CB_DIAG_ACCESS,
+    CB_GAP_EVENT,
+    CB_COUNT
+};
+
+constexpr size_t WORK_PAYLOAD_MAX = 512;   // Largest attribute value
+
+struct WorkItem {
+    WorkType type;
+    uint16_t connId;    // Link the item came from (ble_conn.h), 0xFFFF if none
+    uint16_t len;
+    uint8_t data[WORK_PAYLOAD_MAX];
+};
+
+typedef void (*WorkHandler)(const WorkItem &item);
+
+struct WorkStats {
+    uint32_t count;
+    uint32_t maxUs;
+    uint64_t totalUs;
+};
+
+// Handlers are registered once at init (before BLE starts)
+void workQueueRegister(WorkType type, WorkHandler handler);
+
+// Producer (BTC task only). Copies the payload and posts EVT_BLE.
+// False if the queue is full or the payload too large - counted as a drop.
+bool workQueuePost(WorkType type, const void *data = nullptr, size_t len = 0,
+                   uint16_t connId = 0xFFFF);
+
+// Consumer (main loop): run everything queued
+void workQueueRun();
+
+uint32_t workQueueDrops(WorkType type);
+WorkStats workQueueRunStats(WorkType type);
+WorkStats workQueueCallbackStats(CallbackId id);
+void workQueuePrint();
+
+// Scoped timing of one BTC callback
+class CallbackTimer {
+public:
+    explicit CallbackTimer(CallbackId id);
+    ~CallbackTimer();
+    CallbackTimer(const CallbackTimer &) = delete;
+    CallbackTimer &operator=(const CallbackTimer &) = delete;
+
+private:
+    CallbackId m_id;
+    int64_t m_startUs;
+};
@@ -14,6 +14,7 @@
 #include "../power/battery.h"
 #include "../system/state.h"
 #include "../system/time_sync.h"
+#include "../system/timer_service.h"
 
 const int SCREEN_W = SCREEN_WIDTH;
 const int SCREEN_H = SCREEN_HEIGHT;
@@ -28,6 +29,7 @@ const uint8_t TEXT_SIZE_PRIMARY   = 3;
 const uint8_t TEXT_SIZE_SECONDARY = 2;
 
 static int32_t g_lastClockMinute = -1;
+constexpr uint32_t CLOCK_SLACK_MS = 1000;
 
 // =============================================================================
 // DISPLAY DRIVER CONFIGURATION
@@ -115,6 +117,13 @@ void refreshClockIfNeeded() {
         g_lastClockMinute = minuteStamp;
         drawClock(formatClock(now));
     }
+
+    // Wake on the next minute boundary (epoch is whole seconds - an early
+    // fire just finds the same minute and re-arms)
+    if (now > 0) {
+        uint32_t msToNextMinute = (uint32_t)(60 - (now % 60)) * 1000;
+        timerArmEarliest(TIMER_CLOCK, refreshClockIfNeeded, msToNextMinute, CLOCK_SLACK_MS);
+    }
 }
 
 void playBootAnimation() {
@@ -3,6 +3,10 @@
 #include "../ui/ui_common.h"
 #include "../power/battery.h"
 #include "../system/state.h"
+#include "../system/timer_service.h"
+
+constexpr uint32_t WAIT_ANIM_FRAME_MS = 500;
+constexpr uint32_t WAIT_ANIM_SLACK_MS = 100;
 
 uint32_t g_lastWaitAnimMs = 0;
 int g_waitingDots = 0;
@@ -38,11 +42,18 @@ void drawWaitingForAnswerScreen() {
     drawBatteryOverlay(true);
 }
 
+void startWaitingAnimation() {
+    timerStart(TIMER_WAIT_ANIM, updateWaitingForTimeAnimation, WAIT_ANIM_FRAME_MS,
+               WAIT_ANIM_SLACK_MS, WAIT_ANIM_FRAME_MS);
+}
+
 void updateWaitingForTimeAnimation() {
-    if (currentState != WAITING_TIME && currentState != WAITING_ANSWER) return;
-    uint32_t now = millis();
-    if (now - g_lastWaitAnimMs < 500) return;
-    g_lastWaitAnimMs = now;
+    // Left the waiting screen or display is off - stop ticking
+    if ((currentState != WAITING_TIME && currentState != WAITING_ANSWER) || g_sleeping) {
+        timerStop(TIMER_WAIT_ANIM);
+        return;
+    }
+    g_lastWaitAnimMs = millis();
     g_waitingDots = (g_waitingDots + 1) % 4;
     if (currentState == WAITING_TIME) {
         drawWaitingForTimeScreen();
@@ -8,4 +8,6 @@ extern int g_waitingDots;
 void resetWaitingAnimation();
 void drawWaitingForTimeScreen();
 void drawWaitingForAnswerScreen();
+// Dots animation - runs on the timer service while a waiting screen is shown
+void startWaitingAnimation();
 void updateWaitingForTimeAnimation();
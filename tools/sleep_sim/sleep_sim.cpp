@@ -0,0 +1,212 @@
+// =============================================================================
+// SLEEP SIM - Replay idle gaps against deep sleep policies
+// =============================================================================
+// Host-side tool. Runs the firmware's sleep model (src/power/sleep_model.cpp)
+// over a usage log and compares fixed deep sleep thresholds with the
+// adaptive policy the firmware uses.
+//
+// Build:
+//   g++ -std=c++17 -O2 -Isrc tools/sleep_sim/sleep_sim.cpp src/power/sleep_model.cpp -o sleep_sim
+//
+// Input (file or stdin), one gap per line - serial monitor captures work
+// as-is, other lines are ignored:
+//   [SLP] gap <idle_start_epoch> <seconds>
+//   <idle_start_epoch> <seconds>
+//
+// Usage:
+//   ./sleep_sim serial.log
+//   ./sleep_sim --synthetic 2000            (generated week-day pattern)
+//   ./sleep_sim --light-ma 18 --wake-mas 600 serial.log
+// =============================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "power/sleep_model.h"
+
+struct Gap {
+    int64_t idleStartEpoch;
+    uint32_t gapS;
+};
+
+// Same defaults as the firmware (current_model.cpp, power_manager.h,
+// sleep_policy.cpp) - override with the flags below
+static SleepEnergyParams s_params = {8.0f, 0.15f, 400.0f, 20};
+static uint32_t s_defaultDeepAfterS = 280;
+
+// =============================================================================
+// Input
+// =============================================================================
+
+static bool parseLine(const char *line, Gap &out) {
+    const char *p = strstr(line, "[SLP] gap ");
+    p = p ? p + 10 : line;
+
+    long long epoch = 0;
+    unsigned long gapS = 0;
+    if (sscanf(p, "%lld %lu", &epoch, &gapS) != 2) return false;
+    out.idleStartEpoch = epoch;
+    out.gapS = (uint32_t)gapS;
+    return true;
+}
+
+static bool loadLog(const char *path, std::vector<Gap> &gaps) {
+    FILE *f = (path && strcmp(path, "-") != 0) ? fopen(path, "r") : stdin;
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    char line[256];
+    Gap g;
+    while (fgets(line, sizeof(line), f)) {
+        if (parseLine(line, g)) gaps.push_back(g);
+    }
+    if (f != stdin) fclose(f);
+    return true;
+}
+
+// Short glances during the day, long gaps over lunch and at night
+static void synthesize(size_t count, std::vector<Gap> &gaps) {
+    std::mt19937 rng(1234);
+    std::exponential_distribution<double> shortGap(1.0 / 90.0);
+    std::exponential_distribution<double> mediumGap(1.0 / 900.0);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    int64_t t = 1700000000LL - (1700000000LL % 86400) + 8 * 3600;  // 08:00
+    for (size_t i = 0; i < count; i++) {
+        const int hour = (int)((t % 86400) / 3600);
+        double gapS;
+        if (hour >= 22 || hour < 7) {
+            gapS = 6 * 3600 + uni(rng) * 3 * 3600;     // Night
+        } else if (hour >= 12 && hour < 13 && uni(rng) < 0.5) {
+            gapS = 2400 + uni(rng) * 1800;             // Lunch
+        } else {
+            gapS = uni(rng) < 0.8 ? shortGap(rng) : mediumGap(rng);
+        }
+
+        gaps.push_back({t, (uint32_t)gapS});
+        t += (int64_t)gapS + 20;  // ~20s of interaction between gaps
+    }
+}
+
+// =============================================================================
+// Simulation
+// =============================================================================
+
+struct Result {
+    double chargeMas = 0;
+    uint32_t deepSleeps = 0;
+    double totalS = 0;
+};
+
+// Charge of one gap given the threshold - mirrors the model's cost terms
+static void account(Result &r, uint32_t gapS, uint32_t deepAfterS) {
+    r.totalS += gapS;
+    if (gapS <= s_params.lightSleepAfterS) return;
+
+    const uint32_t sleptS = gapS - s_params.lightSleepAfterS;
+    if (deepAfterS == 0 || sleptS <= deepAfterS) {
+        r.chargeMas += s_params.lightSleepMa * sleptS;
+    } else {
+        r.chargeMas += s_params.lightSleepMa * deepAfterS +
+                       s_params.deepSleepMa * (sleptS - deepAfterS) +
+                       s_params.wakeCostMas;
+        r.deepSleeps++;
+    }
+}
+
+static Result runFixed(const std::vector<Gap> &gaps, uint32_t deepAfterS) {
+    Result r;
+    for (const Gap &g : gaps) account(r, g.gapS, deepAfterS);
+    return r;
+}
+
+// Online: decide with what was learned so far, then learn the gap
+static Result runAdaptive(const std::vector<Gap> &gaps) {
+    SleepGapHistogram h;
+    sleepModelReset(h);
+
+    Result r;
+    for (const Gap &g : gaps) {
+        const int slot = sleepModelSlotForEpoch(g.idleStartEpoch);
+        const uint32_t deepAfterS =
+            sleepModelChooseDeepAfterS(h, slot, s_params, s_defaultDeepAfterS);
+        account(r, g.gapS, deepAfterS);
+        sleepModelAddGap(h, slot, g.gapS);
+    }
+    return r;
+}
+
+static void printResult(const char *name, const Result &r) {
+    const double mAh = r.chargeMas / 3600.0;
+    const double meanMa = r.totalS > 0 ? r.chargeMas / r.totalS : 0;
+    printf("%-16s %10.2f mAh %8u reconnects %8.3f mA mean idle\n",
+           name, mAh, r.deepSleeps, meanMa);
+}
+
+static void usage() {
+    fprintf(stderr,
+            "usage: sleep_sim [--light-ma F] [--deep-ma F] [--wake-mas F]\n"
+            "                 [--light-after S] [--default S]\n"
+            "                 (--synthetic N | <log file> | -)\n");
+}
+
+int main(int argc, char **argv) {
+    std::vector<Gap> gaps;
+    const char *path = nullptr;
+    size_t synthetic = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--light-ma") && hasValue) {
+            s_params.lightSleepMa = strtof(argv[++i], nullptr);
+        } else if (!strcmp(argv[i], "--deep-ma") && hasValue) {
+            s_params.deepSleepMa = strtof(argv[++i], nullptr);
+        } else if (!strcmp(argv[i], "--wake-mas") && hasValue) {
+            s_params.wakeCostMas = strtof(argv[++i], nullptr);
+        } else if (!strcmp(argv[i], "--light-after") && hasValue) {
+            s_params.lightSleepAfterS = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--default") && hasValue) {
+            s_defaultDeepAfterS = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--synthetic") && hasValue) {
+            synthetic = (size_t)strtoul(argv[++i], nullptr, 10);
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            usage();
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (synthetic > 0) {
+        synthesize(synthetic, gaps);
+    } else if (path) {
+        if (!loadLog(path, gaps)) return 1;
+    } else {
+        usage();
+        return 2;
+    }
+
+    if (gaps.empty()) {
+        fprintf(stderr, "no gaps in input\n");
+        return 1;
+    }
+
+    printf("%zu gaps, light %.2f mA, deep %.2f mA, wake %.0f mA*s, light sleep after %us\n\n",
+           gaps.size(), s_params.lightSleepMa, s_params.deepSleepMa,
+           s_params.wakeCostMas, s_params.lightSleepAfterS);
+
+    static const uint32_t FIXED_S[] = {60, 280, 600, 1800};
+    char name[32];
+    for (uint32_t s : FIXED_S) {
+        snprintf(name, sizeof(name), "fixed %us", s);
+        printResult(name, runFixed(gaps, s));
+    }
+    printResult("never", runFixed(gaps, 0));
+    printResult("adaptive", runAdaptive(gaps));
+    return 0;
+}
@@ -0,0 +1,199 @@
+// =============================================================================
+// TRACE DECODE - Rebuild readable logs from a trace ring dump
+// =============================================================================
+// Host-side tool. Decodes the pages read from the trace characteristic
+// (src/system/trace.h) with the firmware's own format table
+// (src/system/trace_formats.h), so a rebuilt tool always matches the
+// firmware it was built from.
+//
+// Build:
+//   g++ -std=c++17 -O2 -Isrc tools/trace_decode/trace_decode.cpp -o trace_decode
+//
+// Input (file or stdin): the characteristic reads as hex, one read per
+// line (spaces, ':', '-' and a leading 0x are ignored), as copied from
+// nRF Connect or LightBlue. --bin reads the raw page bytes back to back.
+//
+// Usage:
+//   ./trace_decode dump.txt
+//   ./trace_decode --bin dump.bin
+// =============================================================================
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "system/trace_formats.h"
+
+struct FormatDef {
+    const char *name;
+    int level;
+    const char *format;
+};
+
+static const FormatDef FORMATS[] = {
+    {"TR_NONE", 0, ""},
+#define TRACE_FORMAT_DEF(id, level, fmt) {#id, level, fmt},
+    TRACE_EVENTS(TRACE_FORMAT_DEF)
+#undef TRACE_FORMAT_DEF
+};
+
+static const char *const LEVEL_NAMES[] = {"-", "E", "W", "I", "D"};
+
+constexpr size_t PAGE_HEADER = 10;
+constexpr size_t ENTRY_SIZE  = 16;
+
+struct Entry {
+    uint32_t tick;
+    uint16_t id;
+    uint16_t seq;
+    uint32_t a;
+    uint32_t b;
+};
+
+// =============================================================================
+// Input
+// =============================================================================
+
+static int hexValue(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static bool loadHex(FILE *f, std::vector<uint8_t> &out) {
+    char line[4096];
+    while (fgets(line, sizeof(line), f)) {
+        int pending = -1;
+        for (const char *p = line; *p; p++) {
+            if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+                p++;
+                continue;
+            }
+            const int v = hexValue((unsigned char)*p);
+            if (v < 0) continue;
+            if (pending < 0) {
+                pending = v;
+            } else {
+                out.push_back((uint8_t)((pending << 4) | v));
+                pending = -1;
+            }
+        }
+        if (pending >= 0) {
+            fprintf(stderr, "odd number of hex digits in: %s", line);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool loadBin(FILE *f, std::vector<uint8_t> &out) {
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.insert(out.end(), buf, buf + n);
+    return !ferror(f);
+}
+
+static uint16_t getU16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Pages back to back; each carries its own length
+static bool parsePages(const std::vector<uint8_t> &data, std::vector<Entry> &entries) {
+    size_t pos = 0;
+    while (pos + PAGE_HEADER <= data.size()) {
+        const uint8_t *p = &data[pos];
+        const uint16_t len = getU16(p + 2);
+        const uint8_t count = p[8];
+        const uint8_t entrySize = p[9];
+        if (p[0] != 1 || entrySize != ENTRY_SIZE || len != PAGE_HEADER + count * ENTRY_SIZE ||
+            pos + len > data.size()) {
+            fprintf(stderr, "bad page at byte %zu (version %u, length %u)\n", pos, p[0], len);
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t *e = p + PAGE_HEADER + i * ENTRY_SIZE;
+            entries.push_back({getU32(e), getU16(e + 4), getU16(e + 6), getU32(e + 8), getU32(e + 12)});
+        }
+        pos += len;
+    }
+    return true;
+}
+
+// =============================================================================
+// Output
+// =============================================================================
+
+static void printEntries(const std::vector<Entry> &entries) {
+    const size_t formatCount = sizeof(FORMATS) / sizeof(FORMATS[0]);
+    int boot = 0;
+    bool havePrev = false;
+    uint16_t prevSeq = 0;
+
+    for (const Entry &e : entries) {
+        // Oldest first - a gap means a torn slot or a page read across a wrap
+        if (havePrev && e.seq != (uint16_t)(prevSeq + 1)) {
+            printf("      ... %u entries missing\n", (unsigned)(uint16_t)(e.seq - prevSeq - 1));
+        }
+        havePrev = true;
+        prevSeq = e.seq;
+
+        if (e.id == TR_BOOT) boot++;
+        if (e.id == TR_NONE || e.id >= formatCount) {
+            printf("%5u  b%-2d %9.3fs  ?  unknown id %u (%u, %u)\n", e.seq, boot,
+                   e.tick / 1000.0, e.id, e.a, e.b);
+            continue;
+        }
+
+        const FormatDef &def = FORMATS[e.id];
+        char text[256];
+        snprintf(text, sizeof(text), def.format, e.a, e.b);
+        printf("%5u  b%-2d %9.3fs  %s  %s\n", e.seq, boot, e.tick / 1000.0,
+               LEVEL_NAMES[def.level], text);
+    }
+}
+
+static void usage() {
+    fprintf(stderr, "usage: trace_decode [--bin] [dump]\n");
+}
+
+int main(int argc, char **argv) {
+    const char *path = nullptr;
+    bool binary = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--bin")) {
+            binary = true;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            usage();
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    FILE *f = (path && strcmp(path, "-") != 0) ? fopen(path, binary ? "rb" : "r") : stdin;
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    const bool ok = binary ? loadBin(f, data) : loadHex(f, data);
+    if (f != stdin) fclose(f);
+    if (!ok) return 1;
+
+    std::vector<Entry> entries;
+    if (!parsePages(data, entries)) return 1;
+    if (entries.empty()) {
+        printf("trace ring is empty\n");
+        return 0;
+    }
+    printEntries(entries);
+    return 0;
+}
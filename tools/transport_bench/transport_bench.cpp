@@ -0,0 +1,337 @@
+// =============================================================================
+// TRANSPORT BENCH - Throughput and robustness of the link protocols
+// =============================================================================
+// Host-side tool. Runs the firmware's transport layer (src/ble/
+// ble_transport.cpp), recording download (src/ble/ble_file_stream.cpp) and
+// audio sender (src/ble/ble_audio.cpp) over the loopback backend
+// (transport_loopback.h), with the link impairments from the command line.
+// Virtual clock: a run is repeatable for a given --seed and takes
+// milliseconds.
+//
+// Build:
+//   g++ -std=c++17 -O2 -Isrc -o transport_bench tools/transport_bench/*.cpp
+//       src/ble/ble_transport.cpp src/ble/ble_file_stream.cpp src/ble/ble_audio.cpp
+//
+// Scenarios:
+//   file    recording download to every link, ticked like ble_file.cpp;
+//           the peer rebuilds it from the header and compares
+//   audio   fixed-size chunks to the hub at the recording rate through
+//           bleSendAudioChunk(); the peer rebuilds the stream, delivered
+//           bytes and latency percentiles
+//
+// Usage:
+//   ./transport_bench                                  (both, clean link)
+//   ./transport_bench file --links 3 --loss 0.01 --reorder 0.02
+//   ./transport_bench audio --interval-ms 50 --jitter-ms 20
+//   ./transport_bench --check                          (exit 1 unless every
+//                                                       download is intact,
+//                                                       and the audio stream
+//                                                       too on a loss-free link)
+// =============================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "transport_loopback.h"
+#include "ble/ble_audio.h"
+#include "ble/ble_file_stream.h"
+
+// Firmware pacing (ble_file.cpp, audio_i2s.cpp) and active-transfer link
+// parameters (ble_core.cpp) - override with the flags below
+static LoopbackLinkConfig s_link = {
+    247,      // mtu
+    15000,    // intervalUs - 10-20ms while recording
+    4,        // packetsPerEvent
+    10,       // queueDepth
+    0, 0,     // latencyUs, jitterUs
+    0.0f, 0.0f,
+};
+static int s_links = 1;
+static uint32_t s_seed = 1;
+static size_t s_fileSize = 65536;
+static uint32_t s_tickUs = 5000;           // FILE_CHUNK_PERIOD_MS
+static uint32_t s_timeoutS = 120;
+static size_t s_audioChunk = 256;          // 512 samples, 4-bit ADPCM
+static uint32_t s_audioPeriodUs = 32000;   // 512 samples at 16kHz
+static uint32_t s_audioSeconds = 10;
+
+// =============================================================================
+// File download
+// =============================================================================
+
+struct FileRx {
+    uint16_t link;
+    bool haveHeader;
+    uint32_t total;
+    std::vector<uint8_t> data;
+    uint64_t doneUs;
+};
+
+static std::vector<FileRx> s_fileRx;
+
+static FileRx *fileRxFor(uint16_t link) {
+    for (FileRx &r : s_fileRx) {
+        if (r.link == link) return &r;
+    }
+    return nullptr;
+}
+
+static void filePeerRx(uint16_t link, TransportChannel ch, const uint8_t *data, size_t len) {
+    FileRx *r = fileRxFor(link);
+    if (!r || ch != TP_CH_FILE || r->doneUs) return;
+    if (!r->haveHeader) {
+        if (len != 4) return;   // Lost header - the rest can't be placed
+        r->total = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+        r->haveHeader = true;
+        return;
+    }
+    r->data.insert(r->data.end(), data, data + len);
+    if (r->data.size() >= r->total) r->doneUs = loopbackNowUs();
+}
+
+static bool runFile() {
+    std::vector<uint8_t> source(s_fileSize);
+    std::mt19937 rng(s_seed ^ 0x5A5A5A5Au);
+    for (uint8_t &b : source) b = (uint8_t)rng();
+
+    s_fileRx.clear();
+    loopbackInit(s_seed, filePeerRx);
+    for (int i = 0; i < s_links; i++) {
+        const uint16_t link = loopbackConnect(s_link);
+        if (link == TRANSPORT_LINK_NONE) break;
+        s_fileRx.push_back({link, false, 0, {}, 0});
+    }
+
+    // The request byte would arrive as a write; start the streams directly
+    for (const FileRx &r : s_fileRx) fileStreamStart(r.link, source.data(), source.size());
+
+    const uint64_t timeoutUs = (uint64_t)s_timeoutS * 1000000;
+    while (fileStreamActive() > 0 && loopbackNowUs() < timeoutUs) {
+        fileStreamTick();
+        loopbackAdvance(s_tickUs);
+    }
+    fileStreamStopAll();
+
+    // Let the queued and in-flight messages land
+    const uint32_t drainEvents = s_link.queueDepth / s_link.packetsPerEvent + 2;
+    loopbackAdvance(drainEvents * s_link.intervalUs + s_link.latencyUs + s_link.jitterUs);
+
+    printf("file: %zu bytes to %zu link(s)\n", source.size(), s_fileRx.size());
+    bool allIntact = true;
+    for (const FileRx &r : s_fileRx) {
+        const LoopbackStats st = loopbackStats(r.link);
+        size_t bad = 0;
+        const size_t n = std::min(r.data.size(), source.size());
+        for (size_t i = 0; i < n; i++) bad += r.data[i] != source[i];
+        const bool intact = r.haveHeader && r.total == source.size() &&
+                            r.data.size() == source.size() && bad == 0;
+        allIntact &= intact;
+
+        printf("  link %u: %s, %zu/%zu bytes, %zu wrong", r.link,
+               intact ? "intact" : "BROKEN", r.data.size(), source.size(), bad);
+        if (r.doneUs) {
+            printf(", %.1f ms, %.1f kB/s", r.doneUs / 1000.0,
+                   r.data.size() / (r.doneUs / 1e6) / 1000.0);
+        }
+        printf("\n          sent %u refused %u retries %u lost %u reordered %u\n",
+               st.sent, st.refused, st.retries, st.lost, st.reordered);
+    }
+    return allIntact;
+}
+
+// =============================================================================
+// Audio stream
+// =============================================================================
+
+// Chunks the sender accepted. The payload is random, so a piece is found
+// again by its length and first bytes - nothing is added to the stream.
+struct AudioChunk {
+    uint64_t sentUs;
+    uint16_t piecesLeft;
+};
+
+static std::vector<AudioChunk> s_audioChunks;
+static std::unordered_map<uint64_t, uint32_t> s_audioPieces;   // Piece key -> chunk
+static std::vector<uint8_t> s_audioExpected;   // Accepted chunks back to back
+static std::vector<uint8_t> s_audioStream;     // What the peer got
+static std::vector<uint32_t> s_audioLatencyUs;
+static size_t s_audioPieceMax = 0;             // Largest single message seen
+
+static uint64_t pieceKey(const uint8_t *data, size_t len) {
+    uint64_t key = len;
+    for (size_t i = 0; i < len && i < 7; i++) key |= (uint64_t)data[i] << (8 * (i + 1));
+    return key;
+}
+
+static void audioPeerRx(uint16_t, TransportChannel ch, const uint8_t *data, size_t len) {
+    if (ch != TP_CH_AUDIO) return;
+    s_audioStream.insert(s_audioStream.end(), data, data + len);
+    s_audioPieceMax = std::max(s_audioPieceMax, len);
+
+    // A chunk has arrived with its last missing piece
+    auto it = s_audioPieces.find(pieceKey(data, len));
+    if (it == s_audioPieces.end()) return;
+    AudioChunk &chunk = s_audioChunks[it->second];
+    s_audioPieces.erase(it);
+    if (--chunk.piecesLeft == 0) {
+        s_audioLatencyUs.push_back((uint32_t)(loopbackNowUs() - chunk.sentUs));
+    }
+}
+
+static uint32_t percentile(std::vector<uint32_t> &v, int pct) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[(v.size() - 1) * pct / 100];
+}
+
+static bool runAudio() {
+    s_audioChunks.clear();
+    s_audioPieces.clear();
+    s_audioExpected.clear();
+    s_audioStream.clear();
+    s_audioLatencyUs.clear();
+    s_audioPieceMax = 0;
+    loopbackInit(s_seed, audioPeerRx);
+    for (int i = 0; i < s_links; i++) loopbackConnect(s_link);
+
+    const uint32_t chunks = (uint32_t)((uint64_t)s_audioSeconds * 1000000 / s_audioPeriodUs);
+    std::vector<uint8_t> chunk(s_audioChunk);
+    std::mt19937 rng(s_seed ^ 0xA5A5A5A5u);
+    uint32_t dropped = 0;
+    for (uint32_t seq = 0; seq < chunks; seq++) {
+        for (uint8_t &b : chunk) b = (uint8_t)rng();
+        // Like audio_i2s.cpp: a dropped chunk is gone, the next one is due
+        const uint64_t sentUs = loopbackNowUs();
+        const size_t pieceMax = transportPayloadMax(transportHub());
+        if (!bleSendAudioChunk(chunk.data(), chunk.size())) {
+            dropped++;
+        } else {
+            // Split the same way to know the pieces
+            const uint32_t index = (uint32_t)s_audioChunks.size();
+            uint16_t pieces = 0;
+            for (size_t off = 0; off < chunk.size(); off += pieceMax, pieces++) {
+                const size_t n = std::min(pieceMax, chunk.size() - off);
+                s_audioPieces[pieceKey(chunk.data() + off, n)] = index;
+            }
+            s_audioChunks.push_back({sentUs, pieces});
+            s_audioExpected.insert(s_audioExpected.end(), chunk.begin(), chunk.end());
+        }
+        loopbackAdvance(s_audioPeriodUs);
+    }
+    loopbackAdvance(1000000);   // Drain
+
+    const uint16_t hub = transportHub();
+    const LoopbackStats st = loopbackStats(hub);
+    const size_t payloadMax = transportPayloadMax(hub);
+    const uint64_t offered = (uint64_t)chunks * chunk.size();
+    const bool same = s_audioStream == s_audioExpected;
+    printf("audio: %u chunks of %zu bytes every %.1f ms to link %u, %zu piece(s) each\n", chunks,
+           chunk.size(), s_audioPeriodUs / 1000.0, hub,
+           payloadMax ? (chunk.size() + payloadMax - 1) / payloadMax : 0);
+    printf("  delivered %zu/%llu bytes (%.1f%%), %zu/%u chunks, dropped %u, refused %u lost %u "
+           "reordered %u\n",
+           s_audioStream.size(), (unsigned long long)offered,
+           offered ? s_audioStream.size() * 100.0 / offered : 0.0, s_audioLatencyUs.size(),
+           chunks, dropped, st.refused, st.lost, st.reordered);
+    printf("  stream %s, largest message %zu/%zu bytes\n",
+           same ? "intact" : "DIFFERS from the chunks sent", s_audioPieceMax, payloadMax);
+    printf("  latency p50 %.1f ms, p95 %.1f ms, max %.1f ms\n",
+           percentile(s_audioLatencyUs, 50) / 1000.0, percentile(s_audioLatencyUs, 95) / 1000.0,
+           percentile(s_audioLatencyUs, 100) / 1000.0);
+
+    // Loss and reordering break the stream on purpose - only a clean link
+    // has to deliver every accepted chunk whole, and drop none
+    if (s_link.lossRate > 0.0f || s_link.reorderRate > 0.0f) return true;
+    return same && dropped == 0 && s_audioPieceMax <= payloadMax;
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+static void usage() {
+    fprintf(stderr,
+            "usage: transport_bench [file|audio] [--links N] [--seed N] [--check]\n"
+            "                       [--mtu N] [--interval-ms F] [--ppe N] [--queue N]\n"
+            "                       [--latency-ms F] [--jitter-ms F] [--loss F] [--reorder F]\n"
+            "                       [--size N] [--tick-ms F] [--timeout S]\n"
+            "                       [--chunk N] [--period-ms F] [--seconds S]\n");
+}
+
+static uint32_t msToUs(const char *s) {
+    return (uint32_t)(strtod(s, nullptr) * 1000.0);
+}
+
+int main(int argc, char **argv) {
+    bool file = true;
+    bool audio = true;
+    bool check = false;
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "file")) {
+            audio = false;
+        } else if (!strcmp(argv[i], "audio")) {
+            file = false;
+        } else if (!strcmp(argv[i], "--check")) {
+            check = true;
+        } else if (!strcmp(argv[i], "--links") && hasValue) {
+            s_links = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--seed") && hasValue) {
+            s_seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--mtu") && hasValue) {
+            s_link.mtu = (uint16_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--interval-ms") && hasValue) {
+            s_link.intervalUs = msToUs(argv[++i]);
+        } else if (!strcmp(argv[i], "--ppe") && hasValue) {
+            s_link.packetsPerEvent = (uint16_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--queue") && hasValue) {
+            s_link.queueDepth = (uint16_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--latency-ms") && hasValue) {
+            s_link.latencyUs = msToUs(argv[++i]);
+        } else if (!strcmp(argv[i], "--jitter-ms") && hasValue) {
+            s_link.jitterUs = msToUs(argv[++i]);
+        } else if (!strcmp(argv[i], "--loss") && hasValue) {
+            s_link.lossRate = strtof(argv[++i], nullptr);
+        } else if (!strcmp(argv[i], "--reorder") && hasValue) {
+            s_link.reorderRate = strtof(argv[++i], nullptr);
+        } else if (!strcmp(argv[i], "--size") && hasValue) {
+            s_fileSize = (size_t)strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--tick-ms") && hasValue) {
+            s_tickUs = msToUs(argv[++i]);
+        } else if (!strcmp(argv[i], "--timeout") && hasValue) {
+            s_timeoutS = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--chunk") && hasValue) {
+            s_audioChunk = (size_t)strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--period-ms") && hasValue) {
+            s_audioPeriodUs = msToUs(argv[++i]);
+        } else if (!strcmp(argv[i], "--seconds") && hasValue) {
+            s_audioSeconds = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (s_links < 1 || s_links > TRANSPORT_MAX_LINKS || s_link.mtu < 23 || !s_link.queueDepth ||
+        !s_tickUs || !s_audioPeriodUs || !s_fileSize || !s_audioChunk) {
+        usage();
+        return 2;
+    }
+
+    printf("mtu %u, interval %.2f ms, %u/event, queue %u, latency %.1f+%.1f ms, "
+           "loss %.3f, reorder %.3f, seed %u\n\n",
+           s_link.mtu, s_link.intervalUs / 1000.0, s_link.packetsPerEvent, s_link.queueDepth,
+           s_link.latencyUs / 1000.0, s_link.jitterUs / 1000.0, s_link.lossRate,
+           s_link.reorderRate, s_seed);
+
+    bool intact = true;
+    if (file) intact = runFile();
+    if (file && audio) printf("\n");
+    if (audio) intact &= runAudio();
+    return check && !intact ? 1 : 0;
+}
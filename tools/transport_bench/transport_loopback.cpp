@@ -0,0 +1,260 @@
+#include "transport_loopback.h"
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+
+constexpr size_t ATT_NOTIFY_OVERHEAD = 3;   // As ble_conn.h - that one pulls in Arduino
+
+struct Message {
+    uint16_t link;
+    TransportChannel ch;
+    bool toPeer;
+    std::vector<uint8_t> data;
+    uint64_t dueUs;
+    uint64_t seq;          // Keeps equal due times in air order
+};
+
+struct Link {
+    bool open;
+    uint16_t id;
+    LoopbackLinkConfig config;
+    uint8_t subscribed;    // Bit per TransportChannel
+    uint64_t connectedUs;
+    uint64_t nextEventUs;
+    std::deque<Message> toPeer;
+    std::deque<Message> toWatch;
+    uint64_t lastDueUs[2];     // Per direction - jitter never passes the one ahead
+    LoopbackStats stats;
+};
+
+static Link s_links[TRANSPORT_MAX_LINKS];
+static std::vector<Message> s_inFlight;
+static uint64_t s_nowUs = 0;
+static uint64_t s_seq = 0;
+static uint16_t s_nextId = 0;
+static std::mt19937 s_rng;
+static LoopbackPeerRx s_peerRx = nullptr;
+
+static Link *findLink(uint16_t id) {
+    for (Link &l : s_links) {
+        if (l.open && l.id == id) return &l;
+    }
+    return nullptr;
+}
+
+static bool chance(float p) {
+    if (p <= 0.0f) return false;
+    return std::uniform_real_distribution<float>(0.0f, 1.0f)(s_rng) < p;
+}
+
+// One connection event's worth of one direction onto the air
+static void transmit(Link &l, std::deque<Message> &queue, uint64_t &lastDueUs) {
+    for (uint16_t n = 0; n < l.config.packetsPerEvent && !queue.empty(); n++) {
+        size_t pick = 0;
+        if (queue.size() >= 2 && chance(l.config.reorderRate)) {
+            pick = 1;
+            l.stats.reordered++;
+        }
+        Message m = std::move(queue[pick]);
+        queue.erase(queue.begin() + pick);
+        if (chance(l.config.lossRate)) {
+            l.stats.lost++;
+            continue;
+        }
+        uint32_t jitter = 0;
+        if (l.config.jitterUs) {
+            jitter = std::uniform_int_distribution<uint32_t>(0, l.config.jitterUs)(s_rng);
+        }
+        m.dueUs = std::max(s_nowUs + l.config.latencyUs + jitter, lastDueUs);
+        lastDueUs = m.dueUs;
+        m.seq = s_seq++;   // Air order, not queue order
+        s_inFlight.push_back(std::move(m));
+    }
+}
+
+static void deliverDue() {
+    std::stable_sort(s_inFlight.begin(), s_inFlight.end(), [](const Message &a, const Message &b) {
+        return a.dueUs != b.dueUs ? a.dueUs < b.dueUs : a.seq < b.seq;
+    });
+    size_t n = 0;
+    while (n < s_inFlight.size() && s_inFlight[n].dueUs <= s_nowUs) n++;
+    std::vector<Message> due(std::make_move_iterator(s_inFlight.begin()),
+                             std::make_move_iterator(s_inFlight.begin() + n));
+    s_inFlight.erase(s_inFlight.begin(), s_inFlight.begin() + n);
+
+    // Handlers may send or disconnect - the due list is already detached
+    for (const Message &m : due) {
+        Link *l = findLink(m.link);
+        if (!l) continue;
+        if (m.toPeer) {
+            l->stats.delivered++;
+            l->stats.bytesDelivered += m.data.size();
+            if (s_peerRx) s_peerRx(m.link, m.ch, m.data.data(), m.data.size());
+        } else {
+            transportDeliver(m.link, m.ch, m.data.data(), m.data.size());
+        }
+    }
+}
+
+// =============================================================================
+// Backend operations
+// =============================================================================
+
+static bool lbSend(uint16_t link, TransportChannel ch, const uint8_t *data, size_t len) {
+    Link *l = findLink(link);
+    if (!l) return false;
+    if (!(l->subscribed & (1 << ch)) || l->toPeer.size() >= l->config.queueDepth ||
+        len > l->config.mtu - ATT_NOTIFY_OVERHEAD) {
+        l->stats.refused++;
+        return false;
+    }
+    l->toPeer.push_back({link, ch, true, std::vector<uint8_t>(data, data + len), 0, s_seq++});
+    l->stats.sent++;
+    return true;
+}
+
+static size_t lbPayloadMax(uint16_t link) {
+    const Link *l = findLink(link);
+    return l ? l->config.mtu - ATT_NOTIFY_OVERHEAD : 0;
+}
+
+static uint16_t lbCredits(uint16_t link) {
+    const Link *l = findLink(link);
+    if (!l || l->toPeer.size() >= l->config.queueDepth) return 0;
+    return (uint16_t)(l->config.queueDepth - l->toPeer.size());
+}
+
+static bool lbSubscribed(uint16_t link, TransportChannel ch) {
+    const Link *l = findLink(link);
+    return l && (l->subscribed & (1 << ch));
+}
+
+static void lbRetried(uint16_t link) {
+    Link *l = findLink(link);
+    if (l) l->stats.retries++;
+}
+
+static int lbSlot(uint16_t link) {
+    for (int i = 0; i < TRANSPORT_MAX_LINKS; i++) {
+        if (s_links[i].open && s_links[i].id == link) return i;
+    }
+    return -1;
+}
+
+static uint16_t lbHub() {
+    const Link *hub = nullptr;
+    for (const Link &l : s_links) {
+        if (!l.open || !(l.subscribed & (1 << TP_CH_AUDIO))) continue;
+        if (!hub || l.connectedUs < hub->connectedUs) hub = &l;
+    }
+    return hub ? hub->id : TRANSPORT_LINK_NONE;
+}
+
+static const TransportBackend LOOPBACK_BACKEND = {
+    "loopback",
+    lbSend,
+    lbPayloadMax,
+    lbCredits,
+    lbSubscribed,
+    lbRetried,
+    lbSlot,
+    lbHub,
+};
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void loopbackInit(uint32_t seed, LoopbackPeerRx peerRx) {
+    for (Link &l : s_links) l = Link();
+    s_inFlight.clear();
+    s_nowUs = 0;
+    s_seq = 0;
+    s_nextId = 0;
+    s_rng.seed(seed);
+    s_peerRx = peerRx;
+    transportSetBackend(&LOOPBACK_BACKEND);
+}
+
+uint16_t loopbackConnect(const LoopbackLinkConfig &config) {
+    for (Link &l : s_links) {
+        if (l.open) continue;
+        l = Link();
+        l.open = true;
+        l.id = s_nextId++;
+        l.config = config;
+        if (l.config.packetsPerEvent == 0) l.config.packetsPerEvent = 1;
+        if (l.config.intervalUs == 0) l.config.intervalUs = 7500;
+        l.subscribed = (1 << TP_CH_AUDIO) | (1 << TP_CH_FILE) | (1 << TP_CH_OTA);
+        l.connectedUs = s_nowUs;
+        l.nextEventUs = s_nowUs + l.config.intervalUs;
+        transportLinkEvent(l.id, TP_EVT_CONNECTED);
+        return l.id;
+    }
+    return TRANSPORT_LINK_NONE;
+}
+
+void loopbackDisconnect(uint16_t link) {
+    Link *l = findLink(link);
+    if (!l) return;
+    l->open = false;
+    l->toPeer.clear();
+    l->toWatch.clear();
+    s_inFlight.erase(std::remove_if(s_inFlight.begin(), s_inFlight.end(),
+                                    [link](const Message &m) { return m.link == link; }),
+                     s_inFlight.end());
+    transportLinkEvent(link, TP_EVT_DISCONNECTED);
+}
+
+void loopbackSubscribe(uint16_t link, TransportChannel ch, bool on) {
+    Link *l = findLink(link);
+    if (!l) return;
+    if (on) {
+        l->subscribed |= (1 << ch);
+    } else {
+        l->subscribed &= ~(1 << ch);
+    }
+}
+
+void loopbackPeerWrite(uint16_t link, TransportChannel ch, const uint8_t *data, size_t len) {
+    Link *l = findLink(link);
+    if (!l || !data || !len) return;
+    l->toWatch.push_back({link, ch, false, std::vector<uint8_t>(data, data + len), 0, s_seq++});
+}
+
+void loopbackAdvance(uint32_t us) {
+    const uint64_t endUs = s_nowUs + us;
+    for (;;) {
+        uint64_t nextUs = endUs + 1;
+        for (const Link &l : s_links) {
+            if (l.open && l.nextEventUs < nextUs) nextUs = l.nextEventUs;
+        }
+        for (const Message &m : s_inFlight) {
+            if (m.dueUs < nextUs) nextUs = m.dueUs;
+        }
+        if (nextUs > endUs) break;
+
+        s_nowUs = nextUs;
+        for (Link &l : s_links) {
+            if (!l.open || l.nextEventUs > s_nowUs) continue;
+            transmit(l, l.toPeer, l.lastDueUs[0]);
+            transmit(l, l.toWatch, l.lastDueUs[1]);
+            l.nextEventUs += l.config.intervalUs;
+        }
+        deliverDue();
+    }
+    s_nowUs = endUs;
+}
+
+uint64_t loopbackNowUs() {
+    return s_nowUs;
+}
+
+LoopbackStats loopbackStats(uint16_t link) {
+    for (const Link &l : s_links) {
+        if (l.id == link && (l.open || l.stats.sent)) return l.stats;
+    }
+    return LoopbackStats();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+// =============================================================================
+// TRANSPORT LOOPBACK - Host backend for src/ble/ble_transport.h
+// =============================================================================
+// Simulated links on a virtual clock, so runs are deterministic and take
+// no wall time. Each link has connection events every intervalUs; an event
+// carries up to packetsPerEvent messages each way. Messages the watch sends
+// wait in a queue of queueDepth (the credits); the peer's writes are not
+// limited. On the way, a message may be:
+//   - delayed    latencyUs + up to jitterUs, still in order
+//   - lost       lossRate
+//   - reordered  reorderRate - goes out after the message behind it
+// Real BLE retransmits at the link layer, so loss and reordering stand in
+// for what the phone side can do to us (app suspended, OS buffers full).
+// =============================================================================
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ble/ble_transport.h"
+
+struct LoopbackLinkConfig {
+    uint16_t mtu;              // ATT MTU, payload is 3 less
+    uint32_t intervalUs;       // Connection interval
+    uint16_t packetsPerEvent;  // Messages per connection event, each way
+    uint16_t queueDepth;       // Watch -> peer queue (credits when empty)
+    uint32_t latencyUs;        // Extra one-way delay
+    uint32_t jitterUs;         // Uniform 0..jitterUs on top
+    float lossRate;
+    float reorderRate;
+};
+
+struct LoopbackStats {
+    uint32_t sent;             // Accepted by send()
+    uint32_t refused;          // Queue full, not subscribed or over MTU - 3
+    uint32_t retries;          // transportNoteRetry()
+    uint32_t lost;
+    uint32_t reordered;
+    uint32_t delivered;        // Reached the peer
+    uint64_t bytesDelivered;
+};
+
+// Messages the watch sent, as the peer sees them
+typedef void (*LoopbackPeerRx)(uint16_t link, TransportChannel ch, const uint8_t *data, size_t len);
+
+// Install as the transport backend; seed drives loss / jitter / reorder
+void loopbackInit(uint32_t seed, LoopbackPeerRx peerRx);
+
+// Link up with every notify channel subscribed; TP_EVT_CONNECTED is sent
+// before this returns. TRANSPORT_LINK_NONE if all slots are taken.
+uint16_t loopbackConnect(const LoopbackLinkConfig &config);
+void loopbackDisconnect(uint16_t link);
+void loopbackSubscribe(uint16_t link, TransportChannel ch, bool on);
+
+// Peer -> watch write, through the same impairments
+void loopbackPeerWrite(uint16_t link, TransportChannel ch, const uint8_t *data, size_t len);
+
+// Run connection events and deliveries up to now + us
+void loopbackAdvance(uint32_t us);
+uint64_t loopbackNowUs();
+
+LoopbackStats loopbackStats(uint16_t link);
@@ -0,0 +1,124 @@
+// =============================================================================
+// WAKE FILTER TEST - Host checks for the deep sleep touch debounce
+// =============================================================================
+// Host-side tool. Drives the firmware's reference filter
+// (src/power/wake_filter.cpp) - the logic the ULP program in ulp_touch.cpp
+// mirrors - through the wake cases that matter on the wrist.
+//
+// Build:
+//   g++ -std=c++17 -O2 -Isrc tools/wake_filter_test/wake_filter_test.cpp
+//       src/power/wake_filter.cpp -o wake_filter_test
+//
+// Usage:
+//   ./wake_filter_test          (exit 1 if any case fails)
+// =============================================================================
+
+#include <cstdio>
+#include <cstring>
+
+#include "power/wake_filter.h"
+
+static int s_failures = 0;
+
+static void check(bool ok, const char *caseName, const char *what) {
+    if (ok) return;
+    printf("  FAIL %s: %s\n", caseName, what);
+    s_failures++;
+}
+
+// Feeds a line pattern ('H' high, 'L' low); returns the 1-based sample
+// that woke, 0 if none did
+static int feed(WakeFilterState &s, const char *pattern) {
+    for (int i = 0; pattern[i]; i++) {
+        if (wakeFilterStep(s, pattern[i] == 'L') == WAKE_FILTER_WAKE) return i + 1;
+    }
+    return 0;
+}
+
+static WakeFilterState freshState() {
+    WakeFilterState s;
+    memset(&s, 0, sizeof(s));
+    wakeFilterReset(s);
+    return s;
+}
+
+// =============================================================================
+// Cases
+// =============================================================================
+
+static void singleShortPulse(const char *name) {
+    WakeFilterState s = freshState();
+    check(feed(s, "HHLHHHH") == 0, name, "one low sample woke");
+    check(s.rejected == 1, name, "pulse not counted as rejected");
+    check(s.lowCount == 0, name, "low count not cleared on release");
+    check(s.armed == 1, name, "not armed after release");
+}
+
+static void heldAtConfirmCount(const char *name) {
+    static_assert(WAKE_FILTER_CONFIRM_SAMPLES == 3, "patterns below assume 3 samples");
+
+    WakeFilterState s = freshState();
+    check(feed(s, "HLL") == 0, name, "woke one sample early");
+    check(feed(s, "L") == 1, name, "no wake on the third low sample");
+    check(s.armed == 0 && s.lowCount == 0, name, "not disarmed after the wake");
+    check(s.rejected == 0, name, "confirmed touch counted as rejected");
+
+    // Disarmed: the finger still on the glass doesn't wake again
+    check(feed(s, "LLLLLL") == 0, name, "woke again while still held");
+
+    // One short of the count is a rejected pulse
+    s = freshState();
+    check(feed(s, "HLLH") == 0, name, "two low samples woke");
+    check(s.rejected == 1, name, "two-sample pulse not rejected");
+}
+
+static void intLatchedLow(const char *name) {
+    WakeFilterState s = freshState();
+    check(feed(s, "LLLLLLLLLLLLLLLLLLLL") == 0, name, "asserted INT woke without a release");
+    check(s.armed == 0, name, "armed without seeing the line high");
+    check(s.rejected == 0, name, "latched INT counted as rejected pulses");
+
+    // Released, then a real touch
+    check(feed(s, "HLLL") == 4, name, "no wake on a touch after the release");
+}
+
+static void rejectedCounter(const char *name) {
+    WakeFilterState s = freshState();
+    check(feed(s, "HLHLHLLHLH") == 0, name, "short pulses woke");
+    check(s.rejected == 4, name, "four pulses not counted");
+
+    // Survives the reset at the next sleep entry
+    wakeFilterReset(s);
+    check(s.rejected == 4, name, "reset cleared the counter");
+    check(s.armed == 0 && s.lowCount == 0, name, "reset left the filter armed");
+
+    // Saturates like the 16-bit ULP word
+    s.rejected = WAKE_FILTER_COUNT_MAX;
+    feed(s, "HLH");
+    check(s.rejected == WAKE_FILTER_COUNT_MAX, name, "counter wrapped past the ULP word");
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+int main() {
+    struct Case {
+        const char *name;
+        void (*run)(const char *name);
+    };
+    const Case cases[] = {
+        { "single short pulse",           singleShortPulse },
+        { "held touch at confirm count",  heldAtConfirmCount },
+        { "INT latched low",              intLatchedLow },
+        { "rejected pulse counter",       rejectedCounter },
+    };
+
+    for (const Case &c : cases) {
+        const int before = s_failures;
+        c.run(c.name);
+        printf("%s %s\n", s_failures == before ? "ok  " : "FAIL", c.name);
+    }
+    printf("%d failure(s)\n", s_failures);
+    return s_failures ? 1 : 0;
+}